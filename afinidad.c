@@ -0,0 +1,117 @@
+// afinidad.c - reparto de nucleos y nodos NUMA entre las bandas de un proceso
+
+#define _GNU_SOURCE   // cpu_set_t, sched_getaffinity
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "afinidad.h"
+
+/* Lista de nucleos del kernel ("0-3,8,10-11") dentro de set */
+static int leer_lista_cpus(const char *archivo, cpu_set_t *set) {
+    FILE *f = fopen(archivo, "r");
+    if (!f) return -1;
+    char linea[4096];
+    int ok = fgets(linea, sizeof(linea), f) != NULL;
+    fclose(f);
+    if (!ok) return -1;
+
+    CPU_ZERO(set);
+    char *p = linea;
+    while (*p && *p != '\n') {
+        char *fin;
+        long a = strtol(p, &fin, 10);
+        if (fin == p) return -1;
+        long b = a;
+        if (*fin == '-') {
+            p = fin + 1;
+            b = strtol(p, &fin, 10);
+            if (fin == p) return -1;
+        }
+        for (long c = a; c <= b && c < CPU_SETSIZE; c++) CPU_SET((int)c, set);
+        p = *fin == ',' ? fin + 1 : fin;
+    }
+    return 0;
+}
+
+/* Nodos con algun nucleo permitido; sin sysfs, un nodo con todos */
+static int leer_nodos(const cpu_set_t *permitidos, cpu_set_t *nodos, int *ids) {
+    int n = 0;
+    for (int id = 0; id < AFINIDAD_MAX_NODOS * 4 && n < AFINIDAD_MAX_NODOS; id++) {
+        char archivo[96];
+        snprintf(archivo, sizeof(archivo), "/sys/devices/system/node/node%d/cpulist", id);
+        cpu_set_t set;
+        if (leer_lista_cpus(archivo, &set) != 0) continue;
+        CPU_AND(&set, &set, permitidos);
+        if (CPU_COUNT(&set) == 0) continue;
+        nodos[n] = set;
+        ids[n++] = id;
+    }
+    if (n == 0) {
+        nodos[0] = *permitidos;
+        ids[0] = 0;
+        n = 1;
+    }
+    return n;
+}
+
+/* Fija el hilo que llama al tramo de nucleos de la banda. En desc queda el
+   nodo y los nucleos (o el motivo si no se pudo). */
+int fijar_afinidad_banda(int banda, int bandas, char *desc, size_t tam) {
+    cpu_set_t permitidos;
+    if (bandas <= 0 || banda < 0 || sched_getaffinity(0, sizeof(permitidos), &permitidos) != 0) {
+        snprintf(desc, tam, "sin afinidad");
+        return -1;
+    }
+    cpu_set_t nodos[AFINIDAD_MAX_NODOS];
+    int ids[AFINIDAD_MAX_NODOS];
+    int num_nodos = leer_nodos(&permitidos, nodos, ids);
+
+    /* ronda entre nodos: la banda es la j-esima de las m de su nodo */
+    int nodo = banda % num_nodos;
+    int j = banda / num_nodos;
+    int m = (bandas - nodo + num_nodos - 1) / num_nodos;
+
+    int cpus[CPU_SETSIZE];
+    int k = 0;
+    for (int c = 0; c < CPU_SETSIZE; c++)
+        if (CPU_ISSET(c, &nodos[nodo])) cpus[k++] = c;
+    int desde, hasta;
+    if (k >= m) {
+        desde = (int)((long)j * k / m);
+        hasta = (int)((long)(j + 1) * k / m);
+    } else {
+        desde = j % k;
+        hasta = desde + 1;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int i = desde; i < hasta; i++) CPU_SET(cpus[i], &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        snprintf(desc, tam, "sin afinidad (sched_setaffinity fallo)");
+        return -1;
+    }
+    if (hasta - desde == 1)
+        snprintf(desc, tam, "nodo %d, nucleo %d%s", ids[nodo], cpus[desde], k < m ? " (compartido)" : "");
+    else
+        snprintf(desc, tam, "nodo %d, nucleos %d-%d", ids[nodo], cpus[desde], cpus[hasta - 1]);
+    return ids[nodo];
+}
+
+int nucleos_permitidos(void) {
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return 1;
+    int n = CPU_COUNT(&set);
+    return n > 0 ? n : 1;
+}
+
+int fijar_tiempo_real(int prioridad) {
+    if (prioridad <= 0) return 0;
+    int min = sched_get_priority_min(SCHED_FIFO), max = sched_get_priority_max(SCHED_FIFO);
+    struct sched_param param;
+    param.sched_priority = prioridad < min ? min : prioridad > max ? max : prioridad;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+}
@@ -0,0 +1,30 @@
+#ifndef AFINIDAD_H
+#define AFINIDAD_H
+
+#include <stddef.h>
+
+// ---------- NUCLEOS DE CADA BANDA ----------
+// Con robot -N <bandas> cada banda corre en su propio hilo y se fija a un
+// grupo de nucleos propio antes de reservar nada. Las bandas se reparten
+// entre los nodos NUMA (/sys/devices/system/node) en ronda, y los nucleos de
+// cada nodo se parten en tramos contiguos entre las bandas que le tocaron.
+// Los hilos que la banda crea despues (reloj, robots, pool, supervisor,
+// latido) heredan la afinidad, y la memoria que reservan y tocan primero
+// queda en su nodo (politica first-touch del kernel), sin libnuma.
+// Si hay menos nucleos que bandas en un nodo, las bandas los comparten.
+// Sin informacion de nodos se toma un solo nodo con los nucleos permitidos.
+
+#define AFINIDAD_MAX_NODOS 64
+
+int fijar_afinidad_banda(int banda, int bandas, char *desc, size_t tam);   // nodo elegido o -1
+int nucleos_permitidos(void);   // nucleos en los que puede correr el hilo actual
+
+// ---------- PRIORIDAD DE TIEMPO REAL ----------
+// Con robot -T <prioridad> los hilos que esperan plazos (reloj de banda,
+// supervisor, robots en modo hilo y el que alimenta la banda) pasan a
+// SCHED_FIFO con esa prioridad (1..99). Sin permiso (CAP_SYS_NICE o
+// RLIMIT_RTPRIO) siguen en SCHED_OTHER; la corrida no cambia.
+
+int fijar_tiempo_real(int prioridad);   // hilo actual; 0 = listo (o prioridad <= 0), si no errno
+
+#endif
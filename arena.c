@@ -0,0 +1,45 @@
+// arena.c - reserva de un solo bloque para el estado del sistema
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arena.h"
+
+size_t arena_medida(size_t bytes) {
+    return (bytes + ARENA_ALINEACION - 1) & ~(size_t)(ARENA_ALINEACION - 1);
+}
+
+/* Deja la arena vacia con al menos bytes de lugar. Si el bloque anterior
+   alcanza se reusa tal cual (sin tocar malloc); si no, se cambia por uno nuevo.
+   Todo lo tomado antes deja de ser valido. Devuelve 0 si pudo, -1 si no. */
+int arena_preparar(Arena *arena, size_t bytes) {
+    if (!arena) return -1;
+    arena->usado = 0;
+    if (arena->bloque && arena->capacidad >= bytes) return 0;
+
+    free(arena->bloque);
+    arena->capacidad = 0;
+    arena->bloque = malloc(bytes ? bytes : 1);   /* malloc ya alinea a 16 */
+    if (!arena->bloque) {
+        perror("malloc(arena)");
+        return -1;
+    }
+    arena->capacidad = bytes;
+    return 0;
+}
+
+void *arena_tomar(Arena *arena, size_t bytes) {
+    size_t medida = arena_medida(bytes);
+    if (!arena->bloque || medida > arena->capacidad - arena->usado) return NULL;
+    void *p = arena->bloque + arena->usado;
+    arena->usado += medida;
+    return p;
+}
+
+void arena_liberar(Arena *arena) {
+    if (!arena) return;
+    free(arena->bloque);
+    arena->bloque = NULL;
+    arena->capacidad = 0;
+    arena->usado = 0;
+}
@@ -0,0 +1,25 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// ---------- ARENA DE UN SOLO BLOQUE ----------
+// Las cajas de un EstadoSistema, sus mangos y sus rutas se toman de un bloque
+// contiguo avanzando un desplazamiento: no hay un free por arreglo y el estado
+// se libera (o se vacia para volver a usarlo) de una vez. Los arreglos quedan
+// en memoria en el mismo orden en que los recorren los robots.
+
+#define ARENA_ALINEACION 16   // alineacion de cada arreglo tomado
+
+typedef struct {
+    unsigned char *bloque;
+    size_t capacidad;    // bytes del bloque
+    size_t usado;        // bytes ya tomados
+} Arena;
+
+size_t arena_medida(size_t bytes);            // lo que ocupa un arreglo de bytes en la arena
+int arena_preparar(Arena *arena, size_t bytes); // vacia la arena con lugar para bytes (reusa el bloque si alcanza)
+void *arena_tomar(Arena *arena, size_t bytes);  // NULL si no alcanza
+void arena_liberar(Arena *arena);
+
+#endif
@@ -0,0 +1,259 @@
+// bench_celda.c - benchmark de la celda de robots sobre una grilla de parametros
+// Compilar y correr: make bench   (o make bench_celda y ./bench_celda -h)
+//
+// Cada punto de la grilla (cajas x mangos por caja x robots x velocidad x
+// tasa de fallas) arma cajas sinteticas como el escaner (grilla con ruido y
+// ruta planificada) y corre la logica de los robots con simular_banda en
+// tiempo virtual, las veces que pida -n con semillas consecutivas. Reporta:
+//   etiquetas_s       mangos etiquetados por segundo de banda (tiempo virtual)
+//   pct_sin_etiquetar mangos que salieron de la banda sin etiqueta
+//   lat_p50/p90/p99   latencia de cada etiqueta: desde que el robot reserva el
+//   lat_max           mango hasta que termina de pegarla (s virtuales)
+//   cpu_us_etiqueta   CPU del proceso por mango etiquetado (us)
+// La salida es CSV o JSON (una fila/objeto por punto) para comparar builds.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "datos.h"
+#include "estadistica.h"
+#include "ruta.h"
+#include "simulacion.h"
+
+#define MAX_VALORES   16       /* valores por eje de la grilla */
+#define PASO_GRILLA   9.5f     /* cm entre mangos vecinos, como bench_vecino */
+#define AREA_MANGO    90.0f
+
+typedef struct {
+    double v[MAX_VALORES];
+    int n;
+} Eje;
+
+typedef struct {
+    Eje cajas, mangos, robots, velocidad, fallas;
+    int repeticiones;
+    int repuestos;          /* robots de reemplazo dentro de robots_maximos */
+    float longitud;         /* cm de banda */
+    unsigned int semilla;
+    int dinamicas;          /* ventanas dinamicas en simular_banda */
+    int json;
+} Opciones;
+
+static double cpu_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* "10,50,100" -> eje; devuelve -1 si algun valor no es un numero >= 0 */
+static int parsear_eje(const char *texto, Eje *eje) {
+    char copia[256];
+    snprintf(copia, sizeof(copia), "%s", texto);
+    eje->n = 0;
+    for (char *tok = strtok(copia, ","); tok; tok = strtok(NULL, ",")) {
+        char *fin;
+        double v = strtod(tok, &fin);
+        if (fin == tok || *fin != '\0' || v < 0.0 || eje->n == MAX_VALORES) return -1;
+        eje->v[eje->n++] = v;
+    }
+    return eje->n > 0 ? 0 : -1;
+}
+
+/* Cajas cuadradas con los mangos en grilla y algo de ruido, ruta planificada */
+static int armar_estado(EstadoSistema *estado, const Opciones *op, int num_cajas, int n,
+                        float velocidad, int robots, unsigned int *seed) {
+    memset(estado, 0, sizeof(*estado));
+    estado->velocidad_banda = velocidad;
+    estado->longitud_banda = op->longitud;
+    estado->num_cajas = num_cajas;
+    estado->num_robots = robots - op->repuestos > 0 ? robots - op->repuestos : 1;
+    estado->cajas = calloc((size_t)num_cajas, sizeof(Caja));
+    if (!estado->cajas) return -1;
+
+    int lado = (int)ceil(sqrt((double)n));
+    for (int c = 0; c < num_cajas; c++) {
+        Caja *caja = &estado->cajas[c];
+        caja->id = c + 1;
+        caja->num_mangos = n;
+        caja->area_caja = (float)(lado * lado) * PASO_GRILLA * PASO_GRILLA;
+        caja->mangos = calloc((size_t)n, sizeof(Mango));
+        if (!caja->mangos) return -1;
+        for (int i = 0; i < n; i++) {
+            Mango *m = &caja->mangos[i];
+            m->id = i + 1;
+            m->area = AREA_MANGO;
+            m->x = (float)(i % lado) * PASO_GRILLA - (float)lado * PASO_GRILLA / 2.0f + (float)(rand_r(seed) % 100) / 100.0f;
+            m->y = (float)(i / lado) * PASO_GRILLA - (float)lado * PASO_GRILLA / 2.0f + (float)(rand_r(seed) % 100) / 100.0f;
+        }
+        if (planificar_ruta(caja) != 0) return -1;
+    }
+    return 0;
+}
+
+static void liberar_estado_bench(EstadoSistema *estado) {
+    for (int c = 0; estado->cajas && c < estado->num_cajas; c++) {
+        free(estado->cajas[c].mangos);
+        free(estado->cajas[c].ruta);
+    }
+    free(estado->cajas);
+    estado->cajas = NULL;
+}
+
+static void imprimir_cabecera(const Opciones *op) {
+    if (op->json) {
+        printf("[\n");
+        return;
+    }
+    printf("cajas,mangos_caja,robots,velocidad,prob_fallo,repeticiones,mangos_totales,etiquetados,"
+           "pct_sin_etiquetar,etiquetas_s,lat_p50,lat_p90,lat_p99,lat_max,cpu_us_etiqueta,"
+           "fallas,duplicados,ventanas_dinamicas\n");
+}
+
+/* ------------------ punto de la grilla ------------------ */
+static int medir_punto(const Opciones *op, int cajas, int mangos, int robots, double velocidad,
+                       double prob_fallo, int primero) {
+    long max_lat = (long)cajas * mangos * op->repeticiones;
+    double *lat = malloc(sizeof(double) * (size_t)(max_lat > 0 ? max_lat : 1));
+    if (!lat) {
+        perror("malloc(latencias)");
+        return -1;
+    }
+
+    long totales = 0, etiquetados = 0, fallas = 0, duplicados = 0;
+    int num_lat = 0;
+    double t_banda = 0.0, cpu = 0.0;
+    unsigned int seed = op->semilla;
+    for (int rep = 0; rep < op->repeticiones; rep++) {
+        EstadoSistema estado;
+        if (armar_estado(&estado, op, cajas, mangos, (float)velocidad, robots, &seed) != 0) {
+            perror("armar_estado");
+            liberar_estado_bench(&estado);
+            free(lat);
+            return -1;
+        }
+        ParamsSimulacion p;
+        ResultadoSimulacion res;
+        params_simulacion_default(&p, &estado, robots);
+        p.prob_fallo = prob_fallo;
+        p.ventanas_dinamicas = op->dinamicas;
+        p.semilla = op->semilla + (unsigned int)rep;
+        p.latencias = lat + num_lat;
+        p.max_latencias = (int)(max_lat - num_lat);
+
+        double c0 = cpu_ahora();
+        int rc = simular_banda(&estado, &p, &res);
+        cpu += cpu_ahora() - c0;
+        liberar_estado_bench(&estado);
+        if (rc != 0) {
+            fprintf(stderr, "simular_banda fallo (%d cajas, %d robots)\n", cajas, robots);
+            free(lat);
+            return -1;
+        }
+        totales += res.mangos_totales;
+        etiquetados += res.mangos_etiquetados;
+        fallas += res.fallas;
+        duplicados += res.duplicados;
+        t_banda += res.tiempo_simulado;
+        num_lat += res.num_latencias;
+    }
+
+    ordenar_muestras(lat, num_lat);
+    double pct_sin = totales > 0 ? 100.0 * (double)(totales - etiquetados) / (double)totales : 0.0;
+    double etiq_s = t_banda > 0.0 ? (double)etiquetados / t_banda : 0.0;
+    double cpu_us = etiquetados > 0 ? cpu * 1e6 / (double)etiquetados : 0.0;
+    double p50 = percentil(lat, num_lat, 50.0), p90 = percentil(lat, num_lat, 90.0);
+    double p99 = percentil(lat, num_lat, 99.0), pmax = num_lat > 0 ? lat[num_lat - 1] : 0.0;
+
+    if (op->json) {
+        printf("%s  {\"cajas\": %d, \"mangos_caja\": %d, \"robots\": %d, \"velocidad\": %g, "
+               "\"prob_fallo\": %g, \"repeticiones\": %d, \"mangos_totales\": %ld, \"etiquetados\": %ld, "
+               "\"pct_sin_etiquetar\": %.3f, \"etiquetas_s\": %.4f, \"lat_p50\": %.4f, \"lat_p90\": %.4f, "
+               "\"lat_p99\": %.4f, \"lat_max\": %.4f, \"cpu_us_etiqueta\": %.3f, \"fallas\": %ld, "
+               "\"duplicados\": %ld, \"ventanas_dinamicas\": %d}",
+               primero ? "" : ",\n", cajas, mangos, robots, velocidad, prob_fallo, op->repeticiones,
+               totales, etiquetados, pct_sin, etiq_s, p50, p90, p99, pmax, cpu_us, fallas, duplicados,
+               op->dinamicas);
+    } else {
+        printf("%d,%d,%d,%g,%g,%d,%ld,%ld,%.3f,%.4f,%.4f,%.4f,%.4f,%.4f,%.3f,%ld,%ld,%d\n",
+               cajas, mangos, robots, velocidad, prob_fallo, op->repeticiones, totales, etiquetados,
+               pct_sin, etiq_s, p50, p90, p99, pmax, cpu_us, fallas, duplicados, op->dinamicas);
+    }
+    fflush(stdout);
+    free(lat);
+    return 0;
+}
+
+static void uso(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [opciones]   (listas separadas por comas)\n"
+            "  -c cajas        cajas por corrida        (def. 20,100)\n"
+            "  -m mangos       mangos por caja          (def. 16,64)\n"
+            "  -r robots       robots maximos           (def. 4,8,16)\n"
+            "  -v velocidad    velocidad de banda cm/s  (def. 5,10)\n"
+            "  -f fallas       fallas por segundo       (def. 0,0.01)\n"
+            "  -e repuestos    robots de reemplazo      (def. 1)\n"
+            "  -L longitud     largo de banda cm        (def. 700)\n"
+            "  -n repeticiones corridas por punto       (def. 3)\n"
+            "  -s semilla      semilla inicial          (def. 1)\n"
+            "  -d 0|1          ventanas dinamicas       (def. 0)\n"
+            "  -o csv|json     formato de salida        (def. csv)\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    Opciones op;
+    memset(&op, 0, sizeof(op));
+    parsear_eje("20,100", &op.cajas);
+    parsear_eje("16,64", &op.mangos);
+    parsear_eje("4,8,16", &op.robots);
+    parsear_eje("5,10", &op.velocidad);
+    parsear_eje("0,0.01", &op.fallas);
+    op.repeticiones = 3;
+    op.repuestos = 1;
+    op.longitud = 700.0f;
+    op.semilla = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        int ok = v != NULL;
+        if (ok && strcmp(a, "-c") == 0) ok = parsear_eje(v, &op.cajas) == 0;
+        else if (ok && strcmp(a, "-m") == 0) ok = parsear_eje(v, &op.mangos) == 0;
+        else if (ok && strcmp(a, "-r") == 0) ok = parsear_eje(v, &op.robots) == 0;
+        else if (ok && strcmp(a, "-v") == 0) ok = parsear_eje(v, &op.velocidad) == 0;
+        else if (ok && strcmp(a, "-f") == 0) ok = parsear_eje(v, &op.fallas) == 0;
+        else if (ok && strcmp(a, "-e") == 0) ok = (op.repuestos = atoi(v)) >= 0;
+        else if (ok && strcmp(a, "-L") == 0) ok = (op.longitud = (float)atof(v)) > 0.0f;
+        else if (ok && strcmp(a, "-n") == 0) ok = (op.repeticiones = atoi(v)) > 0;
+        else if (ok && strcmp(a, "-s") == 0) op.semilla = (unsigned int)strtoul(v, NULL, 10);
+        else if (ok && strcmp(a, "-d") == 0) ok = (op.dinamicas = atoi(v)) == 0 || op.dinamicas == 1;
+        else if (ok && strcmp(a, "-o") == 0) {
+            op.json = strcmp(v, "json") == 0;
+            ok = op.json || strcmp(v, "csv") == 0;
+        } else ok = 0;
+        if (!ok) {
+            uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    imprimir_cabecera(&op);
+    int primero = 1;
+    for (int ic = 0; ic < op.cajas.n; ic++)
+        for (int im = 0; im < op.mangos.n; im++)
+            for (int ir = 0; ir < op.robots.n; ir++)
+                for (int iv = 0; iv < op.velocidad.n; iv++)
+                    for (int iff = 0; iff < op.fallas.n; iff++) {
+                        int cajas = (int)op.cajas.v[ic], mangos = (int)op.mangos.v[im];
+                        int robots = (int)op.robots.v[ir];
+                        if (cajas <= 0 || mangos <= 0 || robots <= 0 || op.velocidad.v[iv] <= 0.0) continue;
+                        if (medir_punto(&op, cajas, mangos, robots, op.velocidad.v[iv], op.fallas.v[iff], primero) != 0)
+                            return EXIT_FAILURE;
+                        primero = 0;
+                    }
+    if (op.json) printf("\n]\n");
+    return 0;
+}
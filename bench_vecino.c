@@ -0,0 +1,126 @@
+// bench_vecino.c - microbenchmark de la busqueda del mango mas cercano
+// Compilar: make bench_vecino
+//
+// Para cada tamanio de caja etiqueta todos los mangos siguiendo al brazo
+// (como rutina_robot) y mide el costo por busqueda de:
+//   lineal   buscar_mango_cercano sobre Mango[] (double, sqrt, salto por mango)
+//   soa      soa_mas_cercano_escalar (float, distancia al cuadrado)
+//   simd     soa_mas_cercano (AVX2/SSE2 segun la CPU)
+//   indice   indice_mas_cercano (grilla de indice_espacial)
+// El tiempo incluye armar la SoA o la grilla de cada pasada.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "datos.h"
+#include "indice_espacial.h"
+#include "logica_robot.h"
+#include "mangos_soa.h"
+
+#define REPETICIONES_MIN 200000   /* busquedas minimas por medicion */
+
+static double ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Caja cuadrada con los mangos en grilla y un poco de ruido, como escanear_caja */
+static void armar_caja(Caja *caja, int n, unsigned int *seed) {
+    int lado = (int)ceil(sqrt((double)n));
+    float paso = 9.5f;
+    caja->id = 1;
+    caja->num_mangos = n;
+    caja->area_caja = (float)(lado * lado) * paso * paso;
+    caja->mangos = calloc((size_t)n, sizeof(Mango));
+    for (int i = 0; i < n; i++) {
+        Mango *m = &caja->mangos[i];
+        m->id = i + 1;
+        m->area = 90.0f;
+        m->x = (float)(i % lado) * paso - (float)lado * paso / 2.0f + (float)(rand_r(seed) % 100) / 100.0f;
+        m->y = (float)(i / lado) * paso - (float)lado * paso / 2.0f + (float)(rand_r(seed) % 100) / 100.0f;
+    }
+}
+
+enum { B_LINEAL, B_SOA, B_SIMD, B_INDICE, NUM_BUSQUEDAS };
+static const char *nombres[NUM_BUSQUEDAS] = { "lineal", "soa", "simd", "indice" };
+
+/* Una pasada completa: busca, etiqueta, mueve el brazo, hasta vaciar la caja.
+   Devuelve la suma de indices elegidos para comparar entre variantes. */
+static long pasada(int variante, Caja *caja, MangosSoA *soa, IndiceEspacial *ind) {
+    long suma = 0;
+    double ax = 0.0, ay = 0.0;
+    for (int i = 0; i < caja->num_mangos; i++) caja->mangos[i].etiquetado = 0;
+    if (variante == B_SOA || variante == B_SIMD) {
+        liberar_soa(soa);
+        soa_desde_caja(soa, caja);
+    } else if (variante == B_INDICE) {
+        liberar_indice(ind);
+        construir_indice(ind, caja);
+    }
+
+    for (int k = 0; k < caja->num_mangos; k++) {
+        int idx;
+        float d2;
+        switch (variante) {
+        case B_LINEAL: idx = buscar_mango_cercano(caja, ax, ay, NULL); break;
+        case B_SOA:    idx = soa_mas_cercano_escalar(soa, (float)ax, (float)ay, &d2); break;
+        case B_SIMD:   idx = soa_mas_cercano(soa, (float)ax, (float)ay, &d2); break;
+        default:       idx = indice_mas_cercano(ind, caja, ax, ay, NULL); break;
+        }
+        if (idx < 0) break;
+        caja->mangos[idx].etiquetado = 1;
+        if (variante == B_SOA || variante == B_SIMD) soa_marcar(soa, idx);
+        else if (variante == B_INDICE) indice_quitar(ind, caja, idx);
+        ax = caja->mangos[idx].x;
+        ay = caja->mangos[idx].y;
+        suma += idx;
+    }
+    return suma;
+}
+
+int main(int argc, char *argv[]) {
+    int tamanios[] = { 16, 64, 256, 1024, 4096 };
+    int num_tamanios = (int)(sizeof(tamanios) / sizeof(tamanios[0]));
+    unsigned int seed = argc > 1 ? (unsigned int)atoi(argv[1]) : 1u;
+
+    printf("kernel simd: %s\n", soa_kernel());
+    printf("%8s", "mangos");
+    for (int v = 0; v < NUM_BUSQUEDAS; v++) printf(" %10s", nombres[v]);
+    printf("   (ns por busqueda)  x lineal/simd\n");
+
+    for (int t = 0; t < num_tamanios; t++) {
+        Caja caja;
+        MangosSoA soa;
+        IndiceEspacial ind;
+        memset(&soa, 0, sizeof(soa));
+        memset(&ind, 0, sizeof(ind));
+        armar_caja(&caja, tamanios[t], &seed);
+
+        int vueltas = REPETICIONES_MIN / tamanios[t] + 1;
+        double ns[NUM_BUSQUEDAS];
+        long control[NUM_BUSQUEDAS];
+        for (int v = 0; v < NUM_BUSQUEDAS; v++) {
+            control[v] = pasada(v, &caja, &soa, &ind);   /* calentamiento */
+            double t0 = ahora();
+            for (int r = 0; r < vueltas; r++) pasada(v, &caja, &soa, &ind);
+            double t1 = ahora();
+            ns[v] = (t1 - t0) * 1e9 / ((double)vueltas * tamanios[t]);
+        }
+
+        printf("%8d", tamanios[t]);
+        for (int v = 0; v < NUM_BUSQUEDAS; v++) printf(" %10.1f", ns[v]);
+        printf("   %.1fx", ns[B_LINEAL] / ns[B_SIMD]);
+        if (control[B_SOA] != control[B_SIMD])
+            printf("   (simd difiere del escalar!)");
+        printf("\n");
+
+        liberar_soa(&soa);
+        liberar_indice(&ind);
+        free(caja.mangos);
+    }
+    return 0;
+}
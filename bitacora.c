@@ -0,0 +1,575 @@
+// bitacora.c - log asincrono: un anillo por hilo y un hilo escritor
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+
+#include "bitacora.h"
+
+#define BIT_MAGIC   "MNGB"
+#define BIT_VERSION 1u
+
+/* Registros del archivo binario (orden de bytes de la maquina que escribe):
+     cabecera     "MNGB", version (u32)
+     REG_FORMATO  id (u32), largo (u16), texto del formato sin NUL
+     REG_LINEA    t_ns desde el inicio (u64), hilo (u16), nivel (u8), id de
+                  formato (u32), nargs (u8), tipos[nargs] (u8), args[nargs]
+                  (8 bytes), largo_texto (u8), texto[largo_texto]          */
+enum { REG_FORMATO = 1, REG_LINEA = 2 };
+
+/* Tipo de cada argumento capturado */
+enum { T_INT, T_LONG, T_LLONG, T_SSIZE, T_UINT, T_ULONG, T_ULLONG, T_SIZE,
+       T_DOUBLE, T_CADENA, T_PUNTERO, NUM_TIPOS };
+
+typedef union {
+    long long i;
+    unsigned long long u;   // T_CADENA: desplazamiento dentro de texto
+    double d;
+    const void *p;
+} BitArg;
+
+/* Una linea sin formatear: 128 bytes, dos lineas de cache */
+typedef struct {
+    uint64_t t_ns;
+    const char *fmt;
+    uint16_t hilo;
+    uint8_t nivel;
+    uint8_t nargs;
+    uint8_t largo_texto;
+    uint8_t tipos[BIT_MAX_ARGS];
+    BitArg args[BIT_MAX_ARGS];
+    char texto[BIT_TEXTO];
+} BitRegistro;
+
+/* Anillo de un hilo: el hilo avanza cabeza, el escritor avanza cola. Cada
+   indice en su propia linea de cache para que no se peleen. */
+typedef struct BitAnillo {
+    _Atomic uint64_t cabeza;
+    char relleno1[64 - sizeof(uint64_t)];
+    _Atomic uint64_t cola;
+    char relleno2[64 - sizeof(uint64_t)];
+    atomic_int abandonado;      // el hilo termino: se reusa cuando queda vacio
+    atomic_ulong esperas;       // veces que el hilo encontro el anillo lleno
+    struct BitAnillo *sig;
+    BitRegistro ranuras[BIT_RANURAS];
+} BitAnillo;
+
+static const char *nombres_nivel[] = { "DEBUG", "INFO", "AVISO", "ERROR", "NADA" };
+
+static _Atomic(BitAnillo *) g_anillos = NULL;   // solo crece; se libera nunca
+static pthread_mutex_t g_lista_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_vaciado = PTHREAD_MUTEX_INITIALIZER;   // un escritor a la vez
+static pthread_mutex_t g_despertar_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_despertar;
+static pthread_key_t g_clave;
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+static __thread BitAnillo *t_anillo = NULL;
+static __thread int t_hilo = -1;
+
+static atomic_int g_activa = 0;
+static atomic_int g_terminar = 0;
+static atomic_int g_nivel = BIT_INFO;
+static atomic_int g_num_hilos = 0;
+static pthread_t g_hilo;
+static FILE *g_salida = NULL;
+static int g_binaria = 0;
+static uint64_t g_t0 = 0;
+
+/* Formatos ya escritos en el binario (solo los toca quien tiene g_vaciado) */
+static const char **g_formatos = NULL;
+static int g_num_formatos = 0;
+static int g_cap_formatos = 0;
+
+static uint64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ------------------ formatos ------------------ */
+/* p apunta justo despues de '%'. Deja *fin en la letra de conversion y
+   devuelve el tipo del argumento, o -1 si la especificacion no se soporta. */
+static int leer_especificacion(const char *p, const char **fin) {
+    while (*p && strchr("-+ #0", *p)) p++;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    int largo = 0;   /* 0 int, 1 long, 2 long long, 3 size_t */
+    if (*p == 'h') {
+        p++;
+        if (*p == 'h') p++;
+    } else if (*p == 'l') {
+        p++;
+        largo = 1;
+        if (*p == 'l') {
+            p++;
+            largo = 2;
+        }
+    } else if (*p == 'z') {
+        p++;
+        largo = 3;
+    }
+    *fin = p;
+    static const int con_signo[] = { T_INT, T_LONG, T_LLONG, T_SSIZE };
+    static const int sin_signo[] = { T_UINT, T_ULONG, T_ULLONG, T_SIZE };
+    switch (*p) {
+    case 'd': case 'i': return con_signo[largo];
+    case 'u': case 'x': case 'X': case 'o': return sin_signo[largo];
+    case 'c': return largo == 0 ? T_INT : -1;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        return largo == 0 ? T_DOUBLE : -1;
+    case 's': return largo == 0 ? T_CADENA : -1;
+    case 'p': return largo == 0 ? T_PUNTERO : -1;
+    }
+    return -1;
+}
+
+/* Copia los argumentos al registro; un formato no soportado o de mas corta
+   la captura y lo que sigue del formato sale literal */
+static void capturar(BitRegistro *r, const char *fmt, va_list ap) {
+    r->nargs = 0;
+    r->largo_texto = 0;
+    for (const char *p = fmt; *p; p++) {
+        if (*p != '%') continue;
+        if (p[1] == '%') {
+            p++;
+            continue;
+        }
+        const char *fin;
+        int tipo = leer_especificacion(p + 1, &fin);
+        if (tipo < 0 || r->nargs == BIT_MAX_ARGS) break;
+        BitArg *a = &r->args[r->nargs];
+        switch (tipo) {
+        case T_INT:     a->i = va_arg(ap, int); break;
+        case T_LONG:    a->i = va_arg(ap, long); break;
+        case T_LLONG:   a->i = va_arg(ap, long long); break;
+        case T_SSIZE:   a->i = va_arg(ap, ssize_t); break;
+        case T_UINT:    a->u = va_arg(ap, unsigned int); break;
+        case T_ULONG:   a->u = va_arg(ap, unsigned long); break;
+        case T_ULLONG:  a->u = va_arg(ap, unsigned long long); break;
+        case T_SIZE:    a->u = va_arg(ap, size_t); break;
+        case T_DOUBLE:  a->d = va_arg(ap, double); break;
+        case T_PUNTERO: a->p = va_arg(ap, void *); break;
+        case T_CADENA: {
+            const char *s = va_arg(ap, const char *);
+            if (!s) s = "(null)";
+            size_t lugar = BIT_TEXTO - r->largo_texto;
+            if (lugar == 0) {
+                a->u = BIT_TEXTO - 1;   /* el NUL de la cadena anterior: "" */
+                break;
+            }
+            size_t n = strnlen(s, lugar - 1);
+            a->u = r->largo_texto;
+            memcpy(r->texto + r->largo_texto, s, n);
+            r->texto[r->largo_texto + n] = '\0';
+            r->largo_texto = (uint8_t)(r->largo_texto + n + 1);
+            break;
+        }
+        }
+        r->tipos[r->nargs++] = (uint8_t)tipo;
+        p = fin;
+    }
+}
+
+/* Arma la linea con printf de a una especificacion, con el tipo exacto */
+static void formatear(FILE *f, const BitRegistro *r) {
+    const char *p = r->fmt, *lit = p;
+    char espec[32];
+    int k = 0;
+    while (*p) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+        fwrite(lit, 1, (size_t)(p - lit), f);
+        lit = p;
+        if (p[1] == '%') {
+            fputc('%', f);
+            p += 2;
+            lit = p;
+            continue;
+        }
+        const char *fin;
+        int tipo = leer_especificacion(p + 1, &fin);
+        size_t n = (size_t)(fin - p) + 1;
+        if (tipo < 0 || k >= r->nargs || tipo != r->tipos[k] || n >= sizeof(espec)) break;
+        memcpy(espec, p, n);
+        espec[n] = '\0';
+        const BitArg *a = &r->args[k++];
+        switch (tipo) {
+        case T_INT:     fprintf(f, espec, (int)a->i); break;
+        case T_LONG:    fprintf(f, espec, (long)a->i); break;
+        case T_LLONG:   fprintf(f, espec, (long long)a->i); break;
+        case T_SSIZE:   fprintf(f, espec, (ssize_t)a->i); break;
+        case T_UINT:    fprintf(f, espec, (unsigned int)a->u); break;
+        case T_ULONG:   fprintf(f, espec, (unsigned long)a->u); break;
+        case T_ULLONG:  fprintf(f, espec, (unsigned long long)a->u); break;
+        case T_SIZE:    fprintf(f, espec, (size_t)a->u); break;
+        case T_DOUBLE:  fprintf(f, espec, a->d); break;
+        case T_PUNTERO: fprintf(f, espec, a->p); break;
+        case T_CADENA:  fprintf(f, espec, r->texto + a->u); break;
+        }
+        p = fin + 1;
+        lit = p;
+    }
+    fputs(lit, f);
+}
+
+static void escribir_texto(FILE *f, const BitRegistro *r, uint64_t t_rel) {
+    fprintf(f, "[%12.6f] %-5s ", (double)t_rel * 1e-9, nombres_nivel[r->nivel]);
+    formatear(f, r);
+    fputc('\n', f);
+}
+
+/* ------------------ salida binaria ------------------ */
+static int id_formato(const char *fmt, int *nuevo) {
+    *nuevo = 0;
+    for (int i = 0; i < g_num_formatos; i++)
+        if (g_formatos[i] == fmt) return i;
+    if (g_num_formatos == g_cap_formatos) {
+        int cap = g_cap_formatos ? g_cap_formatos * 2 : 32;
+        const char **nf = realloc(g_formatos, sizeof(*nf) * (size_t)cap);
+        if (!nf) return -1;
+        g_formatos = nf;
+        g_cap_formatos = cap;
+    }
+    g_formatos[g_num_formatos] = fmt;
+    *nuevo = 1;
+    return g_num_formatos++;
+}
+
+static void escribir_binario(FILE *f, const BitRegistro *r, uint64_t t_rel) {
+    int nuevo;
+    int id = id_formato(r->fmt, &nuevo);
+    if (id < 0) return;
+    uint32_t id32 = (uint32_t)id;
+    if (nuevo) {
+        size_t largo = strlen(r->fmt);
+        uint16_t l16 = (uint16_t)(largo > UINT16_MAX ? UINT16_MAX : largo);
+        fputc(REG_FORMATO, f);
+        fwrite(&id32, sizeof(id32), 1, f);
+        fwrite(&l16, sizeof(l16), 1, f);
+        fwrite(r->fmt, 1, l16, f);
+    }
+    fputc(REG_LINEA, f);
+    fwrite(&t_rel, sizeof(t_rel), 1, f);
+    fwrite(&r->hilo, sizeof(r->hilo), 1, f);
+    fputc(r->nivel, f);
+    fwrite(&id32, sizeof(id32), 1, f);
+    fputc(r->nargs, f);
+    fwrite(r->tipos, 1, r->nargs, f);
+    fwrite(r->args, sizeof(BitArg), r->nargs, f);
+    fputc(r->largo_texto, f);
+    fwrite(r->texto, 1, r->largo_texto, f);
+}
+
+/* ------------------ anillos ------------------ */
+static void hilo_termina(void *arg) {
+    BitAnillo *a = arg;
+    atomic_store_explicit(&a->abandonado, 1, memory_order_release);
+}
+
+static void crear_clave(void) {
+    pthread_key_create(&g_clave, hilo_termina);
+}
+
+/* Anillo del hilo actual: reusa el de un hilo que ya termino o crea uno */
+static BitAnillo *anillo_del_hilo(void) {
+    if (t_anillo) return t_anillo;
+    pthread_once(&g_once, crear_clave);
+    pthread_mutex_lock(&g_lista_lock);
+    BitAnillo *a = NULL;
+    for (BitAnillo *b = atomic_load(&g_anillos); b; b = b->sig) {
+        if (atomic_load_explicit(&b->abandonado, memory_order_acquire) &&
+            atomic_load(&b->cola) == atomic_load(&b->cabeza)) {
+            a = b;
+            atomic_store(&a->abandonado, 0);
+            break;
+        }
+    }
+    if (!a) {
+        a = calloc(1, sizeof(BitAnillo));
+        if (a) {
+            a->sig = atomic_load(&g_anillos);
+            atomic_store_explicit(&g_anillos, a, memory_order_release);
+        }
+    }
+    pthread_mutex_unlock(&g_lista_lock);
+    if (!a) return NULL;
+    pthread_setspecific(g_clave, a);
+    t_anillo = a;
+    if (t_hilo < 0) t_hilo = atomic_fetch_add(&g_num_hilos, 1);
+    return a;
+}
+
+static void despertar_escritor(void) {
+    pthread_cond_signal(&g_despertar);
+}
+
+void bitacora_registrar(int nivel, const char *fmt, ...) {
+    if (nivel < atomic_load_explicit(&g_nivel, memory_order_relaxed) || nivel >= BIT_NADA) return;
+    va_list ap;
+    va_start(ap, fmt);
+    BitAnillo *a = atomic_load_explicit(&g_activa, memory_order_acquire) ? anillo_del_hilo() : NULL;
+    if (!a) {
+        /* sin escritor: directo a stdout */
+        vprintf(fmt, ap);
+        putchar('\n');
+        va_end(ap);
+        return;
+    }
+
+    uint64_t h = atomic_load_explicit(&a->cabeza, memory_order_relaxed);
+    if (h - atomic_load_explicit(&a->cola, memory_order_acquire) >= BIT_RANURAS) {
+        atomic_fetch_add_explicit(&a->esperas, 1, memory_order_relaxed);
+        do {
+            despertar_escritor();
+            sched_yield();
+        } while (h - atomic_load_explicit(&a->cola, memory_order_acquire) >= BIT_RANURAS);
+    }
+    BitRegistro *r = &a->ranuras[h & (BIT_RANURAS - 1)];
+    r->t_ns = ahora_ns();
+    r->fmt = fmt;
+    r->hilo = (uint16_t)t_hilo;
+    r->nivel = (uint8_t)nivel;
+    capturar(r, fmt, ap);
+    va_end(ap);
+    atomic_store_explicit(&a->cabeza, h + 1, memory_order_release);
+
+    /* a mitad de anillo no se espera al proximo periodo */
+    if (h + 1 - atomic_load_explicit(&a->cola, memory_order_relaxed) == BIT_RANURAS / 2)
+        despertar_escritor();
+}
+
+/* Escribe lo pendiente de todos los anillos en orden de hora. Se llama con
+   g_vaciado tomado. */
+static void vaciar_anillos(void) {
+    static BitAnillo **anillos = NULL;
+    static uint64_t *limites = NULL;
+    static int cap = 0;
+
+    int n = 0;
+    for (BitAnillo *a = atomic_load_explicit(&g_anillos, memory_order_acquire); a; a = a->sig) {
+        if (n == cap) {
+            int ncap = cap ? cap * 2 : 16;
+            BitAnillo **na = realloc(anillos, sizeof(*na) * (size_t)ncap);
+            if (!na) break;
+            anillos = na;
+            uint64_t *nl = realloc(limites, sizeof(*nl) * (size_t)ncap);
+            if (!nl) break;
+            limites = nl;
+            cap = ncap;
+        }
+        anillos[n] = a;
+        limites[n] = atomic_load_explicit(&a->cabeza, memory_order_acquire);
+        n++;
+    }
+
+    while (1) {
+        int elegido = -1;
+        uint64_t t_min = UINT64_MAX;
+        for (int i = 0; i < n; i++) {
+            uint64_t c = atomic_load_explicit(&anillos[i]->cola, memory_order_relaxed);
+            if (c == limites[i]) continue;
+            uint64_t t = anillos[i]->ranuras[c & (BIT_RANURAS - 1)].t_ns;
+            if (t < t_min) {
+                t_min = t;
+                elegido = i;
+            }
+        }
+        if (elegido < 0) break;
+        BitAnillo *a = anillos[elegido];
+        uint64_t c = atomic_load_explicit(&a->cola, memory_order_relaxed);
+        const BitRegistro *r = &a->ranuras[c & (BIT_RANURAS - 1)];
+        uint64_t t_rel = r->t_ns > g_t0 ? r->t_ns - g_t0 : 0;
+        if (g_binaria) escribir_binario(g_salida, r, t_rel);
+        else escribir_texto(g_salida, r, t_rel);
+        atomic_store_explicit(&a->cola, c + 1, memory_order_release);
+    }
+    fflush(g_salida);
+}
+
+static void *hilo_escritor(void *arg) {
+    (void)arg;
+    while (!atomic_load(&g_terminar)) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        ts.tv_nsec += BIT_PERIODO_MS * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&g_despertar_lock);
+        pthread_cond_timedwait(&g_despertar, &g_despertar_lock, &ts);
+        pthread_mutex_unlock(&g_despertar_lock);
+        bitacora_vaciar();
+    }
+    return NULL;
+}
+
+/* ------------------ API ------------------ */
+int bitacora_nivel(const char *nombre) {
+    static const char *nombres[] = { "debug", "info", "aviso", "error", "nada" };
+    for (int i = 0; i <= BIT_NADA; i++)
+        if (nombre && strcmp(nombre, nombres[i]) == 0) return i;
+    return -1;
+}
+
+int bitacora_iniciar(const char *archivo_binario, int nivel) {
+    static int registrada = 0;
+    if (atomic_load(&g_activa)) return 0;
+    atomic_store(&g_nivel, nivel);
+
+    g_binaria = archivo_binario != NULL;
+    g_salida = stdout;
+    if (g_binaria) {
+        g_salida = fopen(archivo_binario, "wb");
+        if (!g_salida) {
+            perror("fopen(bitacora)");
+            g_salida = stdout;
+            g_binaria = 0;
+            return -1;
+        }
+        uint32_t version = BIT_VERSION;
+        fwrite(BIT_MAGIC, 1, 4, g_salida);
+        fwrite(&version, sizeof(version), 1, g_salida);
+    }
+    g_num_formatos = 0;
+    g_t0 = ahora_ns();
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_despertar, &attr);
+    pthread_condattr_destroy(&attr);
+
+    atomic_store(&g_terminar, 0);
+    atomic_store(&g_activa, 1);
+    if (pthread_create(&g_hilo, NULL, hilo_escritor, NULL) != 0) {
+        perror("pthread_create(bitacora)");
+        atomic_store(&g_activa, 0);
+        if (g_binaria) fclose(g_salida);
+        g_salida = stdout;
+        g_binaria = 0;
+        return -1;
+    }
+    /* exit() desde cualquier lado igual escribe lo pendiente */
+    if (!registrada) {
+        atexit(bitacora_cerrar);
+        registrada = 1;
+    }
+    return 0;
+}
+
+void bitacora_vaciar(void) {
+    if (!atomic_load(&g_activa)) {
+        fflush(stdout);
+        return;
+    }
+    pthread_mutex_lock(&g_vaciado);
+    vaciar_anillos();
+    pthread_mutex_unlock(&g_vaciado);
+}
+
+void bitacora_cerrar(void) {
+    if (!atomic_load(&g_activa)) return;
+    atomic_store(&g_terminar, 1);
+    despertar_escritor();
+    pthread_join(g_hilo, NULL);
+
+    pthread_mutex_lock(&g_vaciado);
+    vaciar_anillos();
+    atomic_store(&g_activa, 0);
+    unsigned long esperas = 0;
+    for (BitAnillo *a = atomic_load(&g_anillos); a; a = a->sig)
+        esperas += atomic_exchange(&a->esperas, 0);
+    if (g_binaria) fclose(g_salida);
+    g_salida = stdout;
+    g_binaria = 0;
+    free(g_formatos);
+    g_formatos = NULL;
+    g_num_formatos = g_cap_formatos = 0;
+    pthread_mutex_unlock(&g_vaciado);
+    pthread_cond_destroy(&g_despertar);
+    if (esperas > 0) fprintf(stderr, "bitacora: %lu esperas por anillo lleno\n", esperas);
+}
+
+/* ------------------ lectura del binario ------------------ */
+static int leer(FILE *f, void *dst, size_t n) {
+    return fread(dst, 1, n, f) == n ? 0 : -1;
+}
+
+/* Pasa a texto un archivo escrito con bitacora_iniciar(archivo, ...).
+   Devuelve 0 si lo leyo completo, -1 si esta cortado o no es una bitacora. */
+int bitacora_decodificar(FILE *entrada, FILE *salida) {
+    char magic[4];
+    uint32_t version;
+    if (leer(entrada, magic, 4) != 0 || memcmp(magic, BIT_MAGIC, 4) != 0 ||
+        leer(entrada, &version, sizeof(version)) != 0 || version != BIT_VERSION) {
+        fprintf(stderr, "No es una bitacora binaria (o de otra version)\n");
+        return -1;
+    }
+
+    char **formatos = NULL;
+    int num_formatos = 0, rc = 0, tipo;
+    while ((tipo = fgetc(entrada)) != EOF) {
+        if (tipo == REG_FORMATO) {
+            uint32_t id;
+            uint16_t largo;
+            if (leer(entrada, &id, sizeof(id)) != 0 || leer(entrada, &largo, sizeof(largo)) != 0 ||
+                id != (uint32_t)num_formatos) {
+                rc = -1;
+                break;
+            }
+            char **nf = realloc(formatos, sizeof(*nf) * (size_t)(num_formatos + 1));
+            char *texto = malloc((size_t)largo + 1);
+            if (nf) formatos = nf;
+            if (!nf || !texto || leer(entrada, texto, largo) != 0) {
+                free(texto);
+                rc = -1;
+                break;
+            }
+            texto[largo] = '\0';
+            formatos[num_formatos++] = texto;
+        } else if (tipo == REG_LINEA) {
+            BitRegistro r;
+            memset(&r, 0, sizeof(r));
+            uint64_t t_rel;
+            uint32_t id;
+            int ok = leer(entrada, &t_rel, sizeof(t_rel)) == 0 && leer(entrada, &r.hilo, sizeof(r.hilo)) == 0 &&
+                     leer(entrada, &r.nivel, 1) == 0 && leer(entrada, &id, sizeof(id)) == 0 &&
+                     leer(entrada, &r.nargs, 1) == 0 && r.nargs <= BIT_MAX_ARGS && r.nivel < BIT_NADA &&
+                     id < (uint32_t)num_formatos && leer(entrada, r.tipos, r.nargs) == 0 &&
+                     leer(entrada, r.args, sizeof(BitArg) * r.nargs) == 0 &&
+                     leer(entrada, &r.largo_texto, 1) == 0 && r.largo_texto <= BIT_TEXTO &&
+                     leer(entrada, r.texto, r.largo_texto) == 0;
+            for (int k = 0; ok && k < r.nargs; k++) {
+                if (r.tipos[k] >= NUM_TIPOS) ok = 0;
+                else if (r.tipos[k] == T_CADENA && r.args[k].u >= BIT_TEXTO) ok = 0;
+            }
+            if (!ok) {
+                rc = -1;
+                break;
+            }
+            r.texto[BIT_TEXTO - 1] = '\0';
+            r.fmt = formatos[id];
+            escribir_texto(salida, &r, t_rel);
+        } else {
+            rc = -1;
+            break;
+        }
+    }
+    if (rc != 0) fprintf(stderr, "Bitacora cortada o con registros invalidos\n");
+    for (int i = 0; i < num_formatos; i++) free(formatos[i]);
+    free(formatos);
+    return rc;
+}
@@ -0,0 +1,56 @@
+#ifndef BITACORA_H
+#define BITACORA_H
+
+#include <stdio.h>
+
+// ---------- BITACORA ASINCRONA (LOG) ----------
+// Cada hilo escribe en su propio anillo (un productor, un consumidor, sin
+// lock) el formato, los argumentos crudos y la hora; un hilo aparte los
+// formatea y los escribe mezclados por hora (el orden es exacto dentro de cada
+// vaciado; entre vaciados puede haber saltos de microsegundos entre hilos).
+// En el camino caliente no hay
+// printf, ni lock de stdout, ni syscalls: solo copiar los argumentos.
+// Si un anillo se llena el hilo espera a que se vacie (no se pierden lineas).
+//
+// Niveles: debajo de BITACORA_NIVEL_MIN la llamada desaparece al compilar
+// (make BITACORA_NIVEL_MIN=BIT_NADA la apaga del todo); el resto se filtra en
+// tiempo de ejecucion con el nivel de bitacora_iniciar.
+// Formatos: %d %i %u %x %X %o %c %f %e %g %E %G %s %p con flags, ancho,
+// precision y modificadores h/l/ll/z; hasta BIT_MAX_ARGS argumentos. Las
+// cadenas (%s) se copian al anillo hasta BIT_TEXTO bytes entre todas.
+// Salida de texto en stdout o binaria compacta en un archivo (cada formato se
+// escribe una sola vez); el binario se lee con leer_bitacora.
+
+#define BIT_DEBUG 0
+#define BIT_INFO  1
+#define BIT_AVISO 2
+#define BIT_ERROR 3
+#define BIT_NADA  4
+
+#ifndef BITACORA_NIVEL_MIN
+#define BITACORA_NIVEL_MIN BIT_DEBUG
+#endif
+
+#define BIT_MAX_ARGS 8
+#define BIT_TEXTO    32      // bytes para copias de %s por linea
+#define BIT_RANURAS  1024    // lineas por anillo (potencia de 2)
+#define BIT_PERIODO_MS 10    // cada cuanto el escritor vacia los anillos
+
+#define bitacora(nivel, ...) \
+    do { if ((nivel) >= BITACORA_NIVEL_MIN) bitacora_registrar((nivel), __VA_ARGS__); } while (0)
+#define bit_debug(...) bitacora(BIT_DEBUG, __VA_ARGS__)
+#define bit_info(...)  bitacora(BIT_INFO, __VA_ARGS__)
+#define bit_aviso(...) bitacora(BIT_AVISO, __VA_ARGS__)
+#define bit_error(...) bitacora(BIT_ERROR, __VA_ARGS__)
+
+// archivo_binario NULL = texto en stdout. Antes de iniciar (o despues de
+// cerrar) cada linea se escribe directo en stdout, sin hilo.
+int bitacora_iniciar(const char *archivo_binario, int nivel);
+void bitacora_vaciar(void);     // escribe todo lo registrado hasta ahora
+void bitacora_cerrar(void);     // vacia, termina el escritor y cierra el archivo
+int bitacora_nivel(const char *nombre);   // "debug".."nada" -> nivel, -1 si no existe
+int bitacora_decodificar(FILE *entrada, FILE *salida);
+
+void bitacora_registrar(int nivel, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+#endif
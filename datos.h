@@ -18,6 +18,7 @@ typedef struct {
     float area_caja;     // rea de la caja (cm)
     int num_mangos;      // Nmero de mangos dentro de la caja
     Mango *mangos;       // Arreglo dinmico de mangos
+    int *ruta;           // Orden de visita planificado (ndices de mangos), NULL si no hay
 } Caja;
 
 // Representa el estado general del sistema
@@ -0,0 +1,65 @@
+// escalado.c - cantidad de robots activos en lazo cerrado sobre las metricas de la celda
+
+#include <math.h>
+#include <string.h>
+
+#include "escalado.h"
+
+void iniciar_control_robots(ControlRobots *c, int inicial, int maximo, double transito, double ahora) {
+    memset(c, 0, sizeof(*c));
+    c->maximo = maximo > 0 ? maximo : 1;
+    c->objetivo = inicial < 1 ? 1 : (inicial > c->maximo ? c->maximo : inicial);
+    c->piso = 1;
+    c->transito = transito > 0.0 ? transito : 0.0;
+    c->t_cambio = ahora;
+}
+
+/* El tramo de medicion arranca de cero con el objetivo dado */
+static void nuevo_tramo(ControlRobots *c, int objetivo, const MetricasCelda *m, double ahora) {
+    c->bajo = objetivo < c->objetivo;
+    if (objetivo != c->objetivo) c->cambios++;
+    c->objetivo = objetivo;
+    c->t_cambio = ahora;
+    c->medido = 0;
+    c->base = *m;
+    c->util_suma = 0.0;
+    c->util_n = 0;
+}
+
+int control_robots_paso(ControlRobots *c, const MetricasCelda *m, double ahora) {
+    int n = c->objetivo;
+    if (c->piso > 1 && ahora - c->t_piso >= ESCALADO_OLVIDO_TRANSITOS * c->transito) c->piso = 1;
+    if (!c->medido && ahora - c->t_cambio >= c->transito) {
+        /* ya salieron las cajas que entraron antes del cambio */
+        c->medido = 1;
+        c->t_medido = ahora;
+        c->base = *m;
+        c->util_suma = 0.0;
+        c->util_n = 0;
+    }
+    c->util_suma += m->utilizacion;
+    c->util_n++;
+    c->utilizacion = c->util_suma / (double)c->util_n;
+
+    int salidos = m->mangos_salidos - c->base.mangos_salidos;
+    int perdidos = m->mangos_perdidos - c->base.mangos_perdidos;
+
+    if (perdidos > 0 && (c->bajo || c->medido)) {
+        /* con n se pierden mangos: n pasa a ser el piso */
+        c->piso = n + 1 <= c->maximo ? n + 1 : c->maximo;
+        c->t_piso = ahora;
+        int etiquetados = salidos - perdidos;
+        int nuevo = etiquetados > 0 ? (int)ceil((double)n * salidos / etiquetados) : c->maximo;
+        if (nuevo < c->piso) nuevo = c->piso;
+        if (nuevo > c->maximo) nuevo = c->maximo;
+        /* ya en el maximo: igual se mide de nuevo, para poder bajar cuando
+           la perdida pase */
+        nuevo_tramo(c, nuevo, m, ahora);
+        return c->objetivo;
+    }
+
+    if (c->medido && ahora - c->t_medido >= c->transito && perdidos == 0 && salidos > 0 && n > c->piso &&
+        c->utilizacion * n / (double)(n - 1) <= ESCALADO_UTIL_MAX)
+        nuevo_tramo(c, n - 1, m, ahora);
+    return c->objetivo;
+}
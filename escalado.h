@@ -0,0 +1,47 @@
+#ifndef ESCALADO_H
+#define ESCALADO_H
+
+#include "protocolo.h"
+
+// ---------- CONTROL DE ROBOTS EN LAZO CERRADO ----------
+// El escaner (escaner -C) decide cuantos robots tiene activos cada celda a
+// partir de las metricas que el robot devuelve en cada latido
+// (MetricasCelda), buscando la menor cantidad que todavia etiqueta todos los
+// mangos. El efecto de un cambio recien se ve cuando salen las cajas que
+// entraron despues, asi que la medicion limpia del tramo arranca un transito
+// de banda despues del cambio:
+//  - subir: si salieron mangos sin etiquetar se sube en proporcion a lo que
+//    falto, (salidos / etiquetados), al menos uno. Despues de una baja se
+//    reacciona enseguida (la perdida es de la baja); despues de una suba
+//    solo cuenta la medicion limpia, porque las cajas viejas todavia pierden.
+//  - bajar: si la medicion limpia cubrio un transito entero sin perdidas y
+//    los robots que quedan absorben la utilizacion media sin pasar de
+//    ESCALADO_UTIL_MAX, se baja de a uno.
+// Una cantidad que ya perdio mangos queda como piso durante
+// ESCALADO_OLVIDO_TRANSITOS transitos (si no, se oscilaria entre n y n-1).
+// No tiene hilos ni E/S: lo usa el bucle epoll del escaner.
+
+#define ESCALADO_UTIL_MAX 0.85        // utilizacion maxima de los que quedan al bajar
+#define ESCALADO_OLVIDO_TRANSITOS 10  // cuanto dura el piso que dejo una perdida
+
+typedef struct {
+    int objetivo;          // robots que se piden en el latido
+    int maximo;            // robots_maximos de la celda
+    int piso;              // menor cantidad permitida (1 = sin piso)
+    double transito;       // s que tarda una caja en recorrer la banda
+    double t_cambio;       // instante del ultimo cambio de objetivo
+    int medido;            // ya salieron las cajas de antes del cambio: base es limpia
+    double t_medido;       // instante en que arranco la medicion limpia
+    double t_piso;         // instante en que se fijo el piso
+    int bajo;              // el ultimo cambio fue una baja
+    MetricasCelda base;    // metricas al arrancar el tramo (cambio o medicion limpia)
+    double util_suma;      // utilizacion reportada en el tramo
+    long util_n;
+    double utilizacion;    // media del tramo al ultimo paso
+    long cambios;
+} ControlRobots;
+
+void iniciar_control_robots(ControlRobots *c, int inicial, int maximo, double transito, double ahora);
+int control_robots_paso(ControlRobots *c, const MetricasCelda *m, double ahora);   // objetivo nuevo
+
+#endif
@@ -1,22 +1,33 @@
 // escaner.c - servidor "scanner" para la simulacin MangoNeado
-// Compilar: gcc escaner.c -o escaner -lm
+// Compilar: make escaner
 
+#define _GNU_SOURCE   // accept4
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
 #include <string.h>
 #include <math.h>
 #include <time.h>
 #include <unistd.h>
 #include <errno.h>
 #include <signal.h>
+#include <pthread.h>
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 #include "datos.h"   // Debe contener Mango, Caja, EstadoSistema
+#include "arena.h"
+#include "bitacora.h"
+#include "escalado.h"
+#include "protocolo.h"
+#include "ruta.h"
+#include "snapshot.h"
 
 // ---- Configurables / Constantes ----
 #define CONST_VEL 10.0      // velocidad relativa (se usa en cliente)
@@ -24,15 +35,121 @@
 #define MAX_ROBOTS 200
 #define AREA_MANGO_PROM 90  // rea promedio aproximada (cm^2)
 #define SERVER_PORT 7734
+#define MAX_EVENTOS 64      // eventos por llamada a epoll_wait
+#define LATIDO_MS 100       // periodo del latido (TRAMA_LATIDO) hacia cada cliente
+#define MAX_CARGA_CLIENTE 64 // el cliente solo manda TRAMA_METRICAS y TRAMA_FIN
+#define CAJAS_POR_VUELTA 8  // modo flujo: cajas escaneadas por cliente en cada vuelta
+#define MAX_HILOS_POOL 64   // hilos del pool para clculos por caja
+#define BLOQUE_POOL 64      // cajas que toma un hilo del pool en cada vuelta
+#define PLAN_CAJAS 20       // -Q: cajas por punto de la grilla (-n)
+#define PLAN_MAX_VALORES 1000 // -Q: valores por rango
+
+// Bytes pendientes de envo hacia un cliente. `externo` apunta a la trama del
+// estado completo, compartida por todos los clientes y enviada antes que `datos`.
+typedef struct {
+    const uint8_t *externo;
+    size_t externo_len;
+    size_t externo_off;
+    uint8_t *datos;
+    size_t len;
+    size_t off;
+    size_t cap;
+} BufferSalida;
+
+// Fases de un cliente robot
+enum { FASE_ESTADO = 0, FASE_FLUJO, FASE_LATIDO };
+
+// Un robot conectado al servidor
+typedef struct ClienteRobot {
+    int fd;
+    char ip[INET_ADDRSTRLEN];
+    int puerto;
+    int fase;
+    BufferSalida salida;
+    int quiere_epollout;       // EPOLLOUT registrado (hay bytes pendientes)
+    int siguiente_caja;        // modo flujo: id de la prxima caja a escanear
+    int esperando_respuesta;   // latido enviado, falta la respuesta (TRAMA_METRICAS)
+    int terminar;              // el cliente mand TRAMA_FIN: cerrar al vaciar el buffer
+    long latidos;              // latidos enviados
+    long latidos_omitidos;     // ticks sin latido porque el cliente iba lento
+    uint8_t entrada[PROTO_CABECERA + MAX_CARGA_CLIENTE]; // trama del cliente a medio leer
+    size_t entrada_len;
+    ControlRobots control;     // robots que se le piden en el latido (escalado.h)
+    int indice;                // posicin en ServidorEscaner.clientes
+    struct ClienteRobot *sig_cerrado; // lista de cerrados pendientes de liberar
+} ClienteRobot;
+
+// Estado del servidor epoll
+typedef struct {
+    int epfd;
+    int server_fd;
+    int timer_fd;
+    ClienteRobot **clientes;
+    int num_clientes;
+    int cap_clientes;
+    ClienteRobot *cerrados;     // cerrados en la vuelta actual de epoll
+    EstadoSistema *estado;      // estado completo (o caja de muestra en modo flujo)
+    uint8_t *trama_estado;      // TRAMA_ESTADO serializada una sola vez
+    size_t trama_estado_len;
+    int flujo;                  // 1 = cada cliente recibe sus cajas una por una
+    int cajas_flujo;            // total por cliente en modo flujo (0 = sin fin)
+    float area_caja;
+    int robots_maximos;
+    int control;                // 1 = robots en lazo cerrado con las mtricas del latido (-C)
+    double transito;            // s que tarda una caja en recorrer la banda
+} ServidorEscaner;
+
+// Trabajo repartido entre los hilos del pool: tarea(ctx, i) para i en [0, n)
+typedef void (*TareaCaja)(void *ctx, int i);
+typedef struct {
+    TareaCaja tarea;
+    void *ctx;
+    int n;
+    int bloque;             // cajas que toma un hilo en cada vuelta
+    int siguiente;          // prxima caja sin asignar
+    pthread_mutex_t lock;   // protege siguiente
+} TrabajoPool;
+
+// Un rango del planificador de capacidad (-Q): desde, desde+paso, ... <= hasta
+typedef struct {
+    float desde, hasta, paso;
+    int n;                  // cantidad de valores
+} RangoPlan;
+
+typedef struct {
+    RangoPlan vel, largo, area, densidad, robots;
+    int cajas;              // cajas por punto (-n)
+    unsigned int semilla;   // -s
+    int *necesarios;        // robots de cada punto (-1 = imposible, -2 = error)
+    EstadoSistema *conjuntos; // cajas de cada (rea, densidad); cajas NULL = sin memoria
+    Arena *arenas;          // bloque de cada conjunto
+} Plan;
 
 // Prototipos
-int calcular_min_robots_para_rango(EstadoSistema *estado, float area_caja, int robots_maximos);
-int crear_cajas(EstadoSistema *estado, float area_caja, int robots_maximos);
-void acomodarEnGrilla(Caja *caja);
+int calcular_min_robots_para_rango(EstadoSistema *estado, float area_caja, int robots_maximos, int *robots_por_caja);
+int robots_para_caja(const Caja *caja, float tiempo_ventana);
+void paralelo_por_caja(int n, TareaCaja tarea, void *ctx);
+void paralelo_en_bloques(int n, int bloque, TareaCaja tarea, void *ctx);
+int parsear_rango(RangoPlan *r, const char *spec);
+int planificar_capacidad(Plan *p, const char *archivo);
+void imprimir_robots_por_caja(const EstadoSistema *estado, const int *robots_por_caja, double ms);
+int crear_cajas(EstadoSistema *estado, Arena *arena, float area_caja, int robots_maximos, float densidad,
+                unsigned int *semilla);
+int crear_caja(Caja *caja, int id, float area_caja, float densidad, Arena *arena, unsigned int *semilla);
+int mangos_base_caja(float area_caja, float densidad);
+void acomodarEnGrilla(Caja *caja, unsigned int *semilla);
 void escanear(EstadoSistema *estado);
+void escanear_caja(Caja *c);
+void ubicar_mangos(Caja *c, unsigned int *semilla);
+void imprimir_caja(const Caja *c);
 void cleanup_estado(EstadoSistema *estado);
-int enviar_estado(int sock, EstadoSistema *estado, int robots_maximos);
-int send_all(int sock, const void *buffer, size_t length);
+void manejar_senal_fin(int sig);
+int servir_clientes(ServidorEscaner *srv);
+void aceptar_clientes(ServidorEscaner *srv);
+void cerrar_cliente(ServidorEscaner *srv, ClienteRobot *cli);
+int vaciar_cliente(ServidorEscaner *srv, ClienteRobot *cli);
+void leer_cliente(ServidorEscaner *srv, ClienteRobot *cli);
+void latido_clientes(ServidorEscaner *srv);
 void limpiarBuffer();
 float pedirFloat(const char *mensaje);
 int pedirInt(const char *mensaje);
@@ -46,16 +163,62 @@ int main(int argc, char *argv[]) {
 
     // ------ Configuracin inicial de parmetros ------
 	EstadoSistema estado = {0};
+	Arena arena = {0};   // bloque unico del estado, se reusa entre reintentos
 	float area_caja;
 	int robots_maximos;
 	int flag_P = 1; // si 1 usa parmetros por defecto, si 0 pide por stdin
+	int flag_F = 0; // si 1 enva las cajas en flujo, una por mensaje, a medida que se escanean
+	int cajas_flujo = 0; // total de cajas en modo flujo (0 = sin fin)
+	const char *snapshot = NULL; // -G: graba el estado escaneado en este archivo y termina
+	const char *bitacora_bin = NULL; // -B: bitacora binaria en este archivo (si no, texto en stdout)
+	int nivel_bitacora = BIT_INFO;   // -L debug|info|aviso|error|nada
+	int flag_C = 0; // si 1 ajusta los robots de cada cliente con sus mtricas (escalado.h)
+	const char *plan = NULL; // -Q: barre la grilla de -v -l -a -d -r, escribe el CSV y termina
+	Plan p = { .vel = { 5.0f, 5.0f, 1.0f, 1 }, .largo = { 700.0f, 700.0f, 1.0f, 1 },
+	           .area = { 500.0f, 500.0f, 1.0f, 1 }, .densidad = { 1.0f, 1.0f, 1.0f, 1 },
+	           .robots = { 10.0f, 10.0f, 1.0f, 1 }, .cajas = PLAN_CAJAS };
+	p.semilla = (unsigned)time(NULL);
 	
 	srand((unsigned)time(NULL));
 	
-	// parsear -E para pedir entrada interactiva
+	// parsear -E para pedir entrada interactiva, -F para modo flujo, -G <archivo> para grabar,
+	// -L <nivel> y -B <archivo> para la bitacora, -C para escalar robots en lazo cerrado.
+	// -Q <archivo.csv> planifica la capacidad sobre los rangos desde:hasta:paso de
+	// -v (velocidad), -l (longitud), -a (rea), -d (densidad) y -r (robots mximos),
+	// con -n cajas por punto y semilla -s
 	for (int i = 1; i < argc; ++i) {
+	    RangoPlan *rango = NULL;
 	    if (strcmp(argv[i], "-E") == 0) flag_P = 0;
+	    else if (strcmp(argv[i], "-Q") == 0 && i + 1 < argc) plan = argv[++i];
+	    else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) p.cajas = atoi(argv[++i]);
+	    else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) p.semilla = (unsigned)strtoul(argv[++i], NULL, 10);
+	    else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc) rango = &p.vel;
+	    else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) rango = &p.largo;
+	    else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) rango = &p.area;
+	    else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) rango = &p.densidad;
+	    else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) rango = &p.robots;
+	    else if (strcmp(argv[i], "-F") == 0) flag_F = 1;
+	    else if (strcmp(argv[i], "-C") == 0) flag_C = 1;
+	    else if (strcmp(argv[i], "-G") == 0 && i + 1 < argc) snapshot = argv[++i];
+	    else if (strcmp(argv[i], "-B") == 0 && i + 1 < argc) bitacora_bin = argv[++i];
+	    else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc) {
+	        nivel_bitacora = bitacora_nivel(argv[++i]);
+	        if (nivel_bitacora < 0) {
+	            fprintf(stderr, "Nivel de bitacora invalido: %s (debug|info|aviso|error|nada)\n", argv[i]);
+	            return EXIT_FAILURE;
+	        }
+	    }
+	    if (rango && parsear_rango(rango, argv[++i]) != 0) {
+	        fprintf(stderr, "Rango invalido para %s: %s (desde:hasta:paso, positivos)\n", argv[i - 1], argv[i]);
+	        return EXIT_FAILURE;
+	    }
 	}
+	if (snapshot && flag_F) {
+	    fprintf(stderr, "-G graba el estado completo: no se combina con -F\n");
+	    return EXIT_FAILURE;
+	}
+	if (plan) return planificar_capacidad(&p, plan) == 0 ? 0 : EXIT_FAILURE;
+	if (bitacora_iniciar(bitacora_bin, nivel_bitacora) != 0) return EXIT_FAILURE;
 	
 	int parametros_validos = 0;
 	while (!parametros_validos) {
@@ -74,18 +237,24 @@ int main(int argc, char *argv[]) {
 	        robots_maximos = pedirInt("Numero maximo de robots disponibles: ");
 	    }
 	
-	    // validar entradas bsicas
+	    // validar entradas bsicas (en modo flujo 0 cajas = sin fin)
 	    if (estado.velocidad_banda <= 0.0f || estado.longitud_banda <= 0.0f ||
-	        estado.num_cajas <= 0 || robots_maximos <= 0) {
+	        estado.num_cajas < (flag_F ? 0 : 1) || robots_maximos <= 0) {
 	        printf("Parametros invalidos. Intenta nuevamente.\n");
 	        continue;
 	    }
+
+	    // en modo flujo solo se escanea una caja de muestra para dimensionar robots
+	    if (flag_F) {
+	        cajas_flujo = estado.num_cajas;
+	        estado.num_cajas = 1;
+	    }
 	
 	    // limpiar estado previo si existiera
 	    cleanup_estado(&estado);
 	
 	    // crear cajas
-	    if (crear_cajas(&estado, area_caja, robots_maximos) != 0) {
+	    if (crear_cajas(&estado, &arena, area_caja, robots_maximos, 1.0f, NULL) != 0) {
 	        printf("Error al crear cajas. Intenta nuevamente.\n");
 	        cleanup_estado(&estado);
 	        continue;
@@ -94,8 +263,20 @@ int main(int argc, char *argv[]) {
 	    // escanear y ubicar mangos
 	    escanear(&estado);
 
-	    // calcular robots mnimos
-	    int nrobots = calcular_min_robots_para_rango(&estado, area_caja, robots_maximos);
+	    // calcular robots mnimos (peor caja)
+	    int *robots_por_caja = malloc(sizeof(int) * (size_t)estado.num_cajas);
+	    if (!robots_por_caja) {
+	        perror("malloc(robots_por_caja)");
+	        cleanup_estado(&estado);
+	        continue;
+	    }
+	    struct timespec t0, t1;
+	    clock_gettime(CLOCK_MONOTONIC, &t0);
+	    int nrobots = calcular_min_robots_para_rango(&estado, area_caja, robots_maximos, robots_por_caja);
+	    clock_gettime(CLOCK_MONOTONIC, &t1);
+	    imprimir_robots_por_caja(&estado, robots_por_caja,
+	                             (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+	    free(robots_por_caja);
 	    if (nrobots < 0) {
 	        printf("No es posible etiquetar todos los mangos con los parmetros ingresados. Intenta nuevamente.\n");
 	        cleanup_estado(&estado);
@@ -106,10 +287,18 @@ int main(int argc, char *argv[]) {
 	    parametros_validos = 1;  // todo correcto, salir del loop
 	}
 
+	// grabar y salir: el robot lo reproduce con -R sin conectarse
+	if (snapshot) {
+	    int rc = grabar_snapshot(snapshot, &estado, robots_maximos);
+	    if (rc == 0) printf("Snapshot grabado en %s (%d cajas, %d robots)\n", snapshot, estado.num_cajas, estado.num_robots);
+	    cleanup_estado(&estado);
+	    arena_liberar(&arena);
+	    return rc == 0 ? 0 : EXIT_FAILURE;
+	}
 
 	
-	// Crear socket servidor
-    int server_sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	// Crear socket servidor (no bloqueante, lo atiende el bucle epoll)
+    int server_sockfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (server_sockfd < 0) {
         perror("socket()");
         exit(EXIT_FAILURE);
@@ -132,112 +321,123 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
-    if (listen(server_sockfd, 5) < 0) {
+    if (listen(server_sockfd, SOMAXCONN) < 0) {
         perror("listen()");
         close(server_sockfd);
         exit(EXIT_FAILURE);
     }
 
-    printf("Servidor escaner iniciado en puerto %d. Esperando cliente...\n", SERVER_PORT);
+    // Ctrl+C / SIGTERM terminan el bucle de forma ordenada
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = manejar_senal_fin;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
 
-    // Accept (bloqueante)
-    struct sockaddr_in client_address;
-    socklen_t client_len = sizeof(client_address);
-    int client_sockfd = accept(server_sockfd, (struct sockaddr *)&client_address, &client_len);
-    if (client_sockfd < 0) {
-        perror("accept()");
-        close(server_sockfd);
-        exit(EXIT_FAILURE);
-    }
+    printf("Servidor escaner iniciado en puerto %d. Esperando clientes...\n", SERVER_PORT);
 
-    char client_ip[INET_ADDRSTRLEN] = "desconocido";
-    inet_ntop(AF_INET, &client_address.sin_addr, client_ip, sizeof(client_ip));
-    printf("Cliente conectado desde %s:%d\n", client_ip, ntohs(client_address.sin_port));
-	
-    // enviar estado al cliente
-    if (enviar_estado(client_sockfd, &estado, robots_maximos) != 0) {
-        fprintf(stderr, "Error enviando estado\n");
-        close(client_sockfd);
-        close(server_sockfd);
-        cleanup_estado(&estado);
-        exit(EXIT_FAILURE);
-    }
+    ServidorEscaner srv;
+    memset(&srv, 0, sizeof(srv));
+    srv.server_fd = server_sockfd;
+    srv.estado = &estado;
+    srv.flujo = flag_F;
+    srv.cajas_flujo = cajas_flujo;
+    srv.area_caja = area_caja;
+    srv.robots_maximos = robots_maximos;
+    srv.control = flag_C;
+    srv.transito = ceil(estado.longitud_banda / estado.velocidad_banda);
 
-    /* Enviar peridicamente num_robots calculado hasta que el cliente mande 'X' */
-    while (1) {
-        int to_send = estado.num_robots;
-        if (send_all(client_sockfd, &to_send, sizeof(to_send)) < 0) {
-            perror("send(num_robots)");
-            printf("Cliente desconectado o error de envo. Saliendo loop.\n");
-            break;
-        }
-        // esperar 100 ms por respuesta (como tu cliente)
-        char ch;
-        ssize_t nr = recv(client_sockfd, &ch, 1, 0);
-        if (nr <= 0) {
-            perror("recv()");
-            printf("Cliente desconectado o error de recepcin. Saliendo.\n");
-            break;
-        }
-        printf("Mensaje recibido del cliente: %c\n", ch);
-        if (ch == 'X') {
-            printf("Cliente solicito terminar.\n");
-            break;
-        }
-        usleep(100000);
-    }
+    int rc = servir_clientes(&srv);
 
     // limpieza y cierre
-    shutdown(client_sockfd, SHUT_RDWR);
-    close(client_sockfd);
     close(server_sockfd);
-
     cleanup_estado(&estado);
-    printf("Servidor finalizado correctamente.\n");
-    return 0;
+    arena_liberar(&arena);
+    bitacora_cerrar();
+    if (rc == 0) printf("Servidor finalizado correctamente.\n");
+    return rc == 0 ? 0 : EXIT_FAILURE;
 }
 
 // -----------------------------------------------------------------------------
-// crear_cajas: reserva memoria para cajas y rellena num_mangos aleatorios
+// crear_cajas: reserva memoria para cajas y rellena num_mangos aleatorios.
+// Todo sale de un solo bloque de la arena: primero el arreglo de cajas y despues,
+// caja por caja, sus mangos y el lugar de su ruta. El bloque se dimensiona con
+// el maximo de mangos que puede sortear crear_caja y se reusa en los reintentos.
 // -----------------------------------------------------------------------------
-int crear_cajas(EstadoSistema *estado, float area_caja, int robots_maximos) {
-    if (!estado) return 1;
+int crear_cajas(EstadoSistema *estado, Arena *arena, float area_caja, int robots_maximos, float densidad,
+                unsigned int *semilla) {
+    if (!estado || !arena) return 1;
 
-    // estimacin de mangos base por rea
-    int num_mangos_base = (int)(area_caja / AREA_MANGO_PROM);
-    if (num_mangos_base < 1) num_mangos_base = 1;
+    int base = mangos_base_caja(area_caja, densidad);
+    size_t max_mangos = (size_t)base + (size_t)(base * 0.2 + 1) - 1;
+    size_t n = (size_t)estado->num_cajas;
+    size_t bytes = arena_medida(sizeof(Caja) * n) +
+                   n * (arena_medida(sizeof(Mango) * max_mangos) + arena_medida(sizeof(int) * max_mangos));
+    if (arena_preparar(arena, bytes) != 0) return 1;
 
-    // reservar cajas
-    estado->cajas = (Caja *) malloc(sizeof(Caja) * (size_t)estado->num_cajas);
-    if (!estado->cajas) {
-        perror("malloc(cajas)");
-        return 1;
-    }
+    estado->cajas = arena_tomar(arena, sizeof(Caja) * n);
+    if (!estado->cajas) return 1;
 
     for (int i = 0; i < estado->num_cajas; i++) {
-        estado->cajas[i].id = i + 1;
-        estado->cajas[i].area_caja = area_caja;
-        estado->cajas[i].num_mangos = num_mangos_base + rand() % (int)(num_mangos_base * 0.2 + 1);
+        if (crear_caja(&estado->cajas[i], i + 1, area_caja, densidad, arena, semilla) != 0) {
+            estado->cajas = NULL;   // el bloque queda en la arena para el reintento
+            return 1;
+        }
+    }
 
-        estado->cajas[i].mangos = (Mango *) malloc(sizeof(Mango) * (size_t)estado->cajas[i].num_mangos);
-        if (!estado->cajas[i].mangos) {
-            perror("malloc(mangos)");
-            // liberar ya asignado
-            for (int j = 0; j < i; j++) free(estado->cajas[j].mangos);
-            free(estado->cajas);
-            estado->cajas = NULL;
+    return 0;
+}
+
+// Mangos que entran en una caja de area_caja (crear_caja sortea hasta un 20% mas).
+// densidad: fraccin del rea que cubren los mangos (1 = caja llena)
+int mangos_base_caja(float area_caja, float densidad) {
+    int num_mangos_base = (int)(area_caja * densidad / AREA_MANGO_PROM);
+    return num_mangos_base < 1 ? 1 : num_mangos_base;
+}
+
+// -----------------------------------------------------------------------------
+// crear_caja: una sola caja con num_mangos aleatorio (usada tambin por el
+// modo flujo, que no reserva todas las cajas de antemano). Con arena los
+// mangos y el lugar de la ruta salen de ella; sin arena los mangos van con
+// malloc y la ruta queda NULL (el llamador libera ambos).
+// Con semilla sortea con rand_r (planificador -Q, un hilo por tarea); sin
+// semilla, con el rand() del proceso.
+// -----------------------------------------------------------------------------
+static int azar(unsigned int *semilla) {
+    return semilla ? rand_r(semilla) : rand();
+}
+
+int crear_caja(Caja *caja, int id, float area_caja, float densidad, Arena *arena, unsigned int *semilla) {
+    // estimacin de mangos base por rea
+    int num_mangos_base = mangos_base_caja(area_caja, densidad);
+
+    caja->id = id;
+    caja->area_caja = area_caja;
+    caja->num_mangos = num_mangos_base + azar(semilla) % (int)(num_mangos_base * 0.2 + 1);
+
+    if (arena) {
+        caja->mangos = arena_tomar(arena, sizeof(Mango) * (size_t)caja->num_mangos);
+        caja->ruta = arena_tomar(arena, sizeof(int) * (size_t)caja->num_mangos);   // la llena escanear
+        if (!caja->mangos || !caja->ruta) {
+            fprintf(stderr, "crear_caja: la arena no alcanza\n");
             return 1;
         }
-        // inicializar campos
-        for (int j = 0; j < estado->cajas[i].num_mangos; j++) {
-            estado->cajas[i].mangos[j].id = j + 1;
-            estado->cajas[i].mangos[j].etiquetado = 0;
-            estado->cajas[i].mangos[j].area = 0.0f;
-            estado->cajas[i].mangos[j].x = 0.0f;
-            estado->cajas[i].mangos[j].y = 0.0f;
+    } else {
+        caja->ruta = NULL;   // la planifica escanear_caja
+        caja->mangos = (Mango *) malloc(sizeof(Mango) * (size_t)caja->num_mangos);
+        if (!caja->mangos) {
+            perror("malloc(mangos)");
+            return 1;
         }
     }
-
+    // inicializar campos
+    for (int j = 0; j < caja->num_mangos; j++) {
+        caja->mangos[j].id = j + 1;
+        caja->mangos[j].etiquetado = 0;
+        caja->mangos[j].area = 0.0f;
+        caja->mangos[j].x = 0.0f;
+        caja->mangos[j].y = 0.0f;
+    }
     return 0;
 }
 
@@ -245,78 +445,399 @@ int crear_cajas(EstadoSistema *estado, float area_caja, int robots_maximos) {
 // calcular_min_robots_para_rango
 // Modelo (conservador, compatible con tu cdigo previo):
 // - Se usa una ventana T_ventana calculada con robots_maximos: T_ventana = tiempo_maximo / robots_maximos
-// - Velocidad del brazo (convencin) v_brazo = lado / CONST_VEL
-// - Tiempo por mango T_total = T_move_diagonal + T_ETIQUETA (approx diagonal para peor caso)
-// - Capacidad por robot = T_ventana / T_total
-// - Buscar minimo M (1..robots_maximos) tal que M * cap_por_robot >= N_max
+// - Velocidad del brazo (convencin) v_brazo = lado / CONST_VEL, con el lado de cada caja
+// - Tiempo por mango T_total = T_move + T_ETIQUETA, recorriendo la ruta planificada
+// - Cuando un mango no entra en la ventana pasa al siguiente robot, que arranca en el centro
+// Se evala cada caja (en paralelo, ver paralelo_por_caja) y se devuelve la peor.
+// Si robots_por_caja no es NULL recibe el resultado de cada caja (-1 = imposible).
 // -----------------------------------------------------------------------------
-int calcular_min_robots_para_rango(EstadoSistema *estado, float area_caja, int robots_maximos) {
-	
-    if (!estado || estado->cajas[0].num_mangos <= 0) return -1;
+typedef struct {
+    const EstadoSistema *estado;
+    float tiempo_ventana;
+    int *por_caja;
+} CalculoRobots;
+
+static void tarea_robots_caja(void *ctx, int i) {
+    CalculoRobots *c = (CalculoRobots *)ctx;
+    c->por_caja[i] = robots_para_caja(&c->estado->cajas[i], c->tiempo_ventana);
+}
 
-    float lado = sqrt(estado->cajas[0].area_caja);
-    float v_brazo = lado / CONST_VEL;   // cm/s
+int calcular_min_robots_para_rango(EstadoSistema *estado, float area_caja, int robots_maximos, int *robots_por_caja) {
+    (void)area_caja;   // cada caja usa su propia rea
+    if (!estado || !estado->cajas || estado->num_cajas <= 0 || robots_maximos <= 0) return -1;
+
+    int *por_caja = robots_por_caja;
+    if (!por_caja) {
+        por_caja = malloc(sizeof(int) * (size_t)estado->num_cajas);
+        if (!por_caja) {
+            perror("malloc(por_caja)");
+            return -1;
+        }
+    }
 
     // tiempo que la caja pasa en el rango de un robot
     float tiempo_ventana_total = estado->longitud_banda / estado->velocidad_banda;
-    
-    float tiempo_ventana =  tiempo_ventana_total / robots_maximos;
+    CalculoRobots calc = { estado, tiempo_ventana_total / robots_maximos, por_caja };
+    paralelo_por_caja(estado->num_cajas, tarea_robots_caja, &calc);
 
-    // calcular tiempo REAL para etiquetar todos los mangos
-    float tiempo_total_robot = 0.0f;
-	float temporal = 0.0f;
+    int robots_necesarios = 0;
+    for (int i = 0; i < estado->num_cajas; i++) {
+        if (por_caja[i] < 0) {
+            robots_necesarios = -1;
+            break;
+        }
+        if (por_caja[i] > robots_necesarios) robots_necesarios = por_caja[i];
+    }
+
+    if (robots_necesarios == 0 || robots_necesarios > robots_maximos){
+		robots_necesarios = -1;
+	}
+
+    if (por_caja != robots_por_caja) free(por_caja);
+    return robots_necesarios;
+}
+
+// -----------------------------------------------------------------------------
+// robots_para_caja: robots que necesita una sola caja con el modelo de arriba.
+// 0 si la caja no tiene mangos, -1 si el brazo no se mueve (caja sin rea) o
+// si algn mango, aun yendo solo desde el centro, no entra en una ventana.
+// -----------------------------------------------------------------------------
+int robots_para_caja(const Caja *caja, float tiempo_ventana) {
+    if (!caja || caja->num_mangos <= 0) return 0;
+
+    float lado = sqrt(caja->area_caja);
+    float v_brazo = lado / CONST_VEL;   // cm/s
+    if (v_brazo <= 0.0f) return -1;
+
+    float temporal = 0.0f;
     // comienzo en el centro
     float cx = 0.0f, cy = 0.0f;
-	
-	int robots_necesarios = 1;
+    int robots_necesarios = 1;
 
-    for (int i = 0; i < estado->cajas[0].num_mangos; i++) {
+    for (int i = 0; i < caja->num_mangos; i++) {
+        int m = caja->ruta ? caja->ruta[i] : i;
+        float mx = caja->mangos[m].x;
+        float my = caja->mangos[m].y;
 
-        float mx = estado->cajas[0].mangos[i].x;
-        float my = estado->cajas[0].mangos[i].y;
+        // ni un robot entero alcanza para este mango: sumar robots no sirve
+        float t_centro = sqrt(mx*mx + my*my) / v_brazo + T_ETIQUETA;
+        if (t_centro > tiempo_ventana) return -1;
 
         float dx = mx - cx;
         float dy = my - cy;
+        float t_mango = sqrt(dx*dx + dy*dy) / v_brazo + T_ETIQUETA;
 
-        float dist = sqrt(dx*dx + dy*dy);
-
-        float t_mov = dist / v_brazo;
-		
-		temporal += t_mov + T_ETIQUETA;
-		if(temporal > tiempo_ventana){
-			temporal = 0.0f;
-			cx = 0.0f;
-			cy = 0.0f;
-			robots_necesarios += 1;
-			
-			mx = estado->cajas[0].mangos[i].x;
-	        my = estado->cajas[0].mangos[i].y;
-	        dx = mx - cx;
-	        dy = my - cy;
-	        dist = sqrt(dx*dx + dy*dy);
-	        t_mov = dist / v_brazo;
-	        temporal += t_mov + T_ETIQUETA;
-	        tiempo_total_robot += t_mov + T_ETIQUETA;
-		}else{
-			tiempo_total_robot += t_mov + T_ETIQUETA;
-			// ahora el brazo queda en este mango
-	        cx = mx;
-	        cy = my;
-		}
-        
-    }
-    
-    if (robots_necesarios > robots_maximos){
-		robots_necesarios = -1;
-	}
-        
+        temporal += t_mango;
+        if (temporal > tiempo_ventana) {
+            // este mango lo hace el siguiente robot, desde el centro
+            robots_necesarios += 1;
+            temporal = t_centro;
+        }
+        // ahora el brazo queda en este mango
+        cx = mx;
+        cy = my;
+    }
     return robots_necesarios;
 }
 
+// -----------------------------------------------------------------------------
+// imprimir_robots_por_caja: resumen del clculo por caja
+// -----------------------------------------------------------------------------
+void imprimir_robots_por_caja(const EstadoSistema *estado, const int *robots_por_caja, double ms) {
+    int peor = 0, imposibles = 0;
+    double suma = 0.0;
+    for (int i = 0; i < estado->num_cajas; i++) {
+        if (robots_por_caja[i] < 0) {
+            imposibles++;
+            continue;
+        }
+        suma += robots_por_caja[i];
+        if (robots_por_caja[i] > robots_por_caja[peor] || robots_por_caja[peor] < 0) peor = i;
+    }
+    if (imposibles == estado->num_cajas) {
+        printf("\nRobots por caja: las %d cajas son imposibles (%.1f ms)\n", estado->num_cajas, ms);
+        return;
+    }
+    printf("\nRobots por caja: peor caja #%d con %d robots, promedio %.2f",
+           estado->cajas[peor].id, robots_por_caja[peor],
+           estado->num_cajas > imposibles ? suma / (estado->num_cajas - imposibles) : 0.0);
+    if (imposibles > 0) printf(", %d cajas imposibles", imposibles);
+    printf(" (%d cajas en %.1f ms)\n", estado->num_cajas, ms);
+}
+
+// -----------------------------------------------------------------------------
+// paralelo_por_caja: reparte tarea(ctx, i), i en [0, n), entre un hilo por
+// ncleo (hasta MAX_HILOS_POOL). Cada hilo toma bloques de BLOQUE_POOL cajas
+// hasta que no quedan; el hilo que llama tambin trabaja. Vuelve cuando
+// todas las cajas terminaron. Las tareas no deben usar rand() ni imprimir.
+// paralelo_en_bloques es lo mismo con otro tamao de bloque; si una tarea
+// vuelve a pedir un pool, ese corre en serie en su hilo (sin hilos de ms).
+// -----------------------------------------------------------------------------
+static __thread int t_en_pool = 0;   // este hilo est corriendo tareas de un pool
+
+static void *hilo_pool(void *arg) {
+    TrabajoPool *t = (TrabajoPool *)arg;
+    int anterior = t_en_pool;
+    t_en_pool = 1;
+    while (1) {
+        pthread_mutex_lock(&t->lock);
+        int desde = t->siguiente;
+        t->siguiente += t->bloque;
+        pthread_mutex_unlock(&t->lock);
+        if (desde >= t->n) break;
+
+        int hasta = desde + t->bloque < t->n ? desde + t->bloque : t->n;
+        for (int i = desde; i < hasta; i++) t->tarea(t->ctx, i);
+    }
+    t_en_pool = anterior;
+    return NULL;
+}
+
+void paralelo_por_caja(int n, TareaCaja tarea, void *ctx) {
+    paralelo_en_bloques(n, BLOQUE_POOL, tarea, ctx);
+}
+
+void paralelo_en_bloques(int n, int bloque, TareaCaja tarea, void *ctx) {
+    if (n <= 0 || bloque <= 0) return;
+    if (t_en_pool) {
+        // pool anidado: en serie en este hilo, sin lock ni sysconf
+        for (int i = 0; i < n; i++) tarea(ctx, i);
+        return;
+    }
+    TrabajoPool t = { .tarea = tarea, .ctx = ctx, .n = n, .bloque = bloque, .siguiente = 0 };
+    pthread_mutex_init(&t.lock, NULL);
+
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    int hilos = nucleos > 0 ? (int)nucleos : 1;
+    int bloques = (n + bloque - 1) / bloque;
+    if (hilos > MAX_HILOS_POOL) hilos = MAX_HILOS_POOL;
+    if (hilos > bloques) hilos = bloques;
+
+    pthread_t th[MAX_HILOS_POOL];
+    int creados = 0;
+    for (int i = 1; i < hilos; i++) {
+        if (pthread_create(&th[creados], NULL, hilo_pool, &t) != 0) {
+            perror("pthread_create(hilo_pool)");
+            break;   // lo que falte lo hace este hilo
+        }
+        creados++;
+    }
+    hilo_pool(&t);
+    for (int i = 0; i < creados; i++) pthread_join(th[i], NULL);
+    pthread_mutex_destroy(&t.lock);
+}
+
+// -----------------------------------------------------------------------------
+// Planificador de capacidad (-Q): barre una grilla de velocidad de banda,
+// longitud, rea de caja, densidad de mangos y robots mximos, y calcula con
+// calcular_min_robots_para_rango los robots que necesita cada punto.
+// Las cajas solo dependen del rea y la densidad: una primera pasada en
+// paralelo crea y escanea las de cada (rea, densidad) una vez, con su propia
+// semilla (rand_r). La segunda reparte una tarea por (rea, densidad,
+// velocidad, longitud), que recorre los robots con esas cajas: la grilla
+// entera se reparte entre los ncleos aunque haya una sola rea y densidad.
+// Lo que calcular_min_robots_para_rango paraleliza corre en serie adentro.
+// Escribe un CSV con cada punto y otro con la frontera de factibilidad: para
+// cada longitud, rea, densidad y robots, la velocidad ms alta que todava
+// etiqueta todo (y las cajas por minuto que pasan a esa velocidad).
+// -----------------------------------------------------------------------------
+// "desde:hasta:paso" o un solo valor
+int parsear_rango(RangoPlan *r, const char *spec) {
+    char *fin;
+    r->desde = strtof(spec, &fin);
+    r->hasta = r->desde;
+    r->paso = 1.0f;
+    if (*fin == ':') {
+        r->hasta = strtof(fin + 1, &fin);
+        if (*fin != ':') return -1;
+        r->paso = strtof(fin + 1, &fin);
+    }
+    if (*fin != '\0' || r->desde <= 0.0f || r->hasta < r->desde || r->paso <= 0.0f) return -1;
+    double n = floor((double)(r->hasta - r->desde) / (double)r->paso + 1e-6) + 1.0;
+    if (n > PLAN_MAX_VALORES) return -1;
+    r->n = (int)n;
+    return 0;
+}
+
+static float valor_rango(const RangoPlan *r, int i) {
+    return r->desde + (float)i * r->paso;
+}
+
+static int robots_rango(const RangoPlan *r, int i) {
+    return (int)lroundf(valor_rango(r, i));
+}
+
+// punto (rea, densidad, velocidad, longitud, robots) -> ndice en necesarios
+static size_t indice_plan(const Plan *p, int ia, int id, int iv, int il, int ir) {
+    return ((((size_t)ia * (size_t)p->densidad.n + (size_t)id) * (size_t)p->vel.n + (size_t)iv) *
+            (size_t)p->largo.n + (size_t)il) * (size_t)p->robots.n + (size_t)ir;
+}
+
+// Primera pasada: las cajas del conjunto c = (rea, densidad)
+static void armar_cajas_plan(void *ctx, int c) {
+    Plan *p = (Plan *)ctx;
+    float area = valor_rango(&p->area, c / p->densidad.n);
+    float densidad = valor_rango(&p->densidad, c % p->densidad.n);
+    unsigned int semilla = p->semilla ^ (unsigned int)(c * 2654435761u);
+
+    EstadoSistema *estado = &p->conjuntos[c];
+    estado->num_cajas = p->cajas;
+    if (crear_cajas(estado, &p->arenas[c], area, robots_rango(&p->robots, p->robots.n - 1), densidad, &semilla) != 0) {
+        cleanup_estado(estado);
+        return;
+    }
+    for (int i = 0; i < estado->num_cajas; i++) {
+        ubicar_mangos(&estado->cajas[i], &semilla);
+        planificar_ruta(&estado->cajas[i]);
+    }
+}
+
+// Segunda pasada: todos los robots de un (rea, densidad, velocidad, longitud)
+static void tarea_plan(void *ctx, int t) {
+    Plan *p = (Plan *)ctx;
+    int il = t % p->largo.n;
+    int iv = (t / p->largo.n) % p->vel.n;
+    int c = t / (p->largo.n * p->vel.n);
+    int ia = c / p->densidad.n, id = c % p->densidad.n;
+
+    // copia de la cabecera: las cajas se comparten, solo se leen
+    EstadoSistema estado = p->conjuntos[c];
+    estado.velocidad_banda = valor_rango(&p->vel, iv);
+    estado.longitud_banda = valor_rango(&p->largo, il);
+    for (int ir = 0; ir < p->robots.n; ir++) {
+        int n = estado.cajas ? calcular_min_robots_para_rango(&estado, valor_rango(&p->area, ia),
+                                                              robots_rango(&p->robots, ir), NULL) : -2;
+        p->necesarios[indice_plan(p, ia, id, iv, il, ir)] = n;
+    }
+}
+
+// "plan.csv" -> "plan_frontera.csv"
+static char *ruta_frontera(const char *archivo) {
+    size_t n = strlen(archivo);
+    if (n > 4 && strcmp(archivo + n - 4, ".csv") == 0) n -= 4;
+    char *ruta = malloc(n + sizeof("_frontera.csv"));
+    if (!ruta) return NULL;
+    memcpy(ruta, archivo, n);
+    strcpy(ruta + n, "_frontera.csv");
+    return ruta;
+}
+
+static int escribir_plan(const Plan *p, FILE *f) {
+    fprintf(f, "velocidad_cm_s,longitud_cm,area_caja_cm2,densidad,robots_maximos,robots_necesarios,factible\n");
+    for (int iv = 0; iv < p->vel.n; iv++)
+        for (int il = 0; il < p->largo.n; il++)
+            for (int ia = 0; ia < p->area.n; ia++)
+                for (int id = 0; id < p->densidad.n; id++)
+                    for (int ir = 0; ir < p->robots.n; ir++) {
+                        int n = p->necesarios[indice_plan(p, ia, id, iv, il, ir)];
+                        fprintf(f, "%g,%g,%g,%g,%d,%d,%d\n", valor_rango(&p->vel, iv),
+                                valor_rango(&p->largo, il), valor_rango(&p->area, ia),
+                                valor_rango(&p->densidad, id), robots_rango(&p->robots, ir), n, n > 0);
+                    }
+    return ferror(f) ? -1 : 0;
+}
+
+// Velocidad ms alta factible para cada longitud, rea, densidad y robots;
+// sin ninguna factible la fila queda con velocidad 0
+static int escribir_frontera(const Plan *p, FILE *f) {
+    fprintf(f, "longitud_cm,area_caja_cm2,densidad,robots_maximos,velocidad_max_cm_s,robots_necesarios,"
+               "cajas_por_minuto\n");
+    for (int il = 0; il < p->largo.n; il++)
+        for (int ia = 0; ia < p->area.n; ia++)
+            for (int id = 0; id < p->densidad.n; id++)
+                for (int ir = 0; ir < p->robots.n; ir++) {
+                    int mejor = -1;
+                    for (int iv = 0; iv < p->vel.n; iv++)
+                        if (p->necesarios[indice_plan(p, ia, id, iv, il, ir)] > 0) mejor = iv;
+                    float area = valor_rango(&p->area, ia);
+                    float v = mejor >= 0 ? valor_rango(&p->vel, mejor) : 0.0f;
+                    // cajas pegadas: una por lado de caja recorrido
+                    fprintf(f, "%g,%g,%g,%d,%g,%d,%.2f\n", valor_rango(&p->largo, il), area,
+                            valor_rango(&p->densidad, id), robots_rango(&p->robots, ir), v,
+                            mejor >= 0 ? p->necesarios[indice_plan(p, ia, id, mejor, il, ir)] : -1,
+                            60.0 * (double)v / sqrt((double)area));
+                }
+    return ferror(f) ? -1 : 0;
+}
+
+int planificar_capacidad(Plan *p, const char *archivo) {
+    if (p->cajas <= 0) {
+        fprintf(stderr, "-n necesita al menos una caja por punto\n");
+        return -1;
+    }
+    int conjuntos = p->area.n * p->densidad.n;
+    size_t tareas = (size_t)conjuntos * (size_t)p->vel.n * (size_t)p->largo.n;
+    size_t puntos = tareas * (size_t)p->robots.n;
+    if (tareas > INT_MAX) {
+        fprintf(stderr, "Grilla demasiado grande: %zu tareas\n", tareas);
+        return -1;
+    }
+    p->necesarios = malloc(sizeof(int) * puntos);
+    p->conjuntos = calloc((size_t)conjuntos, sizeof(EstadoSistema));
+    p->arenas = calloc((size_t)conjuntos, sizeof(Arena));
+    char *frontera = ruta_frontera(archivo);
+    if (!p->necesarios || !p->conjuntos || !p->arenas || !frontera) {
+        perror("malloc(plan)");
+        free(p->necesarios);
+        free(p->conjuntos);
+        free(p->arenas);
+        free(frontera);
+        return -1;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    paralelo_en_bloques(conjuntos, 1, armar_cajas_plan, p);
+    paralelo_en_bloques((int)tareas, 1, tarea_plan, p);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    for (int c = 0; c < conjuntos; c++) {
+        cleanup_estado(&p->conjuntos[c]);
+        arena_liberar(&p->arenas[c]);
+    }
+    free(p->conjuntos);
+    free(p->arenas);
+    p->conjuntos = NULL;
+    p->arenas = NULL;
+    double ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+
+    size_t factibles = 0;
+    int errores = 0;
+    for (size_t i = 0; i < puntos; i++) {
+        factibles += p->necesarios[i] > 0;
+        errores += p->necesarios[i] == -2;
+    }
+
+    int rc = 0;
+    FILE *f = fopen(archivo, "w");
+    FILE *g = f ? fopen(frontera, "w") : NULL;
+    if (!f || !g) {
+        perror("fopen(plan)");
+        rc = -1;
+    } else if (escribir_plan(p, f) != 0 || escribir_frontera(p, g) != 0) {
+        fprintf(stderr, "Error escribiendo el plan\n");
+        rc = -1;
+    }
+    if (f && fclose(f) != 0) rc = -1;
+    if (g && fclose(g) != 0) rc = -1;
+
+    if (rc == 0) {
+        printf("Plan: %zu puntos (%d velocidades x %d longitudes x %d areas x %d densidades x %d robots), "
+               "%d cajas por punto, en %.1f ms\n", puntos, p->vel.n, p->largo.n, p->area.n, p->densidad.n,
+               p->robots.n, p->cajas, ms);
+        printf("Factibles: %zu de %zu", factibles, puntos);
+        if (errores > 0) printf(" (%d puntos sin memoria para sus cajas)", errores);
+        printf(". Grilla en %s, frontera en %s\n", archivo, frontera);
+    }
+    free(frontera);
+    free(p->necesarios);
+    p->necesarios = NULL;
+    return rc;
+}
+
 // -----------------------------------------------------------------------------
 // acomodarEnGrilla: sita los mangos de manera determinista en una grilla
 // -----------------------------------------------------------------------------
-void acomodarEnGrilla(Caja *caja) {
+void acomodarEnGrilla(Caja *caja, unsigned int *semilla) {
     if (!caja) return;
     float lado = sqrtf(caja->area_caja);
     int N = caja->num_mangos;
@@ -331,7 +852,7 @@ void acomodarEnGrilla(Caja *caja) {
         for (int col = 0; col < celdas && index < N; col++) {
             Mango *m = &caja->mangos[index];
             // rea aleatoria entre 70 y 90 (para variacin)
-            m->area = 70.0f + (float)(rand() % 21);
+            m->area = 70.0f + (float)(azar(semilla) % 21);
             float cx = (col + 0.5f) * tamCelda;
             float cy = (fila + 0.5f) * tamCelda;
             // coordenadas relativas al centro de la caja
@@ -345,123 +866,483 @@ void acomodarEnGrilla(Caja *caja) {
 // -----------------------------------------------------------------------------
 // escanear: asigna posiciones a los mangos e imprime
 // -----------------------------------------------------------------------------
+static void tarea_ruta_caja(void *ctx, int i) {
+    EstadoSistema *estado = (EstadoSistema *)ctx;
+    planificar_ruta(&estado->cajas[i]);
+}
+
 void escanear(EstadoSistema *estado) {
     if (!estado || !estado->cajas) return;
-    printf("\n=== INICIANDO ESCANEO DE CAJAS ===\n");
+    bit_info("=== INICIANDO ESCANEO DE CAJAS ===");
+    // ubicar usa rand(), as que va en orden; las rutas se planifican en paralelo
     for (int i = 0; i < estado->num_cajas; ++i) {
-        Caja *c = &estado->cajas[i];
-        // asegurar ids y estados
-        for (int j = 0; j < c->num_mangos; ++j) {
-            c->mangos[j].id = j + 1;
-            c->mangos[j].etiquetado = 0;
-        }
-        acomodarEnGrilla(c);
-        printf("\nCaja #%d (Area %.2f cm^2, %d mangos)\n", c->id, c->area_caja, c->num_mangos);
-        for (int j = 0; j < c->num_mangos; ++j) {
-            Mango *m = &c->mangos[j];
-            printf(" Mango %2d | area %.1f cm^2 | pos (%.2f, %.2f)\n", m->id, m->area, m->x, m->y);
-        }
+        ubicar_mangos(&estado->cajas[i], NULL);
     }
-    printf("\n=== ESCANEO COMPLETADO ===\n");
+    paralelo_por_caja(estado->num_cajas, tarea_ruta_caja, estado);
+    for (int i = 0; i < estado->num_cajas; ++i) {
+        imprimir_caja(&estado->cajas[i]);
+    }
+    bit_info("=== ESCANEO COMPLETADO ===");
+    bitacora_vaciar();   // lo que sigue (robots por caja, preguntas) sale directo por stdout
+
+}
+
+// -----------------------------------------------------------------------------
+// escanear_caja: ubica los mangos de una caja, planifica la ruta del brazo e imprime
+// -----------------------------------------------------------------------------
+void escanear_caja(Caja *c) {
+    if (!c) return;
+    ubicar_mangos(c, NULL);
+    planificar_ruta(c);
+    imprimir_caja(c);
+}
 
+// -----------------------------------------------------------------------------
+// ubicar_mangos: ids, estados y posiciones en grilla de una caja
+// -----------------------------------------------------------------------------
+void ubicar_mangos(Caja *c, unsigned int *semilla) {
+    if (!c) return;
+    // asegurar ids y estados
+    for (int j = 0; j < c->num_mangos; ++j) {
+        c->mangos[j].id = j + 1;
+        c->mangos[j].etiquetado = 0;
+    }
+    acomodarEnGrilla(c, semilla);
+}
+
+// -----------------------------------------------------------------------------
+// imprimir_caja: mangos de una caja y largo de su ruta
+// -----------------------------------------------------------------------------
+void imprimir_caja(const Caja *c) {
+    if (!c) return;
+    bit_info("Caja #%d (Area %.2f cm^2, %d mangos)", c->id, c->area_caja, c->num_mangos);
+    for (int j = 0; j < c->num_mangos; ++j) {
+        const Mango *m = &c->mangos[j];
+        bit_info(" Mango %2d | area %.1f cm^2 | pos (%.2f, %.2f)", m->id, m->area, m->x, m->y);
+    }
+    if (c->ruta) {
+        bit_info(" Ruta del brazo: %.1f cm (en orden de arreglo: %.1f cm)",
+               largo_ruta(c, c->ruta), largo_ruta(c, NULL));
+    }
 }
 
 // -----------------------------------------------------------------------------
-// cleanup_estado
+// cleanup_estado: cajas, mangos y rutas viven en la arena del main; aca solo
+// se sueltan las referencias (el bloque se reusa o se libera con arena_liberar)
 // -----------------------------------------------------------------------------
 void cleanup_estado(EstadoSistema *estado) {
     if (!estado) return;
-    if (estado->cajas) {
-        for (int i = 0; i < estado->num_cajas; ++i) {
-            if (estado->cajas[i].mangos) {
-                free(estado->cajas[i].mangos);
-                estado->cajas[i].mangos = NULL;
-            }
-        }
-        free(estado->cajas);
-        estado->cajas = NULL;
-    }
+    estado->cajas = NULL;
 }
 
 // -----------------------------------------------------------------------------
-// enviar_estado: serializa y enva EstadoSistema por socket
-// Formato (coincide con el cliente):
-// 1) velocidad_banda (float)
-// 2) longitud_banda (float)
-// 3) num_robots (int32_t)
-// 4) num_cajas (int32_t)
-// 5) robots_maximos (int)  <-- enviado como entero simple
-// Para cada caja:
-//   id (int32_t), area (float), num_mangos (int32_t)
-//   para cada mango: id (int32_t), x (float), y (float), area (float), etiquetado (int32_t)
+// Servidor epoll: muchos robots a la vez, sockets no bloqueantes y un buffer de
+// salida por cliente. Un cliente lento solo acumula en su propio buffer y deja
+// de recibir latidos; nunca bloquea al resto.
 // -----------------------------------------------------------------------------
-int enviar_estado(int sock, EstadoSistema *estado, int robots_maximos) {
-	printf("Esperando velocidad_banda...\n");
-    if (!estado) return -1;
-    float f;
-    int32_t i32;
+static volatile sig_atomic_t g_terminar = 0;
 
-    f = (float) estado->velocidad_banda;
-    if (send_all(sock, &f, sizeof(f)) < 0) return -1;
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
 
-    f = (float) estado->longitud_banda;
-    if (send_all(sock, &f, sizeof(f)) < 0) return -1;
+void manejar_senal_fin(int sig) {
+    (void)sig;
+    g_terminar = 1;
+}
 
-    i32 = (int32_t) estado->num_robots;
-    if (send_all(sock, &i32, sizeof(i32)) < 0) return -1;
+// Marcas para distinguir en epoll el socket de escucha y el timer
+static int marca_servidor;
+static int marca_timer;
+
+static int buffer_agregar(BufferSalida *b, const void *datos, size_t n) {
+    if (b->off == b->len) b->off = b->len = 0;
+    if (b->len + n > b->cap) {
+        size_t ncap = b->cap ? b->cap : 256;
+        while (ncap < b->len + n) ncap *= 2;
+        uint8_t *nd = realloc(b->datos, ncap);
+        if (!nd) return -1;
+        b->datos = nd;
+        b->cap = ncap;
+    }
+    memcpy(b->datos + b->len, datos, n);
+    b->len += n;
+    return 0;
+}
 
-    i32 = (int32_t) estado->num_cajas;
-    if (send_all(sock, &i32, sizeof(i32)) < 0) return -1;
+static int buffer_vacio(const BufferSalida *b) {
+    return b->externo_off == b->externo_len && b->off == b->len;
+}
 
-    /* enviar robots_maximos (int) */
-    if (send_all(sock, &robots_maximos, sizeof(int)) < 0) return -1;
+static void actualizar_epollout(ServidorEscaner *srv, ClienteRobot *cli, int quiere) {
+    if (cli->quiere_epollout == quiere) return;
+    struct epoll_event ev;
+    ev.events = EPOLLIN | (quiere ? EPOLLOUT : 0);
+    ev.data.ptr = cli;
+    epoll_ctl(srv->epfd, EPOLL_CTL_MOD, cli->fd, &ev);
+    cli->quiere_epollout = quiere;
+}
 
-    for (int c = 0; c < estado->num_cajas; ++c) {
-        Caja *caja = &estado->cajas[c];
+// Modo flujo: escanea la prxima caja de este cliente y la deja en su buffer.
+// Solo se llama con el buffer vaco, as el ritmo lo marca el propio cliente.
+static int encolar_siguiente_caja(ServidorEscaner *srv, ClienteRobot *cli) {
+    if (srv->cajas_flujo > 0 && cli->siguiente_caja > srv->cajas_flujo) {
+        uint8_t fin[PROTO_CABECERA];
+        size_t n = serializar_cabecera(fin, TRAMA_FIN, 0);
+        cli->fase = FASE_LATIDO;
+        return buffer_agregar(&cli->salida, fin, n);
+    }
 
-        i32 = (int32_t) caja->id;
-        if (send_all(sock, &i32, sizeof(i32)) < 0) return -1;
+    Caja caja;
+    if (crear_caja(&caja, cli->siguiente_caja, srv->area_caja, 1.0f, NULL, NULL) != 0) return -1;
+    escanear_caja(&caja);
+    cli->siguiente_caja++;
+
+    size_t len = 0;
+    uint8_t *trama = serializar_caja(&caja, &len);
+    free(caja.mangos);
+    free(caja.ruta);
+    if (!trama) return -1;
+    int rc = buffer_agregar(&cli->salida, trama, len);
+    free(trama);
+    return rc;
+}
 
-        f = (float) caja->area_caja;
-        if (send_all(sock, &f, sizeof(f)) < 0) return -1;
+// -----------------------------------------------------------------------------
+// vaciar_cliente: enva lo que acepte el socket sin bloquear. Devuelve -1 si
+// el cliente debe cerrarse.
+// -----------------------------------------------------------------------------
+int vaciar_cliente(ServidorEscaner *srv, ClienteRobot *cli) {
+    BufferSalida *b = &cli->salida;
+    int cajas = 0;
+    while (1) {
+        const uint8_t *p;
+        size_t pendiente;
+        size_t *off;
+        if (b->externo_off < b->externo_len) {
+            p = b->externo + b->externo_off;
+            pendiente = b->externo_len - b->externo_off;
+            off = &b->externo_off;
+        } else if (b->off < b->len) {
+            p = b->datos + b->off;
+            pendiente = b->len - b->off;
+            off = &b->off;
+        } else {
+            // todo enviado: avanzar de fase
+            if (cli->fase == FASE_ESTADO) {
+                cli->fase = FASE_LATIDO;
+            } else if (cli->fase == FASE_FLUJO) {
+                // pocas cajas por vuelta para no postergar a los dems clientes
+                if (cajas++ == CAJAS_POR_VUELTA) {
+                    actualizar_epollout(srv, cli, 1);
+                    return 0;
+                }
+                if (encolar_siguiente_caja(srv, cli) != 0) return -1;
+                continue;
+            }
+            if (cli->terminar) return -1;
+            actualizar_epollout(srv, cli, 0);
+            return 0;
+        }
+
+        ssize_t n = send(cli->fd, p, pendiente, MSG_NOSIGNAL);
+        if (n > 0) {
+            *off += (size_t)n;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            actualizar_epollout(srv, cli, 1);
+            return 0;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        bit_aviso("Cliente %s:%d desconectado o error de envo.", cli->ip, cli->puerto);
+        return -1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// aceptar_clientes: acepta todas las conexiones pendientes
+// -----------------------------------------------------------------------------
+void aceptar_clientes(ServidorEscaner *srv) {
+    while (1) {
+        struct sockaddr_in client_address;
+        socklen_t client_len = sizeof(client_address);
+        int fd = accept4(srv->server_fd, (struct sockaddr *)&client_address, &client_len, SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) perror("accept4()");
+            return;
+        }
 
-        i32 = (int32_t) caja->num_mangos;
-        if (send_all(sock, &i32, sizeof(i32)) < 0) return -1;
+        ClienteRobot *cli = calloc(1, sizeof(ClienteRobot));
+        if (!cli) {
+            close(fd);
+            continue;
+        }
+        if (srv->num_clientes == srv->cap_clientes) {
+            int ncap = srv->cap_clientes ? srv->cap_clientes * 2 : 16;
+            ClienteRobot **nc = realloc(srv->clientes, sizeof(ClienteRobot *) * (size_t)ncap);
+            if (!nc) {
+                close(fd);
+                free(cli);
+                continue;
+            }
+            srv->clientes = nc;
+            srv->cap_clientes = ncap;
+        }
+
+        cli->fd = fd;
+        strcpy(cli->ip, "desconocido");
+        inet_ntop(AF_INET, &client_address.sin_addr, cli->ip, sizeof(cli->ip));
+        cli->puerto = ntohs(client_address.sin_port);
+        cli->siguiente_caja = 1;
+        // el control arranca con lo que calcul el escaner (peor caja)
+        iniciar_control_robots(&cli->control, srv->estado->num_robots, srv->robots_maximos,
+                               srv->transito, ahora_s());
+
+        // estado inicial: trama completa compartida, o config + cajas en flujo
+        if (srv->flujo) {
+            EstadoSistema config = *srv->estado;
+            config.num_cajas = srv->cajas_flujo;
+            size_t len = 0;
+            uint8_t *trama = serializar_config(&config, srv->robots_maximos, &len);
+            if (!trama || buffer_agregar(&cli->salida, trama, len) != 0) {
+                free(trama);
+                close(fd);
+                free(cli);
+                continue;
+            }
+            free(trama);
+            cli->fase = FASE_FLUJO;
+        } else {
+            cli->salida.externo = srv->trama_estado;
+            cli->salida.externo_len = srv->trama_estado_len;
+            cli->fase = FASE_ESTADO;
+        }
 
-        for (int m = 0; m < caja->num_mangos; ++m) {
-            Mango *mg = &caja->mangos[m];
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = cli;
+        if (epoll_ctl(srv->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("epoll_ctl(cliente)");
+            free(cli->salida.datos);
+            close(fd);
+            free(cli);
+            continue;
+        }
+        cli->indice = srv->num_clientes;
+        srv->clientes[srv->num_clientes++] = cli;
+        bit_info("Cliente conectado desde %s:%d (%d conectados)", cli->ip, cli->puerto, srv->num_clientes);
 
-            i32 = (int32_t) mg->id;
-            if (send_all(sock, &i32, sizeof(i32)) < 0) return -1;
+        if (vaciar_cliente(srv, cli) != 0) cerrar_cliente(srv, cli);
+    }
+}
 
-            f = mg->x;
-            if (send_all(sock, &f, sizeof(f)) < 0) return -1;
+// Cierra el socket y saca al cliente de la lista. La memoria se libera al final
+// de la vuelta de epoll, porque puede quedar otro evento suyo en el mismo lote.
+void cerrar_cliente(ServidorEscaner *srv, ClienteRobot *cli) {
+    if (cli->fd < 0) return;
+    epoll_ctl(srv->epfd, EPOLL_CTL_DEL, cli->fd, NULL);
+    shutdown(cli->fd, SHUT_RDWR);
+    close(cli->fd);
+    cli->fd = -1;
+
+    ClienteRobot *ultimo = srv->clientes[--srv->num_clientes];
+    srv->clientes[cli->indice] = ultimo;
+    ultimo->indice = cli->indice;
+
+    bit_info("Cliente %s:%d cerrado (latidos %ld, omitidos %ld, %ld cambios de robots, %d conectados)",
+           cli->ip, cli->puerto, cli->latidos, cli->latidos_omitidos, cli->control.cambios, srv->num_clientes);
+    cli->sig_cerrado = srv->cerrados;
+    srv->cerrados = cli;
+}
 
-            f = mg->y;
-            if (send_all(sock, &f, sizeof(f)) < 0) return -1;
+static void liberar_cerrados(ServidorEscaner *srv) {
+    while (srv->cerrados) {
+        ClienteRobot *cli = srv->cerrados;
+        srv->cerrados = cli->sig_cerrado;
+        free(cli->salida.datos);
+        free(cli);
+    }
+}
 
-            f = mg->area;
-            if (send_all(sock, &f, sizeof(f)) < 0) return -1;
+// -----------------------------------------------------------------------------
+// atender_trama_cliente: una trama completa del cliente. TRAMA_METRICAS es la
+// respuesta al latido (y con -C mueve el control de robots); TRAMA_FIN = el
+// robot termin.
+// -----------------------------------------------------------------------------
+static void atender_trama_cliente(ServidorEscaner *srv, ClienteRobot *cli, uint16_t tipo,
+                                  const uint8_t *carga, uint32_t len) {
+    if (tipo == TRAMA_FIN) {
+        cli->esperando_respuesta = 0;
+        cli->terminar = 1;
+        bit_info("Cliente %s:%d solicito terminar.", cli->ip, cli->puerto);
+        return;
+    }
+    MetricasCelda m;
+    if (tipo != TRAMA_METRICAS || deserializar_metricas(carga, len, &m) != 0) {
+        bit_aviso("Cliente %s:%d: trama inesperada (tipo %u, %u bytes)", cli->ip, cli->puerto, tipo, len);
+        return;
+    }
+    cli->esperando_respuesta = 0;
+    bit_debug("Cliente %s:%d: %d robots, %d cajas salidas, %d/%d mangos sin etiquetar, utilizacion %.2f",
+              cli->ip, cli->puerto, m.robots_activos, m.cajas_salidas, m.mangos_perdidos,
+              m.mangos_salidos, (double)m.utilizacion);
+    if (!srv->control) return;
+
+    int antes = cli->control.objetivo;
+    int nuevo = control_robots_paso(&cli->control, &m, ahora_s());
+    if (nuevo != antes) {
+        bit_info("Cliente %s:%d: %d -> %d robots (%d de %d mangos sin etiquetar, utilizacion media %.2f)",
+                 cli->ip, cli->puerto, antes, nuevo, m.mangos_perdidos, m.mangos_salidos,
+                 cli->control.utilizacion);
+    }
+}
 
-            i32 = (int32_t) mg->etiquetado;
-            if (send_all(sock, &i32, sizeof(i32)) < 0) return -1;
+// -----------------------------------------------------------------------------
+// leer_cliente: tramas del cliente (respuestas al latido y TRAMA_FIN). Se
+// juntan en cli->entrada hasta tener una completa.
+// -----------------------------------------------------------------------------
+void leer_cliente(ServidorEscaner *srv, ClienteRobot *cli) {
+    while (1) {
+        ssize_t nr = recv(cli->fd, cli->entrada + cli->entrada_len,
+                          sizeof(cli->entrada) - cli->entrada_len, 0);
+        if (nr > 0) {
+            cli->entrada_len += (size_t)nr;
+            size_t usado = 0;
+            while (cli->entrada_len - usado >= PROTO_CABECERA) {
+                uint16_t tipo;
+                uint32_t len;
+                if (leer_cabecera(cli->entrada + usado, &tipo, &len) != 0 || len > MAX_CARGA_CLIENTE) {
+                    bit_aviso("Cliente %s:%d mando una trama invalida.", cli->ip, cli->puerto);
+                    cerrar_cliente(srv, cli);
+                    return;
+                }
+                if (cli->entrada_len - usado < PROTO_CABECERA + len) break;
+                atender_trama_cliente(srv, cli, tipo, cli->entrada + usado + PROTO_CABECERA, len);
+                usado += PROTO_CABECERA + len;
+            }
+            memmove(cli->entrada, cli->entrada + usado, cli->entrada_len - usado);
+            cli->entrada_len -= usado;
+            continue;
         }
+        if (nr < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (nr < 0 && errno == EINTR) continue;
+        if (!cli->terminar)
+            bit_aviso("Cliente %s:%d desconectado o error de recepcin.", cli->ip, cli->puerto);
+        cerrar_cliente(srv, cli);
+        return;
     }
+    if (cli->terminar && buffer_vacio(&cli->salida)) cerrar_cliente(srv, cli);
+}
 
-    return 0;
+// -----------------------------------------------------------------------------
+// latido_clientes: cada LATIDO_MS enva TRAMA_LATIDO con los robots que cada
+// cliente tiene que tener activos (num_robots, o lo que decide su control con
+// -C) a los que ya tienen su estado y respondieron el latido anterior; un
+// cliente lento no frena a los dems.
+// -----------------------------------------------------------------------------
+void latido_clientes(ServidorEscaner *srv) {
+    for (int i = srv->num_clientes - 1; i >= 0; i--) {
+        ClienteRobot *cli = srv->clientes[i];
+        if (cli->fase != FASE_LATIDO || cli->terminar) continue;
+        if (cli->esperando_respuesta || !buffer_vacio(&cli->salida)) {
+            cli->latidos_omitidos++;
+            continue;
+        }
+        uint8_t latido[PROTO_LATIDO_LEN];
+        size_t n = serializar_latido(latido, cli->control.objetivo);
+        if (buffer_agregar(&cli->salida, latido, n) != 0 ||
+            vaciar_cliente(srv, cli) != 0) {
+            cerrar_cliente(srv, cli);
+            continue;
+        }
+        cli->esperando_respuesta = 1;
+        cli->latidos++;
+    }
 }
 
 // -----------------------------------------------------------------------------
-// send_all: enva todo el buffer
+// servir_clientes: bucle principal epoll hasta SIGINT/SIGTERM
 // -----------------------------------------------------------------------------
-int send_all(int sock, const void *buffer, size_t length) {
-    const char *ptr = (const char *)buffer;
-    size_t total_sent = 0;
-    while (total_sent < length) {
-        ssize_t sent = send(sock, ptr + total_sent, length - total_sent, 0);
-        if (sent <= 0) return -1;
-        total_sent += (size_t)sent;
+int servir_clientes(ServidorEscaner *srv) {
+    if (!srv->flujo) {
+        // el estado completo se serializa una vez y lo comparten todos los clientes
+        srv->trama_estado = serializar_estado(srv->estado, srv->robots_maximos, &srv->trama_estado_len);
+        if (!srv->trama_estado) {
+            fprintf(stderr, "Error serializando estado\n");
+            return -1;
+        }
+    }
+
+    srv->epfd = epoll_create1(0);
+    if (srv->epfd < 0) {
+        perror("epoll_create1()");
+        free(srv->trama_estado);
+        return -1;
+    }
+
+    srv->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_interval.tv_nsec = LATIDO_MS * 1000000L;
+    its.it_value.tv_nsec = LATIDO_MS * 1000000L;
+    if (srv->timer_fd < 0 || timerfd_settime(srv->timer_fd, 0, &its, NULL) < 0) {
+        perror("timerfd");
+        close(srv->epfd);
+        free(srv->trama_estado);
+        return -1;
     }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &marca_servidor;
+    epoll_ctl(srv->epfd, EPOLL_CTL_ADD, srv->server_fd, &ev);
+    ev.data.ptr = &marca_timer;
+    epoll_ctl(srv->epfd, EPOLL_CTL_ADD, srv->timer_fd, &ev);
+
+    struct epoll_event eventos[MAX_EVENTOS];
+    while (!g_terminar) {
+        int n = epoll_wait(srv->epfd, eventos, MAX_EVENTOS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait()");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            void *ptr = eventos[i].data.ptr;
+            if (ptr == &marca_servidor) {
+                aceptar_clientes(srv);
+            } else if (ptr == &marca_timer) {
+                uint64_t expiraciones;
+                while (read(srv->timer_fd, &expiraciones, sizeof(expiraciones)) > 0) {}
+                latido_clientes(srv);
+            } else {
+                ClienteRobot *cli = (ClienteRobot *)ptr;
+                if (cli->fd < 0) continue;   // cerrado en este mismo lote
+                if (eventos[i].events & (EPOLLERR | EPOLLHUP)) {
+                    cerrar_cliente(srv, cli);
+                    continue;
+                }
+                if (eventos[i].events & EPOLLOUT) {
+                    if (vaciar_cliente(srv, cli) != 0) {
+                        cerrar_cliente(srv, cli);
+                        continue;
+                    }
+                }
+                if (eventos[i].events & EPOLLIN) leer_cliente(srv, cli);
+            }
+        }
+        liberar_cerrados(srv);
+    }
+
+    while (srv->num_clientes > 0) cerrar_cliente(srv, srv->clientes[0]);
+    liberar_cerrados(srv);
+    free(srv->clientes);
+    close(srv->timer_fd);
+    close(srv->epfd);
+    free(srv->trama_estado);
     return 0;
 }
 
@@ -0,0 +1,24 @@
+// estadistica.c - percentiles sobre muestras ordenadas
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "estadistica.h"
+
+static int comparar_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+void ordenar_muestras(double *v, int n) {
+    if (n > 1) qsort(v, (size_t)n, sizeof(double), comparar_double);
+}
+
+/* Percentil por rango mas cercano sobre un arreglo ordenado */
+double percentil(const double *v, int n, double p) {
+    if (n <= 0) return 0.0;
+    int k = (int)ceil(p / 100.0 * n) - 1;
+    if (k < 0) k = 0;
+    if (k >= n) k = n - 1;
+    return v[k];
+}
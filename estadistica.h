@@ -0,0 +1,13 @@
+#ifndef ESTADISTICA_H
+#define ESTADISTICA_H
+
+// ---------- PERCENTILES DE MUESTRAS ----------
+// Para resumir muestras guardadas enteras (latencias de bench_celda, mangos
+// perdidos y huecos de montecarlo): se ordenan con ordenar_muestras y se
+// leen con percentil por rango mas cercano. Los histogramas log2 de
+// metricas.c y supervisor.c dan solo cotas y no pasan por aca.
+
+void ordenar_muestras(double *v, int n);
+double percentil(const double *v, int n, double p);   // v ordenado, p en [0, 100]
+
+#endif
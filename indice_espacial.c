@@ -0,0 +1,216 @@
+// indice_espacial.c - grilla uniforme para buscar el mango sin etiquetar mas cercano
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "datos.h"
+#include "indice_espacial.h"
+#include "logica_robot.h"
+
+#define MANGOS_POR_CELDA 2   /* ocupacion objetivo de cada celda */
+
+static int celda_de(const IndiceEspacial *ind, double x, double y, int *cx, int *cy) {
+    int ix = (int)floor((x - ind->min_x) / ind->tam_celda);
+    int iy = (int)floor((y - ind->min_y) / ind->tam_celda);
+    if (ix < 0) ix = 0;
+    if (iy < 0) iy = 0;
+    if (ix >= ind->celdas_x) ix = ind->celdas_x - 1;
+    if (iy >= ind->celdas_y) iy = ind->celdas_y - 1;
+    *cx = ix;
+    *cy = iy;
+    return iy * ind->celdas_x + ix;
+}
+
+/* sig_ruta[p] == p si el mango en la posicion p de la ruta sigue sin
+   etiquetar; si no, apunta mas adelante. sig_ruta[n] es el centinela. */
+static int construir_ruta(IndiceEspacial *ind, const Caja *caja) {
+    if (!caja->ruta) return 0;
+    int n = caja->num_mangos;
+    ind->pos_ruta = malloc(sizeof(int) * (size_t)(n ? n : 1));
+    ind->sig_ruta = malloc(sizeof(int) * (size_t)(n + 1));
+    if (!ind->pos_ruta || !ind->sig_ruta) {
+        liberar_indice(ind);
+        return -1;
+    }
+    for (int p = 0; p < n; p++) {
+        ind->pos_ruta[caja->ruta[p]] = p;
+        ind->sig_ruta[p] = mango_etiquetado(&caja->mangos[caja->ruta[p]]) ? p + 1 : p;
+    }
+    ind->sig_ruta[n] = n;
+    return 0;
+}
+
+/* Primera posicion >= p sin etiquetar (n si no hay), acortando los saltos.
+   Todo salto guardado sigue siendo valido (nunca se des-etiqueta un mango),
+   asi que dos robots acortando a la vez solo pueden perder un atajo. */
+static int buscar_en_ruta(IndiceEspacial *ind, int p) {
+    int q;
+    while ((q = __atomic_load_n(&ind->sig_ruta[p], __ATOMIC_RELAXED)) != p) {
+        int r = __atomic_load_n(&ind->sig_ruta[q], __ATOMIC_RELAXED);
+        __atomic_store_n(&ind->sig_ruta[p], r, __ATOMIC_RELAXED);
+        p = r;
+    }
+    return p;
+}
+
+/* ------------------ construir_indice ------------------ */
+/* Arma la grilla sobre el rectangulo que contiene a los mangos y al centro de
+   la caja (posicion inicial del brazo). Los mangos ya etiquetados no entran. */
+int construir_indice(IndiceEspacial *ind, const Caja *caja) {
+    memset(ind, 0, sizeof(*ind));
+    int n = caja->num_mangos;
+
+    float min_x = 0.0f, min_y = 0.0f, max_x = 0.0f, max_y = 0.0f;
+    for (int i = 0; i < n; i++) {
+        const Mango *m = &caja->mangos[i];
+        if (m->x < min_x) min_x = m->x;
+        if (m->y < min_y) min_y = m->y;
+        if (m->x > max_x) max_x = m->x;
+        if (m->y > max_y) max_y = m->y;
+    }
+    float ancho = max_x - min_x;
+    float alto = max_y - min_y;
+    float lado = ancho > alto ? ancho : alto;
+
+    int celdas = (int)ceil(sqrt((double)n / MANGOS_POR_CELDA));
+    if (celdas < 1) celdas = 1;
+    ind->tam_celda = lado > 0.0f ? lado / (float)celdas : 1.0f;
+    /* un poco de margen para que el borde maximo caiga dentro de la ultima celda */
+    ind->tam_celda *= 1.0001f;
+    ind->min_x = min_x;
+    ind->min_y = min_y;
+    ind->celdas_x = (int)(ancho / ind->tam_celda) + 1;
+    ind->celdas_y = (int)(alto / ind->tam_celda) + 1;
+
+    int total_celdas = ind->celdas_x * ind->celdas_y;
+    ind->inicio = calloc((size_t)total_celdas + 1, sizeof(int));
+    ind->vivos = calloc((size_t)total_celdas, sizeof(int));
+    ind->mangos = malloc(sizeof(int) * (size_t)(n ? n : 1));
+    if (!ind->inicio || !ind->vivos || !ind->mangos) {
+        liberar_indice(ind);
+        return -1;
+    }
+
+    /* contar por celda (solo sin etiquetar), luego ubicar en orden de indice */
+    int cx, cy;
+    for (int i = 0; i < n; i++) {
+        if (mango_etiquetado(&caja->mangos[i])) continue;
+        ind->vivos[celda_de(ind, caja->mangos[i].x, caja->mangos[i].y, &cx, &cy)]++;
+    }
+    for (int c = 0; c < total_celdas; c++) ind->inicio[c + 1] = ind->inicio[c] + ind->vivos[c];
+    memset(ind->vivos, 0, sizeof(int) * (size_t)total_celdas);
+    for (int i = 0; i < n; i++) {
+        if (mango_etiquetado(&caja->mangos[i])) continue;
+        int c = celda_de(ind, caja->mangos[i].x, caja->mangos[i].y, &cx, &cy);
+        ind->mangos[ind->inicio[c] + ind->vivos[c]++] = i;
+        ind->restantes++;
+    }
+    return construir_ruta(ind, caja);
+}
+
+/* ------------------ indice_mas_cercano ------------------ */
+/* Mismo resultado que recorrer todos los mangos (empates -> menor indice),
+   visitando solo los anillos de celdas que pueden contener uno mas cercano. */
+int indice_mas_cercano(const IndiceEspacial *ind, const Caja *caja, double x, double y, double *dist) {
+    int best_idx = -1;
+    double best_dist = 1e9;
+    if (indice_restantes(ind) <= 0) {
+        if (dist) *dist = best_dist;
+        return -1;
+    }
+
+    int qx, qy;
+    celda_de(ind, x, y, &qx, &qy);
+    int max_r = ind->celdas_x > ind->celdas_y ? ind->celdas_x : ind->celdas_y;
+
+    for (int r = 0; r <= max_r; r++) {
+        int x0 = qx - r, x1 = qx + r, y0 = qy - r, y1 = qy + r;
+        for (int cy = y0; cy <= y1; cy++) {
+            if (cy < 0 || cy >= ind->celdas_y) continue;
+            /* solo el borde del anillo: filas extremas completas, el resto solo x0/x1 */
+            int paso = (cy == y0 || cy == y1) ? 1 : (x1 - x0);
+            if (paso == 0) paso = 1;
+            for (int cx = x0; cx <= x1; cx += paso) {
+                if (cx < 0 || cx >= ind->celdas_x) continue;
+                int c = cy * ind->celdas_x + cx;
+                if (__atomic_load_n(&ind->vivos[c], __ATOMIC_RELAXED) == 0) continue;
+                for (int k = ind->inicio[c]; k < ind->inicio[c + 1]; k++) {
+                    int mi = ind->mangos[k];
+                    const Mango *m = &caja->mangos[mi];
+                    if (!mango_libre(m)) continue;   /* etiquetado o reservado */
+                    double d = distancia_2d(x, y, (double)m->x, (double)m->y);
+                    if (d < best_dist || (d == best_dist && mi < best_idx)) {
+                        best_dist = d;
+                        best_idx = mi;
+                    }
+                }
+            }
+        }
+
+        /* distancia minima a cualquier celda fuera del bloque ya visitado */
+        if (x0 <= 0 && y0 <= 0 && x1 >= ind->celdas_x - 1 && y1 >= ind->celdas_y - 1) break;
+        double bx0 = ind->min_x + (double)x0 * ind->tam_celda;
+        double by0 = ind->min_y + (double)y0 * ind->tam_celda;
+        double bx1 = ind->min_x + (double)(x1 + 1) * ind->tam_celda;
+        double by1 = ind->min_y + (double)(y1 + 1) * ind->tam_celda;
+        double cota = x - bx0;
+        if (bx1 - x < cota) cota = bx1 - x;
+        if (y - by0 < cota) cota = y - by0;
+        if (by1 - y < cota) cota = by1 - y;
+        if (best_idx >= 0 && best_dist < cota) break;
+    }
+
+    if (dist) *dist = best_dist;
+    return best_idx;
+}
+
+/* ------------------ indice_quitar ------------------ */
+/* Descuenta un mango recien etiquetado. Lo llama una sola vez quien lo
+   etiqueto (el que gano etiquetar_mango); la busqueda ya lo saltea. */
+void indice_quitar(IndiceEspacial *ind, const Caja *caja, int idx) {
+    if (idx < 0 || idx >= caja->num_mangos || !ind->vivos) return;
+    int cx, cy;
+    int c = celda_de(ind, caja->mangos[idx].x, caja->mangos[idx].y, &cx, &cy);
+    __atomic_fetch_sub(&ind->vivos[c], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&ind->restantes, 1, __ATOMIC_RELAXED);
+    if (ind->sig_ruta) {
+        int p = ind->pos_ruta[idx];
+        __atomic_store_n(&ind->sig_ruta[p], p + 1, __ATOMIC_RELAXED);
+    }
+}
+
+int indice_restantes(const IndiceEspacial *ind) {
+    return __atomic_load_n(&ind->restantes, __ATOMIC_RELAXED);
+}
+
+/* ------------------ indice_siguiente_ruta ------------------ */
+/* Siguiente mango libre de la ruta despues del mango desde; al llegar al
+   final vuelve al principio. -1 si no hay ruta o no quedan mangos libres.
+   Los saltos solo acortan etiquetados; los reservados se pasan de a uno. */
+int indice_siguiente_ruta(IndiceEspacial *ind, const Caja *caja, int desde) {
+    if (!ind->sig_ruta || indice_restantes(ind) <= 0) return -1;
+    int n = caja->num_mangos;
+    int vuelta = 0;
+    int p = buscar_en_ruta(ind, desde >= 0 ? ind->pos_ruta[desde] + 1 : 0);
+    while (1) {
+        if (p == n) {
+            if (vuelta) return -1;
+            vuelta = 1;
+            p = buscar_en_ruta(ind, 0);
+            continue;
+        }
+        if (mango_libre(&caja->mangos[caja->ruta[p]])) return caja->ruta[p];
+        p = buscar_en_ruta(ind, p + 1);
+    }
+}
+
+void liberar_indice(IndiceEspacial *ind) {
+    if (!ind) return;
+    free(ind->inicio);
+    free(ind->vivos);
+    free(ind->mangos);
+    free(ind->pos_ruta);
+    free(ind->sig_ruta);
+    memset(ind, 0, sizeof(*ind));
+}
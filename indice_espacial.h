@@ -0,0 +1,37 @@
+#ifndef INDICE_ESPACIAL_H
+#define INDICE_ESPACIAL_H
+
+#include "datos.h"
+
+// ---------- INDICE ESPACIAL POR CAJA (GRILLA UNIFORME) ----------
+// Los mangos de una caja se reparten en celdas cuadradas y la busqueda del
+// mas cercano recorre anillos de celdas alrededor del brazo hasta que ninguna
+// celda sin visitar puede mejorar el resultado. Las celdas no se reordenan al
+// etiquetar: se saltan los mangos no libres y las celdas sin vivos. Asi
+// varios robots pueden buscar y quitar mangos de la misma caja sin lock
+// (contadores y saltos de ruta se leen y escriben con atomicos).
+// Si la caja trae ruta planificada, el indice tambien responde cual es el
+// siguiente mango sin etiquetar de la ruta despues de uno dado.
+
+typedef struct {
+    float min_x;         // esquina inferior izquierda de la grilla (cm)
+    float min_y;
+    float tam_celda;     // lado de cada celda (cm)
+    int celdas_x;
+    int celdas_y;
+    int *inicio;         // celdas_x*celdas_y+1 desplazamientos dentro de mangos[]
+    int *vivos;          // mangos sin etiquetar en cada celda
+    int *mangos;         // indices de mango agrupados por celda
+    int restantes;       // mangos sin etiquetar en toda la caja
+    int *pos_ruta;       // posicion de cada mango en caja->ruta (NULL sin ruta)
+    int *sig_ruta;       // num_mangos+1 saltos a la proxima posicion sin etiquetar
+} IndiceEspacial;
+
+int construir_indice(IndiceEspacial *ind, const Caja *caja);
+int indice_mas_cercano(const IndiceEspacial *ind, const Caja *caja, double x, double y, double *dist);
+void indice_quitar(IndiceEspacial *ind, const Caja *caja, int idx);
+int indice_restantes(const IndiceEspacial *ind);
+int indice_siguiente_ruta(IndiceEspacial *ind, const Caja *caja, int desde);
+void liberar_indice(IndiceEspacial *ind);
+
+#endif
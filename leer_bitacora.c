@@ -0,0 +1,21 @@
+// leer_bitacora.c - pasa a texto una bitacora binaria (escaner/robot -B)
+// Uso: leer_bitacora <archivo>   (sin archivo lee de stdin)
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitacora.h"
+
+int main(int argc, char *argv[]) {
+    FILE *f = stdin;
+    if (argc > 1) {
+        f = fopen(argv[1], "rb");
+        if (!f) {
+            perror(argv[1]);
+            return EXIT_FAILURE;
+        }
+    }
+    int rc = bitacora_decodificar(f, stdout);
+    if (f != stdin) fclose(f);
+    return rc == 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,169 @@
+// llegadas.c - instantes de entrada de las cajas a la banda (fija, poisson, traza)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "datos.h"
+#include "llegadas.h"
+
+void iniciar_llegadas_fija(Llegadas *ll, double separacion) {
+    memset(ll, 0, sizeof(*ll));
+    ll->modo = LLEGADAS_FIJA;
+    ll->separacion = separacion > 0.0 ? separacion : 0.0;
+    reiniciar_llegadas(ll);
+}
+
+/* ------------------ traza ------------------ */
+/* Un instante por linea; las lineas vacias y lo que sigue a '#' no cuentan */
+static int cargar_traza(Llegadas *ll, const char *archivo) {
+    FILE *f = fopen(archivo, "r");
+    if (!f) {
+        perror("fopen(traza)");
+        return -1;
+    }
+    int cap = 0, n = 0;
+    double *v = NULL;
+    char linea[256];
+    int num_linea = 0;
+    while (fgets(linea, sizeof(linea), f)) {
+        num_linea++;
+        char *c = strchr(linea, '#');
+        if (c) *c = '\0';
+        char *p = linea + strspn(linea, " \t\r\n");
+        if (*p == '\0') continue;
+        char *fin;
+        double t = strtod(p, &fin);
+        if (fin == p || (n > 0 && t < v[n - 1])) {
+            fprintf(stderr, "Traza %s, linea %d: se esperaba un instante creciente\n", archivo, num_linea);
+            free(v);
+            fclose(f);
+            return -1;
+        }
+        if (n == cap) {
+            cap = cap ? cap * 2 : 64;
+            double *nv = realloc(v, sizeof(double) * (size_t)cap);
+            if (!nv) {
+                perror("realloc(traza)");
+                free(v);
+                fclose(f);
+                return -1;
+            }
+            v = nv;
+        }
+        v[n++] = t;
+    }
+    fclose(f);
+    if (n < 2) {
+        fprintf(stderr, "Traza %s: hacen falta al menos dos instantes\n", archivo);
+        free(v);
+        return -1;
+    }
+
+    /* relativa al primero; al repetirse, la primera de la vuelta siguiente
+       llega una separacion media despues de la ultima */
+    double t0 = v[0];
+    for (int i = 0; i < n; i++) v[i] -= t0;
+    ll->traza = v;
+    ll->n_traza = n;
+    ll->periodo = v[n - 1] + v[n - 1] / (double)(n - 1);
+    ll->separacion = v[n - 1] / (double)(n - 1);
+    return 0;
+}
+
+/* "fija:<s>", "poisson:<s media>" o "traza:<archivo>" */
+int parsear_llegadas(Llegadas *ll, const char *spec, unsigned int semilla) {
+    memset(ll, 0, sizeof(*ll));
+    ll->semilla = semilla;
+    const char *valor = strchr(spec, ':');
+    if (!valor || valor[1] == '\0') return -1;
+    size_t n = (size_t)(valor - spec);
+    valor++;
+
+    if (n == 4 && strncmp(spec, "fija", n) == 0) ll->modo = LLEGADAS_FIJA;
+    else if (n == 7 && strncmp(spec, "poisson", n) == 0) ll->modo = LLEGADAS_POISSON;
+    else if (n == 5 && strncmp(spec, "traza", n) == 0) ll->modo = LLEGADAS_TRAZA;
+    else return -1;
+
+    if (ll->modo == LLEGADAS_TRAZA) {
+        if (cargar_traza(ll, valor) != 0) return -1;
+    } else {
+        char *fin;
+        ll->separacion = strtod(valor, &fin);
+        if (*fin != '\0' || !(ll->separacion > 0.0)) return -1;
+    }
+    reiniciar_llegadas(ll);
+    return 0;
+}
+
+void reiniciar_llegadas(Llegadas *ll) {
+    ll->seed = ll->semilla;
+    ll->siguiente = 0;
+    ll->t = 0.0;
+}
+
+void liberar_llegadas(Llegadas *ll) {
+    free(ll->traza);
+    ll->traza = NULL;
+    ll->n_traza = 0;
+}
+
+/* ------------------ proxima_llegada ------------------ */
+/* La primera caja entra en 0; las demas segun el modo, nunca a menos de
+   `minima` de la anterior */
+double proxima_llegada(Llegadas *ll, double minima) {
+    long i = ll->siguiente++;
+    if (i == 0) {
+        ll->t = 0.0;
+        return ll->t;
+    }
+    double t;
+    switch (ll->modo) {
+    case LLEGADAS_POISSON: {
+        /* 1 - u en (0, 1]: el logaritmo nunca es de 0 */
+        double u = (double)rand_r(&ll->seed) / ((double)RAND_MAX + 1.0);
+        t = ll->t - ll->separacion * log(1.0 - u);
+        break;
+    }
+    case LLEGADAS_TRAZA: {
+        long vuelta = i / ll->n_traza;
+        t = ll->traza[i % ll->n_traza] + (double)vuelta * ll->periodo;
+        break;
+    }
+    default:
+        t = (double)i * ll->separacion;
+        break;
+    }
+    if (t < ll->t + minima) t = ll->t + minima;
+    ll->t = t;
+    return t;
+}
+
+double llegadas_separacion_min(const Llegadas *ll) {
+    if (ll->modo == LLEGADAS_POISSON) return ll->separacion / LLEGADAS_RAFAGA;
+    if (ll->modo == LLEGADAS_TRAZA) {
+        double min = ll->periodo - ll->traza[ll->n_traza - 1];
+        for (int i = 1; i < ll->n_traza; i++)
+            if (ll->traza[i] - ll->traza[i - 1] < min) min = ll->traza[i] - ll->traza[i - 1];
+        return min;
+    }
+    return ll->separacion;
+}
+
+/* Lo que tarda la banda en correr la caja su propio largo (caja cuadrada) */
+double separacion_fisica(const Caja *caja, float velocidad_banda) {
+    if (!caja || velocidad_banda <= 0.0f || caja->area_caja <= 0.0f) return 0.0;
+    return sqrt((double)caja->area_caja) / (double)velocidad_banda;
+}
+
+void describir_llegadas(const Llegadas *ll, char *buf, size_t tam) {
+    if (ll->modo == LLEGADAS_POISSON)
+        snprintf(buf, tam, "poisson, media %.3f s (%.3f cajas/s)", ll->separacion, 1.0 / ll->separacion);
+    else if (ll->modo == LLEGADAS_TRAZA)
+        snprintf(buf, tam, "traza de %d instantes, media %.3f s", ll->n_traza, ll->separacion);
+    else if (ll->separacion > 0.0)
+        snprintf(buf, tam, "una caja cada %.3f s (%.3f cajas/s)", ll->separacion, 1.0 / ll->separacion);
+    else
+        snprintf(buf, tam, "cajas pegadas (separacion minima)");
+}
@@ -0,0 +1,55 @@
+#ifndef LLEGADAS_H
+#define LLEGADAS_H
+
+#include <stddef.h>
+
+#include "datos.h"
+
+// ---------- LLEGADAS DE CAJAS A LA BANDA ----------
+// Da el instante (s desde que entro la primera caja) en que entra cada caja.
+// Tres procesos:
+//  - fija: una caja cada `separacion` s, con decimales.
+//  - poisson: separaciones exponenciales de media `separacion`.
+//  - traza: los instantes de un archivo de texto, uno por linea (s,
+//    crecientes; '#' empieza un comentario). Se toman relativos al primero y,
+//    si hay mas cajas que lineas, la traza se repite a continuacion.
+// En cualquier modo una caja no entra antes de que la anterior haya avanzado
+// su propio largo (lado / velocidad): quien pide la proxima llegada pasa esa
+// separacion minima y la llegada se corre si hace falta.
+// No tiene hilos: lo usan el robot en tiempo real y simular_banda en tiempo
+// virtual. Una copia reiniciada con reiniciar_llegadas repite la misma
+// secuencia (la traza se comparte, no se copia).
+//
+//   robot -A fija:0.8 | poisson:1.5 | traza:<archivo> | max
+
+typedef enum {
+    LLEGADAS_FIJA = 0,
+    LLEGADAS_POISSON,
+    LLEGADAS_TRAZA
+} ModoLlegadas;
+
+#define LLEGADAS_RAFAGA 4   // poisson: la separacion minima que se espera es media / RAFAGA
+
+typedef struct {
+    int modo;                // ModoLlegadas
+    double separacion;       // fija: s entre cajas; poisson: media
+    unsigned int semilla;    // poisson: semilla inicial (rand_r)
+    double *traza;           // traza: instantes relativos al primero
+    int n_traza;
+    double periodo;          // traza: cuanto se corre cada repeticion
+    /* estado de la secuencia */
+    unsigned int seed;
+    long siguiente;          // cajas ya entregadas
+    double t;                // instante de la ultima llegada
+} Llegadas;
+
+void iniciar_llegadas_fija(Llegadas *ll, double separacion);
+int parsear_llegadas(Llegadas *ll, const char *spec, unsigned int semilla);  // "fija:s", "poisson:s", "traza:archivo"
+void reiniciar_llegadas(Llegadas *ll);
+void liberar_llegadas(Llegadas *ll);
+double proxima_llegada(Llegadas *ll, double minima);   // minima: s desde la llegada anterior
+double llegadas_separacion_min(const Llegadas *ll);    // separacion mas corta que se espera
+double separacion_fisica(const Caja *caja, float velocidad_banda);
+void describir_llegadas(const Llegadas *ll, char *buf, size_t tam);
+
+#endif
@@ -0,0 +1,134 @@
+// logica_robot.c - decisiones del robot independientes del reloj (tiempo real o simulado)
+
+#include <math.h>
+
+#include "datos.h"
+#include "logica_robot.h"
+
+/* ------------------ estado del mango ------------------ */
+int mango_libre(const Mango *m) {
+    return __atomic_load_n(&m->etiquetado, __ATOMIC_ACQUIRE) == MANGO_LIBRE;
+}
+
+int mango_etiquetado(const Mango *m) {
+    return __atomic_load_n(&m->etiquetado, __ATOMIC_ACQUIRE) == MANGO_ETIQUETADO;
+}
+
+static int cambiar_estado(Mango *m, int de, int a) {
+    return __atomic_compare_exchange_n(&m->etiquetado, &de, a, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/* Compare-and-swap libre -> reservado: de dos robots que eligen el mismo
+   mango solo uno sale hacia el; el otro vuelve a buscar. */
+int reservar_mango(Mango *m, int robot) {
+    return cambiar_estado(m, MANGO_LIBRE, MANGO_RESERVADO(robot));
+}
+
+/* Etiqueta un mango reservado por este robot (o libre, si no lo reservo) */
+int etiquetar_mango(Mango *m, int robot) {
+    return cambiar_estado(m, MANGO_RESERVADO(robot), MANGO_ETIQUETADO) ||
+           cambiar_estado(m, MANGO_LIBRE, MANGO_ETIQUETADO);
+}
+
+void liberar_mango(Mango *m, int robot) {
+    cambiar_estado(m, MANGO_RESERVADO(robot), MANGO_LIBRE);
+}
+
+/* ------------------ buscar_mango_cercano ------------------ */
+/* Devuelve el indice del mango libre (sin etiquetar ni reservar) mas cercano
+   al brazo, -1 si no hay.
+   Recorre todos los mangos; queda como referencia del indice espacial. */
+int buscar_mango_cercano(const Caja *caja, double arm_x, double arm_y, double *dist) {
+    int best_idx = -1;
+    double best_dist = 1e9;
+
+    for (int mi = 0; mi < caja->num_mangos; mi++) {
+        const Mango *m = &caja->mangos[mi];
+        if (!mango_libre(m)) continue;
+        double d = distancia_2d(arm_x, arm_y, (double)m->x, (double)m->y);
+        if (d < best_dist) {
+            best_dist = d;
+            best_idx = mi;
+        }
+    }
+    if (dist) *dist = best_dist;
+    return best_idx;
+}
+
+/* ------------------ siguiente_en_ruta ------------------ */
+/* Igual que indice_siguiente_ruta pero recorriendo caja->ruta completa */
+int siguiente_en_ruta(const Caja *caja, int desde) {
+    if (!caja->ruta) return -1;
+    int n = caja->num_mangos;
+    int p0 = 0;
+    for (int p = 0; desde >= 0 && p < n; p++)
+        if (caja->ruta[p] == desde) { p0 = p + 1; break; }
+    for (int k = 0; k < n; k++) {
+        int mi = caja->ruta[(p0 + k) % n];
+        if (mango_libre(&caja->mangos[mi])) return mi;
+    }
+    return -1;
+}
+
+/* ------------------ tiempo_mango ------------------ */
+/* Tiempo de mover el brazo una distancia dist mas pegar la etiqueta */
+double tiempo_mango(const Caja *caja, double dist) {
+    double lado = sqrt((double)caja->area_caja);
+    double v_brazo = lado / CONST_VEL;
+    if (v_brazo <= 0.0) v_brazo = 1.0;
+    return dist / v_brazo + T_ETIQUETA;
+}
+
+/* ------------------ decidir_en_caja ------------------ */
+/* Elige el mango a etiquetar en una caja que ya esta en la ventana del robot.
+   Va al mango sin etiquetar mas cercano; si la caja trae ruta planificada y el
+   brazo ya etiqueto alguno (ultimo >= 0), prefiere el siguiente de la ruta
+   mientras no quede mucho mas lejos (RUTA_TOLERANCIA). Un robot recien llegado
+   entra por el mas cercano al centro y no por donde dejo la ruta el anterior.
+   Con ind (construido para esta caja) la busqueda no recorre toda la caja; en
+   tiempo real se llama sin lock mientras otros robots etiquetan la misma caja.
+   Devuelve 1 si hay un mango alcanzable antes de t_end, 0 si no hay trabajo. */
+int decidir_en_caja(const Caja *caja, IndiceEspacial *ind, double t_caja, double t_end,
+                    double arm_x, double arm_y, int ultimo, DecisionRobot *dec) {
+    dec->idx = -1;
+    dec->dist = 0.0;
+    dec->t_total = 0.0;
+    dec->sin_tiempo = 0;
+    if (!caja || caja->num_mangos <= 0) return 0;
+
+    double dist;
+    int idx = ind ? indice_mas_cercano(ind, caja, arm_x, arm_y, &dist)
+                  : buscar_mango_cercano(caja, arm_x, arm_y, &dist);
+    if (idx < 0) return 0;
+    if (caja->ruta && ultimo >= 0) {
+        int sig = ind ? indice_siguiente_ruta(ind, caja, ultimo) : siguiente_en_ruta(caja, ultimo);
+        double d_sig = sig >= 0 ? distancia_2d(arm_x, arm_y, (double)caja->mangos[sig].x,
+                                               (double)caja->mangos[sig].y) : 0.0;
+        if (sig >= 0 && d_sig <= dist * RUTA_TOLERANCIA) {
+            idx = sig;
+            dist = d_sig;
+        }
+    }
+
+    double t_total = tiempo_mango(caja, dist);
+    double remaining = t_end - t_caja; /* aproximado */
+    if (remaining < t_total) {
+        /* No hay tiempo para completar este mango dentro de la ventana;
+           lo dejamos para otro robot. */
+        dec->sin_tiempo = 1;
+        return 0;
+    }
+
+    dec->idx = idx;
+    dec->dist = dist;
+    dec->t_total = t_total;
+    return 1;
+}
+
+/* ------------------ util ------------------ */
+double distancia_2d(double x1, double y1, double x2, double y2) {
+    double dx = x1 - x2;
+    double dy = y1 - y2;
+    return sqrt(dx*dx + dy*dy);
+}
@@ -0,0 +1,42 @@
+#ifndef LOGICA_ROBOT_H
+#define LOGICA_ROBOT_H
+
+#include "datos.h"
+#include "indice_espacial.h"
+
+// ---------- PARAMETROS DEL MODELO DE ROBOT ----------
+#define DT_SECS 0.05
+#define PROB_FALLO 0.1   /* B por segundo; puedes reemplazar por la variable que envie el servidor si quieres */
+#define CONST_VEL 10.0
+#define T_ETIQUETA 0.5
+#define RUTA_TOLERANCIA 1.2   /* se sigue la ruta si su mango queda a <= 1.2x del mas cercano */
+
+// Valores de Mango.etiquetado. En tiempo real varios robots leen y cambian
+// el estado de un mango sin lock de caja: solo con operaciones atomicas.
+// Ciclo: libre -> reservado por un robot (brazo en camino) -> etiquetado;
+// si el robot falla antes de llegar, la reserva vuelve a libre.
+#define MANGO_LIBRE      0
+#define MANGO_ETIQUETADO 1
+#define MANGO_RESERVADO(robot) (2 + (robot))
+
+// Decision de un robot frente a una caja (compartida por tiempo real y simulacion)
+typedef struct {
+    int idx;          // indice del mango elegido, -1 si no hay trabajo en la caja
+    double dist;      // distancia del brazo al mango (cm)
+    double t_total;   // movimiento + etiquetado (s)
+    int sin_tiempo;   // 1 si habia mango pero no alcanza la ventana
+} DecisionRobot;
+
+int mango_libre(const Mango *m);        // ni reservado ni etiquetado
+int mango_etiquetado(const Mango *m);
+int reservar_mango(Mango *m, int robot);   // 1 si la reserva quedo para este robot
+int etiquetar_mango(Mango *m, int robot);  // 1 si este robot lo etiqueto, 0 si otro llego antes
+void liberar_mango(Mango *m, int robot);   // suelta la reserva si todavia es de este robot
+int buscar_mango_cercano(const Caja *caja, double arm_x, double arm_y, double *dist);
+int siguiente_en_ruta(const Caja *caja, int desde);
+double tiempo_mango(const Caja *caja, double dist);
+int decidir_en_caja(const Caja *caja, IndiceEspacial *ind, double t_caja, double t_end,
+                    double arm_x, double arm_y, int ultimo, DecisionRobot *dec);
+double distancia_2d(double x1, double y1, double x2, double y2);
+
+#endif
@@ -0,0 +1,203 @@
+// mangos_soa.c - contenido de caja en arreglos separados y busqueda vectorizada
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "datos.h"
+#include "mangos_soa.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SOA_X86 1
+#include <immintrin.h>
+#endif
+
+/* ------------------ construccion ------------------ */
+int soa_desde_caja(MangosSoA *soa, const Caja *caja) {
+    memset(soa, 0, sizeof(*soa));
+    int n = caja->num_mangos;
+    int n_relleno = ((n + SOA_BLOQUE - 1) / SOA_BLOQUE) * SOA_BLOQUE;
+    if (n_relleno == 0) n_relleno = SOA_BLOQUE;
+    int palabras = (n_relleno + 31) / 32;
+
+    soa->x = aligned_alloc(32, sizeof(float) * (size_t)n_relleno);
+    soa->y = aligned_alloc(32, sizeof(float) * (size_t)n_relleno);
+    soa->etiquetados = calloc((size_t)palabras, sizeof(uint32_t));
+    if (!soa->x || !soa->y || !soa->etiquetados) {
+        liberar_soa(soa);
+        return -1;
+    }
+    soa->n = n;
+    soa->n_relleno = n_relleno;
+
+    for (int i = 0; i < n; i++) {
+        soa->x[i] = caja->mangos[i].x;
+        soa->y[i] = caja->mangos[i].y;
+        if (caja->mangos[i].etiquetado) soa_marcar(soa, i);
+    }
+    /* el relleno cuenta como etiquetado: nunca sale elegido */
+    for (int i = n; i < n_relleno; i++) {
+        soa->x[i] = 0.0f;
+        soa->y[i] = 0.0f;
+        soa_marcar(soa, i);
+    }
+    return 0;
+}
+
+void liberar_soa(MangosSoA *soa) {
+    if (!soa) return;
+    free(soa->x);
+    free(soa->y);
+    free(soa->etiquetados);
+    memset(soa, 0, sizeof(*soa));
+}
+
+void soa_marcar(MangosSoA *soa, int idx) {
+    soa->etiquetados[idx >> 5] |= 1u << (idx & 31);
+}
+
+int soa_etiquetado(const MangosSoA *soa, int idx) {
+    return (soa->etiquetados[idx >> 5] >> (idx & 31)) & 1u;
+}
+
+/* ------------------ kernel escalar ------------------ */
+int soa_mas_cercano_escalar(const MangosSoA *soa, float ax, float ay, float *d2) {
+    int best_idx = -1;
+    float best = INFINITY;
+    for (int i = 0; i < soa->n; i++) {
+        if (soa_etiquetado(soa, i)) continue;
+        float dx = soa->x[i] - ax;
+        float dy = soa->y[i] - ay;
+        float d = dx * dx + dy * dy;
+        if (d < best) {
+            best = d;
+            best_idx = i;
+        }
+    }
+    if (d2) *d2 = best;
+    return best_idx;
+}
+
+#ifdef SOA_X86
+/* Junta los minimos por carril: menor distancia y, si empatan, menor indice */
+static int reducir_carriles(const float *v, const int *k, int carriles, float *d2) {
+    int best_idx = -1;
+    float best = INFINITY;
+    for (int c = 0; c < carriles; c++) {
+        if (k[c] < 0) continue;
+        if (v[c] < best || (v[c] == best && k[c] < best_idx)) {
+            best = v[c];
+            best_idx = k[c];
+        }
+    }
+    if (d2) *d2 = best;
+    return best_idx;
+}
+
+/* ------------------ kernel SSE2 (4 carriles) ------------------ */
+__attribute__((target("sse2")))
+static int mas_cercano_sse2(const MangosSoA *soa, float ax, float ay, float *d2) {
+    const __m128 vax = _mm_set1_ps(ax);
+    const __m128 vay = _mm_set1_ps(ay);
+    const __m128 inf = _mm_set1_ps(INFINITY);
+    const __m128i bit_carril = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128i cuatro = _mm_set1_epi32(4);
+    __m128 mejor = inf;
+    __m128i mejor_idx = _mm_set1_epi32(-1);
+    __m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+
+    for (int i = 0; i < soa->n_relleno; i += 4) {
+        uint32_t m = (soa->etiquetados[i >> 5] >> (i & 31)) & 0xFu;
+        if (m != 0xFu) {
+            __m128 dx = _mm_sub_ps(_mm_load_ps(soa->x + i), vax);
+            __m128 dy = _mm_sub_ps(_mm_load_ps(soa->y + i), vay);
+            __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            __m128i etiq = _mm_and_si128(_mm_set1_epi32((int)m), bit_carril);
+            __m128 libre = _mm_castsi128_ps(_mm_cmpeq_epi32(etiq, _mm_setzero_si128()));
+            d = _mm_or_ps(_mm_and_ps(libre, d), _mm_andnot_ps(libre, inf));
+            __m128 menor = _mm_cmplt_ps(d, mejor);
+            mejor = _mm_or_ps(_mm_and_ps(menor, d), _mm_andnot_ps(menor, mejor));
+            __m128i sel = _mm_castps_si128(menor);
+            mejor_idx = _mm_or_si128(_mm_and_si128(sel, idx), _mm_andnot_si128(sel, mejor_idx));
+        }
+        idx = _mm_add_epi32(idx, cuatro);
+    }
+
+    float v[4];
+    int k[4];
+    _mm_storeu_ps(v, mejor);
+    _mm_storeu_si128((__m128i *)k, mejor_idx);
+    return reducir_carriles(v, k, 4, d2);
+}
+
+/* ------------------ kernel AVX2 (8 carriles) ------------------ */
+__attribute__((target("avx2")))
+static int mas_cercano_avx2(const MangosSoA *soa, float ax, float ay, float *d2) {
+    const __m256 vax = _mm256_set1_ps(ax);
+    const __m256 vay = _mm256_set1_ps(ay);
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    const __m256i bit_carril = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i ocho = _mm256_set1_epi32(8);
+    __m256 mejor = inf;
+    __m256i mejor_idx = _mm256_set1_epi32(-1);
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (int i = 0; i < soa->n_relleno; i += 8) {
+        uint32_t m = (soa->etiquetados[i >> 5] >> (i & 31)) & 0xFFu;
+        if (m != 0xFFu) {
+            __m256 dx = _mm256_sub_ps(_mm256_load_ps(soa->x + i), vax);
+            __m256 dy = _mm256_sub_ps(_mm256_load_ps(soa->y + i), vay);
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            __m256i etiq = _mm256_and_si256(_mm256_set1_epi32((int)m), bit_carril);
+            __m256 libre = _mm256_castsi256_ps(_mm256_cmpeq_epi32(etiq, _mm256_setzero_si256()));
+            d = _mm256_blendv_ps(inf, d, libre);
+            __m256 menor = _mm256_cmp_ps(d, mejor, _CMP_LT_OQ);
+            mejor = _mm256_blendv_ps(mejor, d, menor);
+            mejor_idx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(mejor_idx),
+                                                             _mm256_castsi256_ps(idx), menor));
+        }
+        idx = _mm256_add_epi32(idx, ocho);
+    }
+
+    float v[8];
+    int k[8];
+    _mm256_storeu_ps(v, mejor);
+    _mm256_storeu_si256((__m256i *)k, mejor_idx);
+    return reducir_carriles(v, k, 8, d2);
+}
+#endif
+
+/* ------------------ despacho ------------------ */
+enum { KERNEL_ESCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+
+static int elegir_kernel(void) {
+    static int kernel = -1;   /* carrera benigna: todos escriben el mismo valor */
+    if (kernel < 0) {
+        int k = KERNEL_ESCALAR;
+#ifdef SOA_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) k = KERNEL_AVX2;
+        else if (__builtin_cpu_supports("sse2")) k = KERNEL_SSE2;
+#endif
+        kernel = k;
+    }
+    return kernel;
+}
+
+int soa_mas_cercano(const MangosSoA *soa, float ax, float ay, float *d2) {
+#ifdef SOA_X86
+    switch (elegir_kernel()) {
+    case KERNEL_AVX2: return mas_cercano_avx2(soa, ax, ay, d2);
+    case KERNEL_SSE2: return mas_cercano_sse2(soa, ax, ay, d2);
+    }
+#endif
+    return soa_mas_cercano_escalar(soa, ax, ay, d2);
+}
+
+const char *soa_kernel(void) {
+    switch (elegir_kernel()) {
+    case KERNEL_AVX2: return "avx2";
+    case KERNEL_SSE2: return "sse2";
+    }
+    return "escalar";
+}
@@ -0,0 +1,36 @@
+#ifndef MANGOS_SOA_H
+#define MANGOS_SOA_H
+
+#include <stdint.h>
+
+#include "datos.h"
+
+// ---------- MANGOS EN ESTRUCTURA DE ARREGLOS (SoA) ----------
+// Copia opcional del contenido de una caja para recorridos completos:
+// coordenadas en arreglos separados (alineados a 32 bytes y rellenos hasta
+// multiplo de 8) y las marcas de etiquetado en una mascara de bits.
+// La busqueda compara distancias al cuadrado en float, sin sqrt ni saltos
+// por mango; usa AVX2 o SSE2 segun la CPU y cae a C escalar si no hay.
+
+#define SOA_BLOQUE 8   // relleno de x[]/y[] (ancho de un registro AVX2)
+
+typedef struct {
+    int n;                  // mangos reales
+    int n_relleno;          // n redondeado a SOA_BLOQUE
+    float *x;
+    float *y;
+    uint32_t *etiquetados;  // bit i = mango i etiquetado (el relleno va en 1)
+} MangosSoA;
+
+int soa_desde_caja(MangosSoA *soa, const Caja *caja);
+void liberar_soa(MangosSoA *soa);
+void soa_marcar(MangosSoA *soa, int idx);
+int soa_etiquetado(const MangosSoA *soa, int idx);
+
+// Indice del mango sin etiquetar mas cercano a (ax, ay), -1 si no hay.
+// Empates -> menor indice. *d2 recibe la distancia al cuadrado.
+int soa_mas_cercano(const MangosSoA *soa, float ax, float ay, float *d2);
+int soa_mas_cercano_escalar(const MangosSoA *soa, float ax, float ay, float *d2);
+const char *soa_kernel(void);   // "avx2", "sse2" o "escalar"
+
+#endif
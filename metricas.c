@@ -0,0 +1,432 @@
+// metricas.c - contadores por robot y endpoint local en formato Prometheus
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "metricas.h"
+
+#define METRICAS_ESPERA_MS 200   /* cada cuanto el servidor revisa si debe terminar */
+
+/* Contadores de cada banda: los publica la banda (release) y el servidor
+   los lee (acquire); no hay lock compartido entre bandas */
+typedef struct {
+    MetricasRobot *_Atomic robots;
+    int num_robots;
+    HistogramaJitter *_Atomic jitter;
+} MetricasBanda;
+
+static MetricasBanda *g_bandas = NULL;
+static int g_num_bandas = 0;
+
+static const char *nombres_estado[NUM_ESTADOS_ROBOT] = { "parado", "ocioso", "ocupado", "daniado" };
+static const char *nombres_jitter[NUM_FUENTES_JITTER] = { "reloj", "brazo", "supervisor", "llegada" };
+
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* ------------------ contadores ------------------ */
+int iniciar_metricas(int bandas) {
+    if (bandas <= 0) return -1;
+    g_bandas = calloc((size_t)bandas, sizeof(MetricasBanda));
+    if (!g_bandas) {
+        perror("calloc(metricas)");
+        return -1;
+    }
+    g_num_bandas = bandas;
+    return 0;
+}
+
+/* Lo llama cada banda desde su propio hilo: la memoria queda en su nodo */
+MetricasRobot *metricas_banda(int banda, int num_robots) {
+    if (!g_bandas || banda < 0 || banda >= g_num_bandas || num_robots <= 0) return NULL;
+    size_t bytes = sizeof(MetricasRobot) * (size_t)num_robots;
+    MetricasRobot *m = aligned_alloc(METRICAS_LINEA_CACHE, bytes);
+    if (!m) {
+        perror("aligned_alloc(metricas)");
+        return NULL;
+    }
+    memset(m, 0, bytes);
+    double t0 = ahora_s();
+    for (int i = 0; i < num_robots; i++) atomic_store(&m[i].t_cambio, t0);
+    g_bandas[banda].num_robots = num_robots;
+    atomic_store_explicit(&g_bandas[banda].robots, m, memory_order_release);
+    return m;
+}
+
+/* Como metricas_banda, desde el hilo de la banda y antes de su reloj */
+HistogramaJitter *metricas_jitter(int banda) {
+    if (!g_bandas || banda < 0 || banda >= g_num_bandas) return NULL;
+    size_t bytes = sizeof(HistogramaJitter) * NUM_FUENTES_JITTER;
+    HistogramaJitter *h = aligned_alloc(METRICAS_LINEA_CACHE, bytes);
+    if (!h) {
+        perror("aligned_alloc(jitter)");
+        return NULL;
+    }
+    memset(h, 0, bytes);
+    atomic_store_explicit(&g_bandas[banda].jitter, h, memory_order_release);
+    return h;
+}
+
+/* Con el servidor ya detenido */
+void liberar_metricas(void) {
+    for (int b = 0; b < g_num_bandas; b++) {
+        free(atomic_load(&g_bandas[b].robots));
+        free(atomic_load(&g_bandas[b].jitter));
+    }
+    free(g_bandas);
+    g_bandas = NULL;
+    g_num_bandas = 0;
+}
+
+/* Cierra el tramo del estado anterior y empieza el nuevo. Escribe quien corre
+   al robot y tambien el supervisor (reserva, reemplazo, reparacion); por eso
+   el seqlock se toma con CAS. */
+void metrica_estado(MetricasRobot *m, EstadoRobot estado) {
+    if (!m) return;
+    double ahora = ahora_s();
+    unsigned int s = atomic_load_explicit(&m->seq, memory_order_relaxed);
+    while ((s & 1u) || !atomic_compare_exchange_weak_explicit(&m->seq, &s, s + 1, memory_order_acquire,
+                                                             memory_order_relaxed))
+        s = atomic_load_explicit(&m->seq, memory_order_relaxed);
+
+    int anterior = atomic_load_explicit(&m->estado, memory_order_relaxed);
+    double tramo = ahora - atomic_load_explicit(&m->t_cambio, memory_order_relaxed);
+    double acum = atomic_load_explicit(&m->segundos[anterior], memory_order_relaxed);
+    atomic_store_explicit(&m->segundos[anterior], acum + (tramo > 0.0 ? tramo : 0.0), memory_order_relaxed);
+    atomic_store_explicit(&m->estado, (int)estado, memory_order_relaxed);
+    atomic_store_explicit(&m->t_cambio, ahora, memory_order_relaxed);
+
+    atomic_store_explicit(&m->seq, s + 2, memory_order_release);
+}
+
+/* Copia consistente de los segundos por estado, incluido el tramo en curso */
+void metrica_segundos(MetricasRobot *m, double segundos[NUM_ESTADOS_ROBOT], int *estado) {
+    unsigned int s1, s2;
+    double t_cambio;
+    int e;
+    do {
+        s1 = atomic_load_explicit(&m->seq, memory_order_acquire);
+        for (int k = 0; k < NUM_ESTADOS_ROBOT; k++)
+            segundos[k] = atomic_load_explicit(&m->segundos[k], memory_order_relaxed);
+        e = atomic_load_explicit(&m->estado, memory_order_relaxed);
+        t_cambio = atomic_load_explicit(&m->t_cambio, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&m->seq, memory_order_relaxed);
+    } while ((s1 & 1u) || s1 != s2);
+
+    double tramo = ahora_s() - t_cambio;
+    if (tramo > 0.0) segundos[e] += tramo;
+    if (estado) *estado = e;
+}
+
+/* ------------------ jitter ------------------ */
+/* Despertar antes del plazo no es jitter: cuenta como 0 */
+void jitter_anotar(HistogramaJitter *h, FuenteJitter fuente, double plazo, double ahora) {
+    if (!h) return;
+    HistogramaJitter *j = &h[fuente];
+    double seg = ahora - plazo;
+    unsigned long ns = seg > 0.0 ? (unsigned long)(seg * 1e9) : 0;
+    int k = 0;
+    for (unsigned long us = ns / 1000; us > 0 && k < JITTER_CUBETAS - 1; us >>= 1) k++;
+    atomic_fetch_add_explicit(&j->cubetas[k], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&j->suma_ns, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&j->n, 1, memory_order_relaxed);
+    unsigned long max = atomic_load_explicit(&j->max_ns, memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak_explicit(&j->max_ns, &max, ns, memory_order_relaxed,
+                                                              memory_order_relaxed))
+        ;
+}
+
+/* cota superior (us) del percentil p */
+static double jitter_percentil_us(const HistogramaJitter *j, unsigned long total, double p) {
+    unsigned long objetivo = (unsigned long)(p * (double)total + 0.999999), acum = 0;
+    for (int k = 0; k < JITTER_CUBETAS; k++) {
+        acum += atomic_load_explicit(&j->cubetas[k], memory_order_relaxed);
+        if (acum >= objetivo) return (double)(1ul << k);
+    }
+    return (double)(1ul << (JITTER_CUBETAS - 1));
+}
+
+void imprimir_jitter(const HistogramaJitter *h, FILE *f) {
+    if (!h) return;
+    for (int s = 0; s < NUM_FUENTES_JITTER; s++) {
+        const HistogramaJitter *j = &h[s];
+        unsigned long n = atomic_load(&j->n);
+        if (n == 0) continue;
+        fprintf(f, "Jitter %-10s %8lu plazos | retraso medio %.1f us, p50 < %.0f us, p99 < %.0f us, max %.1f us\n",
+                nombres_jitter[s], n, (double)atomic_load(&j->suma_ns) / (double)n / 1e3,
+                jitter_percentil_us(j, n, 0.50), jitter_percentil_us(j, n, 0.99),
+                (double)atomic_load(&j->max_ns) / 1e3);
+    }
+}
+
+/* ------------------ formato Prometheus ------------------ */
+/* Robots de la banda b; 0 si todavia no publico sus contadores */
+static int robots_de(int b, MetricasRobot **m) {
+    *m = atomic_load_explicit(&g_bandas[b].robots, memory_order_acquire);
+    return *m ? g_bandas[b].num_robots : 0;
+}
+
+static void contador(FILE *f, const char *nombre, const char *ayuda, size_t campo) {
+    fprintf(f, "# HELP %s %s\n# TYPE %s counter\n", nombre, ayuda, nombre);
+    for (int b = 0; b < g_num_bandas; b++) {
+        MetricasRobot *m;
+        int n = robots_de(b, &m);
+        for (int i = 0; i < n; i++) {
+            atomic_ulong *c = (atomic_ulong *)((char *)&m[i] + campo);
+            fprintf(f, "%s{banda=\"%d\",robot=\"%d\"} %lu\n", nombre, b, i,
+                    atomic_load_explicit(c, memory_order_relaxed));
+        }
+    }
+}
+
+int escribir_metricas(FILE *f) {
+    if (!g_bandas) return -1;
+    contador(f, "mangoneado_robot_etiquetas_total", "Mangos etiquetados por el robot.",
+             offsetof(MetricasRobot, etiquetas));
+    contador(f, "mangoneado_robot_intentos_duplicados_total", "Reservas perdidas contra otro robot.",
+             offsetof(MetricasRobot, intentos_duplicados));
+    contador(f, "mangoneado_robot_sin_tiempo_total", "Mangos descartados por no alcanzar el tiempo de la ventana.",
+             offsetof(MetricasRobot, sin_tiempo));
+    contador(f, "mangoneado_robot_fallas_total", "Fallas del robot.",
+             offsetof(MetricasRobot, fallas));
+    contador(f, "mangoneado_robot_reemplazos_total", "Veces que el robot entro como reemplazo.",
+             offsetof(MetricasRobot, reemplazos));
+
+    int total = 0;
+    for (int b = 0; b < g_num_bandas; b++) {
+        MetricasRobot *m;
+        total += robots_de(b, &m);
+    }
+    /* estado de cada robot y, por banda, activos y segundos ocupado/trabajando */
+    int *estados = malloc(sizeof(int) * (size_t)(total > 0 ? total : 1));
+    int *activos = calloc((size_t)g_num_bandas * 2, sizeof(int));
+    double *ocupado = calloc((size_t)g_num_bandas * 2, sizeof(double));
+    if (!estados || !activos || !ocupado) {
+        free(estados);
+        free(activos);
+        free(ocupado);
+        return -1;
+    }
+    int *vistos = activos + g_num_bandas;
+    double *trabajando = ocupado + g_num_bandas;
+
+    fprintf(f, "# HELP mangoneado_robot_segundos_total Segundos del robot en cada estado.\n"
+               "# TYPE mangoneado_robot_segundos_total counter\n");
+    int *e = estados;
+    for (int b = 0; b < g_num_bandas; b++) {
+        MetricasRobot *m;
+        int n = robots_de(b, &m);
+        if (e + n > estados + total) n = (int)(estados + total - e);   /* se publico despues del conteo */
+        vistos[b] = n;
+        for (int i = 0; i < n; i++) {
+            double seg[NUM_ESTADOS_ROBOT];
+            metrica_segundos(&m[i], seg, &e[i]);
+            for (int k = 0; k < NUM_ESTADOS_ROBOT; k++)
+                fprintf(f, "mangoneado_robot_segundos_total{banda=\"%d\",robot=\"%d\",estado=\"%s\"} %.6f\n",
+                        b, i, nombres_estado[k], seg[k]);
+            ocupado[b] += seg[ROBOT_OCUPADO];
+            trabajando[b] += seg[ROBOT_OCUPADO] + seg[ROBOT_OCIOSO];
+            if (e[i] == ROBOT_OCIOSO || e[i] == ROBOT_OCUPADO) activos[b]++;
+        }
+        e += n;
+    }
+    fprintf(f, "# HELP mangoneado_robot_estado Estado actual (0 parado, 1 ocioso, 2 ocupado, 3 daniado).\n"
+               "# TYPE mangoneado_robot_estado gauge\n");
+    e = estados;
+    for (int b = 0; b < g_num_bandas; b++) {
+        for (int i = 0; i < vistos[b]; i++)
+            fprintf(f, "mangoneado_robot_estado{banda=\"%d\",robot=\"%d\"} %d\n", b, i, e[i]);
+        e += vistos[b];
+    }
+
+    fprintf(f, "# HELP mangoneado_robots_activos Robots ociosos u ocupados en este momento.\n"
+               "# TYPE mangoneado_robots_activos gauge\n");
+    for (int b = 0; b < g_num_bandas; b++)
+        fprintf(f, "mangoneado_robots_activos{banda=\"%d\"} %d\n", b, activos[b]);
+    fprintf(f, "# HELP mangoneado_utilizacion Fraccion del tiempo activo con el brazo ocupado.\n"
+               "# TYPE mangoneado_utilizacion gauge\n");
+    for (int b = 0; b < g_num_bandas; b++)
+        fprintf(f, "mangoneado_utilizacion{banda=\"%d\"} %.6f\n", b,
+                trabajando[b] > 0.0 ? ocupado[b] / trabajando[b] : 0.0);
+    free(estados);
+    free(activos);
+    free(ocupado);
+
+    /* histograma acumulado: le en segundos, como pide Prometheus */
+    fprintf(f, "# HELP mangoneado_jitter_segundos Retraso al despertar respecto del plazo absoluto.\n"
+               "# TYPE mangoneado_jitter_segundos histogram\n");
+    for (int b = 0; b < g_num_bandas; b++) {
+        HistogramaJitter *h = atomic_load_explicit(&g_bandas[b].jitter, memory_order_acquire);
+        if (!h) continue;
+        for (int s = 0; s < NUM_FUENTES_JITTER; s++) {
+            HistogramaJitter *j = &h[s];
+            unsigned long acum = 0;
+            for (int k = 0; k < JITTER_CUBETAS - 1; k++) {
+                acum += atomic_load_explicit(&j->cubetas[k], memory_order_relaxed);
+                fprintf(f, "mangoneado_jitter_segundos_bucket{banda=\"%d\",fuente=\"%s\",le=\"%.9g\"} %lu\n",
+                        b, nombres_jitter[s], (double)(1ul << k) * 1e-6, acum);
+            }
+            /* jitter_anotar suma la cubeta antes que n: +Inf no queda por debajo de la ultima */
+            unsigned long n = atomic_load_explicit(&j->n, memory_order_relaxed);
+            acum += atomic_load_explicit(&j->cubetas[JITTER_CUBETAS - 1], memory_order_relaxed);
+            if (n < acum) n = acum;
+            fprintf(f, "mangoneado_jitter_segundos_bucket{banda=\"%d\",fuente=\"%s\",le=\"+Inf\"} %lu\n",
+                    b, nombres_jitter[s], n);
+            fprintf(f, "mangoneado_jitter_segundos_sum{banda=\"%d\",fuente=\"%s\"} %.9f\n", b,
+                    nombres_jitter[s], (double)atomic_load_explicit(&j->suma_ns, memory_order_relaxed) * 1e-9);
+            fprintf(f, "mangoneado_jitter_segundos_count{banda=\"%d\",fuente=\"%s\"} %lu\n", b,
+                    nombres_jitter[s], n);
+        }
+    }
+    return 0;
+}
+
+/* ------------------ endpoint ------------------ */
+static int g_servidor_fd = -1;
+static char g_ruta_unix[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static atomic_int g_detener;
+static pthread_t g_hilo_metricas;
+
+/* Un pedido por conexion: se descarta lo que mande el cliente y se responde
+   siempre con las metricas */
+static void atender(int fd) {
+    char pedido[1024];
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    if (poll(&pfd, 1, METRICAS_ESPERA_MS) > 0) (void)read(fd, pedido, sizeof(pedido));
+
+    char *cuerpo = NULL;
+    size_t largo = 0;
+    FILE *f = open_memstream(&cuerpo, &largo);
+    if (!f) return;
+    escribir_metricas(f);
+    fclose(f);
+
+    char cabecera[160];
+    int n = snprintf(cabecera, sizeof(cabecera),
+                     "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                     "Content-Length: %zu\r\n\r\n", largo);
+    if (write(fd, cabecera, (size_t)n) == n) {
+        size_t enviado = 0;
+        while (enviado < largo) {
+            ssize_t w = write(fd, cuerpo + enviado, largo - enviado);
+            if (w <= 0 && errno != EINTR) break;
+            if (w > 0) enviado += (size_t)w;
+        }
+    }
+    free(cuerpo);
+}
+
+static void *hilo_metricas(void *arg) {
+    (void)arg;
+    struct pollfd pfd = { .fd = g_servidor_fd, .events = POLLIN };
+    while (!atomic_load(&g_detener)) {
+        if (poll(&pfd, 1, METRICAS_ESPERA_MS) <= 0) continue;
+        int cli = accept(g_servidor_fd, NULL, NULL);
+        if (cli < 0) continue;
+        atender(cli);
+        close(cli);
+    }
+    return NULL;
+}
+
+/* destino numerico = puerto TCP en 127.0.0.1; si no, ruta de socket Unix.
+   Devuelve 0 si el servidor quedo escuchando, -1 si no. */
+int iniciar_servidor_metricas(const char *destino) {
+    if (!destino || !g_bandas) return -1;
+    char *fin;
+    long puerto = strtol(destino, &fin, 10);
+    int es_tcp = (*destino != '\0' && *fin == '\0');
+
+    int fd;
+    if (es_tcp) {
+        if (puerto <= 0 || puerto > 65535) {
+            fprintf(stderr, "Puerto de metricas invalido: %s\n", destino);
+            return -1;
+        }
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            perror("socket(metricas)");
+            return -1;
+        }
+        int opt = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        struct sockaddr_in dir;
+        memset(&dir, 0, sizeof(dir));
+        dir.sin_family = AF_INET;
+        dir.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        dir.sin_port = htons((uint16_t)puerto);
+        if (bind(fd, (struct sockaddr *)&dir, sizeof(dir)) < 0) {
+            perror("bind(metricas)");
+            close(fd);
+            return -1;
+        }
+    } else {
+        struct sockaddr_un dir;
+        memset(&dir, 0, sizeof(dir));
+        dir.sun_family = AF_UNIX;
+        if (strlen(destino) >= sizeof(dir.sun_path)) {
+            fprintf(stderr, "Ruta de socket de metricas demasiado larga: %s\n", destino);
+            return -1;
+        }
+        strcpy(dir.sun_path, destino);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            perror("socket(metricas)");
+            return -1;
+        }
+        unlink(destino);   /* socket viejo de una corrida anterior */
+        if (bind(fd, (struct sockaddr *)&dir, sizeof(dir)) < 0) {
+            perror("bind(metricas)");
+            close(fd);
+            return -1;
+        }
+        strcpy(g_ruta_unix, destino);
+    }
+    if (listen(fd, 8) < 0) {
+        perror("listen(metricas)");
+        close(fd);
+        if (g_ruta_unix[0]) unlink(g_ruta_unix);
+        g_ruta_unix[0] = '\0';
+        return -1;
+    }
+
+    g_servidor_fd = fd;
+    atomic_store(&g_detener, 0);
+    if (pthread_create(&g_hilo_metricas, NULL, hilo_metricas, NULL) != 0) {
+        perror("pthread_create(metricas)");
+        close(fd);
+        g_servidor_fd = -1;
+        if (g_ruta_unix[0]) unlink(g_ruta_unix);
+        g_ruta_unix[0] = '\0';
+        return -1;
+    }
+    printf("Metricas en %s%s\n", es_tcp ? "http://127.0.0.1:" : "unix:", destino);
+    return 0;
+}
+
+void detener_servidor_metricas(void) {
+    if (g_servidor_fd < 0) return;
+    atomic_store(&g_detener, 1);
+    pthread_join(g_hilo_metricas, NULL);
+    close(g_servidor_fd);
+    g_servidor_fd = -1;
+    if (g_ruta_unix[0]) unlink(g_ruta_unix);
+    g_ruta_unix[0] = '\0';
+}
@@ -0,0 +1,87 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+
+// ---------- METRICAS POR ROBOT (FORMATO PROMETHEUS) ----------
+// Cada banda (robot -N) reserva desde su hilo los contadores de sus robots,
+// asi quedan en su nodo; el servidor las recorre todas con la etiqueta banda.
+// Cada robot tiene su bloque de contadores en su propia linea de cache y solo
+// su hilo lo escribe (load + store relajado, sin instrucciones con lock); la
+// unica excepcion es reemplazos, que suma solo el supervisor. El tiempo en
+// cada estado se acumula al cambiar de estado y se publica con un seqlock,
+// asi el lector nunca ve un total que retrocede.
+//
+// robot -M <puerto>  sirve las metricas en 127.0.0.1:<puerto>
+// robot -M <ruta>    sirve las metricas en un socket Unix
+// Responde cualquier pedido con un HTTP/1.0 minimo (curl, Prometheus):
+//   curl -s localhost:9734/metrics
+//   curl -s --unix-socket /tmp/robot.sock http://x/metrics
+
+#define METRICAS_LINEA_CACHE 64
+
+typedef enum {
+    ROBOT_PARADO = 0,   // sin hilo (apagado o reemplazo sin usar)
+    ROBOT_OCIOSO,       // esperando cajas con trabajo en su ventana
+    ROBOT_OCUPADO,      // brazo moviendose o etiquetando
+    ROBOT_DANIADO,      // en reparacion
+    NUM_ESTADOS_ROBOT
+} EstadoRobot;
+
+typedef struct {
+    atomic_ulong etiquetas;            // mangos etiquetados
+    atomic_ulong intentos_duplicados;  // reservas perdidas contra otro robot
+    atomic_ulong sin_tiempo;           // mango elegido pero sin tiempo en la ventana
+    atomic_ulong fallas;
+    atomic_ulong reemplazos;           // veces que entro como reemplazo
+    atomic_uint seq;                   // seqlock de lo que sigue (impar = escribiendo)
+    atomic_int estado;                 // EstadoRobot actual
+    _Atomic double t_cambio;           // instante del ultimo cambio de estado
+    _Atomic double segundos[NUM_ESTADOS_ROBOT];
+} __attribute__((aligned(METRICAS_LINEA_CACHE))) MetricasRobot;
+
+// ---------- JITTER DE LOS PLAZOS ----------
+// Cada espera con plazo absoluto (CLOCK_MONOTONIC) anota cuanto tarde se
+// desperto respecto del plazo, en un histograma log2 en microsegundos por
+// banda y por fuente: el reloj de banda, la llegada del brazo, el hilo del
+// supervisor y la entrada de cada caja. Lo escriben varios hilos (suma
+// atomica); se sirve como histograma Prometheus y sale en el resumen.
+
+typedef enum {
+    JITTER_RELOJ = 0,   // reloj de banda: cruce de ventana o salida de una caja
+    JITTER_BRAZO,       // fin del movimiento del brazo
+    JITTER_SUPERVISOR,  // rueda de temporizadores del supervisor
+    JITTER_LLEGADA,     // entrada de una caja a la banda
+    NUM_FUENTES_JITTER
+} FuenteJitter;
+
+#define JITTER_CUBETAS 24   // cubeta k: retraso < 2^k us (la ultima junta lo que sobra)
+
+typedef struct {
+    atomic_ulong cubetas[JITTER_CUBETAS];
+    atomic_ulong n;
+    atomic_ulong suma_ns;
+    atomic_ulong max_ns;
+} __attribute__((aligned(METRICAS_LINEA_CACHE))) HistogramaJitter;
+
+int iniciar_metricas(int bandas);
+void liberar_metricas(void);
+MetricasRobot *metricas_banda(int banda, int num_robots);   // contadores de los robots de la banda
+HistogramaJitter *metricas_jitter(int banda);   // NUM_FUENTES_JITTER histogramas de la banda
+void jitter_anotar(HistogramaJitter *h, FuenteJitter fuente, double plazo, double ahora);   // h NULL: nada
+void imprimir_jitter(const HistogramaJitter *h, FILE *f);
+
+// Solo desde el hilo duenio del contador
+static inline void metrica_sumar(atomic_ulong *contador) {
+    atomic_store_explicit(contador, atomic_load_explicit(contador, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+void metrica_estado(MetricasRobot *m, EstadoRobot estado);
+void metrica_segundos(MetricasRobot *m, double segundos[NUM_ESTADOS_ROBOT], int *estado);
+
+int escribir_metricas(FILE *f);
+int iniciar_servidor_metricas(const char *destino);
+void detener_servidor_metricas(void);
+
+#endif
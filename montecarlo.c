@@ -0,0 +1,222 @@
+// montecarlo.c - fallas de la celda sobre muchas semillas, en paralelo
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "datos.h"
+#include "estadistica.h"
+#include "llegadas.h"
+#include "logica_robot.h"
+#include "montecarlo.h"
+#include "planificador.h"
+#include "simulacion.h"
+
+typedef struct {
+    const EstadoSistema *estado;     /* original: solo se lee */
+    const ParamsMonteCarlo *params;
+    int robots_maximos;
+    EstadoSistema **copias;          /* una por hilo del pool, la arma su hilo */
+    ResultadoSimulacion *res;        /* [reserva * corridas + corrida] */
+    int *rc;                         /* por corrida */
+} MonteCarlo;
+
+/* Elemento del pool: una corrida con todas las cantidades de reservas */
+typedef struct {
+    MonteCarlo *mc;
+    int corrida;
+} Corrida;
+
+/* splitmix64: semillas de corridas vecinas sin correlacion entre si */
+uint64_t mezclar_semilla(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static void liberar_copia(EstadoSistema *e) {
+    if (!e) return;
+    for (int i = 0; i < e->num_cajas; i++) free(e->cajas[i].mangos);
+    free(e->cajas);
+    free(e);
+}
+
+/* Cajas y mangos propios; la ruta se comparte (simular_banda no la toca) */
+static EstadoSistema *copiar_estado(const EstadoSistema *orig) {
+    EstadoSistema *e = malloc(sizeof(*e));
+    if (!e) return NULL;
+    *e = *orig;
+    e->cajas = calloc((size_t)orig->num_cajas, sizeof(Caja));
+    if (!e->cajas) {
+        free(e);
+        return NULL;
+    }
+    for (int i = 0; i < orig->num_cajas; i++) {
+        const Caja *c = &orig->cajas[i];
+        Mango *m = malloc(sizeof(Mango) * (size_t)(c->num_mangos > 0 ? c->num_mangos : 1));
+        if (!m) {
+            e->num_cajas = i;
+            liberar_copia(e);
+            return NULL;
+        }
+        memcpy(m, c->mangos, sizeof(Mango) * (size_t)c->num_mangos);
+        e->cajas[i] = *c;
+        e->cajas[i].mangos = m;
+    }
+    return e;
+}
+
+static void tarea_corrida(void *elemento, int hilo) {
+    Corrida *c = elemento;
+    MonteCarlo *m = c->mc;
+    const ParamsMonteCarlo *mc = m->params;
+    /* la copia se toca primero en el hilo que la usa (queda en su nodo) */
+    if (!m->copias[hilo]) m->copias[hilo] = copiar_estado(m->estado);
+    EstadoSistema *estado = m->copias[hilo];
+    if (!estado) {
+        m->rc[c->corrida] = -1;
+        return;
+    }
+
+    uint64_t z = mezclar_semilla(((uint64_t)mc->semilla << 32) | (uint32_t)c->corrida);
+    ParamsSimulacion p;
+    params_simulacion_default(&p, estado, m->robots_maximos);
+    p.num_robots = m->robots_maximos;
+    p.semilla = (unsigned int)z;
+    Llegadas llegadas;
+    if (mc->llegadas) {
+        llegadas = *mc->llegadas;
+        llegadas.semilla = (unsigned int)(z >> 32);
+        p.llegadas = &llegadas;
+    }
+    for (int k = 0; k < mc->num_reservas; k++) {
+        p.reservas = mc->reservas[k];
+        if (simular_banda(estado, &p, &m->res[(long)k * mc->corridas + c->corrida]) != 0)
+            m->rc[c->corrida] = -1;
+    }
+}
+
+/* "0,1,2,3" -> cantidades de reservas */
+int parsear_reservas(ParamsMonteCarlo *mc, const char *lista) {
+    char copia[256];
+    snprintf(copia, sizeof(copia), "%s", lista);
+    mc->num_reservas = 0;
+    for (char *tok = strtok(copia, ","); tok; tok = strtok(NULL, ",")) {
+        char *fin;
+        long v = strtol(tok, &fin, 10);
+        if (fin == tok || *fin != '\0' || v < 0 || v > 1000 || mc->num_reservas == MONTECARLO_MAX_RESERVAS)
+            return -1;
+        mc->reservas[mc->num_reservas++] = (int)v;
+    }
+    return mc->num_reservas > 0 ? 0 : -1;
+}
+
+/* Una fila de la tabla: la distribucion sobre las corridas con k reservas */
+static void imprimir_fila(const MonteCarlo *m, int k, double *perdidos, double *huecos) {
+    int n = m->params->corridas;
+    const ResultadoSimulacion *res = &m->res[(long)k * n];
+    double suma_fallas = 0.0, suma_huecos = 0.0, suma_perdidos = 0.0, hueco_max = 0.0;
+    int sin_perdida = 0;
+    for (int i = 0; i < n; i++) {
+        perdidos[i] = (double)(res[i].mangos_totales - res[i].mangos_etiquetados);
+        huecos[i] = res[i].hueco_total;
+        suma_fallas += res[i].fallas;
+        suma_huecos += res[i].huecos;
+        suma_perdidos += perdidos[i];
+        if (perdidos[i] == 0.0) sin_perdida++;
+        if (res[i].hueco_max > hueco_max) hueco_max = res[i].hueco_max;
+    }
+    ordenar_muestras(perdidos, n);
+    ordenar_muestras(huecos, n);
+    printf("%8d %7.2f %7.2f | %8.2f %6.0f %6.0f %6.0f %6.0f %6.1f%% | %7.2f %7.2f %7.2f %7.2f %8.2f\n",
+           m->params->reservas[k], suma_fallas / n, suma_huecos / n,
+           suma_perdidos / n, percentil(perdidos, n, 50.0), percentil(perdidos, n, 90.0),
+           percentil(perdidos, n, 99.0), perdidos[n - 1], 100.0 * sin_perdida / n,
+           percentil(huecos, n, 50.0), percentil(huecos, n, 90.0), percentil(huecos, n, 99.0),
+           huecos[n - 1], hueco_max);
+}
+
+/* Todas las corridas en el pool; vuelve cuando terminaron. Deja en m->copias
+   las copias de cada hilo (hay que liberarlas aunque falle). */
+static int lanzar_corridas(MonteCarlo *m, Corrida *corridas, int *hilos) {
+    int n = m->params->corridas;
+    Planificador *pool = crear_planificador(m->params->hilos, n, tarea_corrida);
+    if (!pool) return -1;
+    *hilos = planificador_hilos(pool);
+    m->copias = calloc((size_t)*hilos, sizeof(EstadoSistema *));
+    if (!m->copias) {
+        perror("calloc(copias)");
+        destruir_planificador(pool);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        corridas[i].mc = m;
+        corridas[i].corrida = i;
+        planificador_encolar(pool, &corridas[i]);
+    }
+    destruir_planificador(pool);
+
+    for (int i = 0; i < n; i++) {
+        if (m->rc[i] != 0) {
+            fprintf(stderr, "Monte Carlo: fallo la corrida %d\n", i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* ------------------ correr_montecarlo ------------------ */
+int correr_montecarlo(const EstadoSistema *estado, int robots_maximos, const ParamsMonteCarlo *mc) {
+    if (!estado || !mc || estado->num_cajas <= 0 || robots_maximos <= 0 || mc->corridas <= 0 ||
+        mc->num_reservas <= 0)
+        return -1;
+    int n = mc->corridas;
+
+    MonteCarlo m;
+    memset(&m, 0, sizeof(m));
+    m.estado = estado;
+    m.params = mc;
+    m.robots_maximos = robots_maximos;
+    m.res = calloc((size_t)n * (size_t)mc->num_reservas, sizeof(ResultadoSimulacion));
+    m.rc = calloc((size_t)n, sizeof(int));
+    Corrida *corridas = calloc((size_t)n, sizeof(Corrida));
+    double *perdidos = malloc(sizeof(double) * (size_t)n);
+    double *huecos = malloc(sizeof(double) * (size_t)n);
+    int hilos = 0, rc = -1;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (!m.res || !m.rc || !corridas || !perdidos || !huecos) perror("calloc(montecarlo)");
+    else rc = lanzar_corridas(&m, corridas, &hilos);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (rc == 0) {
+        int mangos = 0;
+        for (int i = 0; i < estado->num_cajas; i++) mangos += estado->cajas[i].num_mangos;
+        double ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+        printf("\n=== MONTE CARLO DE FALLAS (tiempo virtual) ===\n");
+        printf("%d corridas | %d cajas, %d mangos, %d robots con ventana | prob. de fallo %.3f/s | "
+               "semilla base %u\n",
+               n, estado->num_cajas, mangos, robots_maximos, PROB_FALLO, mc->semilla);
+        printf("                         |           mangos sin etiquetar por corrida       |"
+               "      s de ventana sin robot por corrida\n");
+        printf("reservas  fallas  huecos |    media    p50    p90    p99    max  sin perd |"
+               "     p50     p90     p99     max  hueco max\n");
+        for (int k = 0; k < mc->num_reservas; k++) imprimir_fila(&m, k, perdidos, huecos);
+        printf("Tiempo real: %.3f s en %d hilos (%.3f ms por simulacion)\n", ms / 1e3, hilos,
+               ms / ((double)n * mc->num_reservas));
+    }
+
+    if (m.copias)
+        for (int h = 0; h < hilos; h++) liberar_copia(m.copias[h]);
+    free(m.copias);
+    free(m.res);
+    free(m.rc);
+    free(corridas);
+    free(perdidos);
+    free(huecos);
+    return rc;
+}
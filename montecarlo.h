@@ -0,0 +1,45 @@
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include <stdint.h>
+
+#include "datos.h"
+#include "llegadas.h"
+
+// ---------- ANALISIS DE FALLAS POR MONTE CARLO ----------
+// Corre muchas veces la celda en tiempo virtual (simular_banda) con semillas
+// independientes, en paralelo sobre el pool con robo de trabajo, y resume la
+// distribucion de mangos sin etiquetar y de huecos de failover para cada
+// cantidad de robots de reserva.
+//  - Todas las ventanas de la banda (robots_maximos) tienen su robot
+//    titular; las reservas son robots hot-standby aparte
+//    (ParamsSimulacion.reservas). Con 0 reservas una falla deja su ventana
+//    sin robot hasta la reparacion.
+//  - Cada corrida tiene su propia corriente de numeros al azar: la semilla
+//    de fallas y la de llegadas (poisson) salen de mezclar la semilla base
+//    con el numero de corrida (splitmix64). La corrida i usa las mismas
+//    semillas con cualquier cantidad de reservas, asi las diferencias entre
+//    filas son de las reservas y no del azar.
+//  - hueco: s que una ventana paso sin robot por una falla (desde la falla
+//    hasta que una reserva la tomo o el titular se reparo).
+// Cada hilo del pool corre sobre su propia copia de las cajas; el estado
+// original no se toca. El resultado no depende de la cantidad de hilos.
+//
+//   robot -S -X <corridas> [-r 0,1,2,3] [-P <hilos>] [-s <semilla>] [-A ...]
+
+#define MONTECARLO_MAX_RESERVAS 16   // cantidades de reservas que se comparan
+
+typedef struct {
+    int corridas;
+    int reservas[MONTECARLO_MAX_RESERVAS];
+    int num_reservas;
+    int hilos;                 // hilos del pool (<= 0 = uno por nucleo)
+    unsigned int semilla;      // semilla base
+    const Llegadas *llegadas;  // opcional: proceso de llegadas (NULL = separacion de siempre)
+} ParamsMonteCarlo;
+
+uint64_t mezclar_semilla(uint64_t x);   // splitmix64; tambien las semillas por banda y robot de robot.c
+int parsear_reservas(ParamsMonteCarlo *mc, const char *lista);   // "0,1,2,3"; -1 si no es valida
+int correr_montecarlo(const EstadoSistema *estado, int robots_maximos, const ParamsMonteCarlo *mc);
+
+#endif
@@ -0,0 +1,268 @@
+// planificador.c - pool fijo de hilos con deques Chase-Lev y robo de trabajo
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "afinidad.h"
+#include "planificador.h"
+
+#define PLAN_LINEA_CACHE 64
+#define PLAN_LOTE 32   /* maximo que un trabajador se lleva de la cola comun */
+
+/* Deque de un trabajador: el duenio usa abajo, los ladrones arriba. Cada
+   indice en su propia linea de cache para que robar no ensucie al duenio. */
+typedef struct {
+    _Alignas(PLAN_LINEA_CACHE) atomic_long arriba;
+    _Alignas(PLAN_LINEA_CACHE) atomic_long abajo;
+    _Atomic(void *) *buf;
+    long mascara;
+    int hilo;
+    Planificador *plan;
+} DequeTrabajo;
+
+struct Planificador {
+    int hilos;
+    int lanzados;            /* hilos creados (los que hay que esperar) */
+    long mascara;            /* capacidad - 1 (potencia de 2) */
+    TareaPool tarea;
+    DequeTrabajo *deques;
+    pthread_t *threads;
+
+    /* cola comun: lo que llega de hilos que no son del pool */
+    pthread_mutex_t lock_comun;
+    void **comun;
+    long comun_inicio;
+    atomic_long comun_n;
+
+    /* trabajadores dormidos */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    atomic_long pendientes;  /* encolados y todavia no tomados */
+    atomic_int dormidos;
+    int fin;
+};
+
+static __thread Planificador *t_plan = NULL;   /* pool del hilo actual, si es trabajador */
+static __thread int t_hilo = -1;
+
+/* ------------------ deque Chase-Lev ------------------ */
+/* Version con atomicos C11 de Le, Pop, Cohen y Zappa Nardelli (PPoPP 2013),
+   sin crecer: el pool nunca tiene mas de capacidad elementos. */
+static void deque_poner(DequeTrabajo *d, void *e) {
+    long b = atomic_load_explicit(&d->abajo, memory_order_relaxed);
+    atomic_store_explicit(&d->buf[b & d->mascara], e, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->abajo, b + 1, memory_order_relaxed);
+}
+
+static void *deque_sacar(DequeTrabajo *d) {
+    long b = atomic_load_explicit(&d->abajo, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->abajo, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->arriba, memory_order_relaxed);
+    void *e = NULL;
+    if (t <= b) {
+        e = atomic_load_explicit(&d->buf[b & d->mascara], memory_order_relaxed);
+        if (t == b) {
+            /* ultimo elemento: se compite con los ladrones */
+            if (!atomic_compare_exchange_strong_explicit(&d->arriba, &t, t + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed))
+                e = NULL;
+            atomic_store_explicit(&d->abajo, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&d->abajo, b + 1, memory_order_relaxed);
+    }
+    return e;
+}
+
+static void *deque_robar(DequeTrabajo *d) {
+    long t = atomic_load_explicit(&d->arriba, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->abajo, memory_order_acquire);
+    if (t >= b) return NULL;
+    void *e = atomic_load_explicit(&d->buf[t & d->mascara], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->arriba, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+        return NULL;
+    return e;
+}
+
+/* ------------------ cola comun ------------------ */
+/* Toma un elemento de la cola comun y pasa a la deque propia una parte de lo
+   que queda, para que los demas lo puedan robar. */
+static void *tomar_comun(Planificador *p, DequeTrabajo *d) {
+    if (atomic_load_explicit(&p->comun_n, memory_order_relaxed) == 0) return NULL;
+    void *e = NULL;
+    pthread_mutex_lock(&p->lock_comun);
+    long n = atomic_load_explicit(&p->comun_n, memory_order_relaxed);
+    if (n > 0) {
+        long lote = n / p->hilos + 1;   /* una parte pareja para cada trabajador */
+        if (lote > n) lote = n;
+        if (lote > PLAN_LOTE) lote = PLAN_LOTE;
+        e = p->comun[p->comun_inicio & p->mascara];
+        for (long k = 1; k < lote; k++)
+            deque_poner(d, p->comun[(p->comun_inicio + k) & p->mascara]);
+        p->comun_inicio += lote;
+        atomic_store_explicit(&p->comun_n, n - lote, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&p->lock_comun);
+    return e;
+}
+
+static void *robar(Planificador *p, int hilo, unsigned int *semilla) {
+    int inicio = (int)(rand_r(semilla) % (unsigned)p->hilos);
+    for (int k = 0; k < p->hilos; k++) {
+        int v = (inicio + k) % p->hilos;
+        if (v == hilo) continue;
+        void *e = deque_robar(&p->deques[v]);
+        if (e) return e;
+    }
+    return NULL;
+}
+
+/* ------------------ trabajadores ------------------ */
+static void *hilo_trabajador(void *arg) {
+    DequeTrabajo *d = (DequeTrabajo *)arg;
+    Planificador *p = d->plan;
+    unsigned int semilla = (unsigned int)d->hilo * 2654435761u + 1u;
+    t_plan = p;
+    t_hilo = d->hilo;
+
+    while (1) {
+        void *e = deque_sacar(d);
+        if (!e) e = tomar_comun(p, d);
+        if (!e) e = robar(p, d->hilo, &semilla);
+        if (e) {
+            atomic_fetch_sub(&p->pendientes, 1);
+            p->tarea(e, d->hilo);
+            continue;
+        }
+        /* hay algo encolado que todavia no se ve (se esta apilando o
+           perdimos un CAS): reintentar sin dormir */
+        if (atomic_load(&p->pendientes) > 0) {
+            sched_yield();
+            continue;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        atomic_fetch_add(&p->dormidos, 1);
+        while (atomic_load(&p->pendientes) <= 0 && !p->fin)
+            pthread_cond_wait(&p->cond, &p->lock);
+        atomic_fetch_sub(&p->dormidos, 1);
+        int terminar = p->fin && atomic_load(&p->pendientes) <= 0;
+        pthread_mutex_unlock(&p->lock);
+        if (terminar) break;
+    }
+    return NULL;
+}
+
+/* ------------------ API ------------------ */
+/* hilos <= 0 = uno por nucleo en que puede correr quien lo crea (con
+   robot -N, los de su banda: los trabajadores heredan esa afinidad) */
+Planificador *crear_planificador(int hilos, int capacidad, TareaPool tarea) {
+    if (capacidad <= 0 || !tarea) return NULL;
+    if (hilos <= 0) {
+        hilos = nucleos_permitidos();
+    }
+    long cap = 1;
+    while (cap < capacidad) cap <<= 1;
+
+    Planificador *p = calloc(1, sizeof(Planificador));
+    if (!p) {
+        perror("calloc(planificador)");
+        return NULL;
+    }
+    p->hilos = hilos;
+    p->mascara = cap - 1;
+    p->tarea = tarea;
+    p->deques = aligned_alloc(PLAN_LINEA_CACHE, sizeof(DequeTrabajo) * (size_t)hilos);
+    p->threads = calloc((size_t)hilos, sizeof(pthread_t));
+    p->comun = malloc(sizeof(void *) * (size_t)cap);
+    if (!p->deques || !p->threads || !p->comun) {
+        perror("malloc(planificador)");
+        free(p->deques);
+        free(p->threads);
+        free(p->comun);
+        free(p);
+        return NULL;
+    }
+    pthread_mutex_init(&p->lock_comun, NULL);
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->cond, NULL);
+
+    /* todas las deques antes que los hilos: un trabajador puede robarle a
+       cualquiera apenas arranca */
+    int ok = 1;
+    for (int i = 0; i < hilos; i++) {
+        DequeTrabajo *d = &p->deques[i];
+        atomic_init(&d->arriba, 0);
+        atomic_init(&d->abajo, 0);
+        d->mascara = cap - 1;
+        d->hilo = i;
+        d->plan = p;
+        d->buf = calloc((size_t)cap, sizeof(*d->buf));
+        if (!d->buf) {
+            perror("calloc(deque)");
+            ok = 0;
+        }
+    }
+    for (int i = 0; ok && i < hilos; i++) {
+        if (pthread_create(&p->threads[i], NULL, hilo_trabajador, &p->deques[i]) != 0) {
+            perror("pthread_create(hilo_trabajador)");
+            ok = 0;
+            break;
+        }
+        p->lanzados++;
+    }
+    if (!ok) {
+        destruir_planificador(p);
+        return NULL;
+    }
+    return p;
+}
+
+/* Desde un trabajador va a su deque; desde cualquier otro hilo, a la cola comun */
+void planificador_encolar(Planificador *p, void *elemento) {
+    if (t_plan == p) {
+        deque_poner(&p->deques[t_hilo], elemento);
+    } else {
+        pthread_mutex_lock(&p->lock_comun);
+        long n = atomic_load_explicit(&p->comun_n, memory_order_relaxed);
+        p->comun[(p->comun_inicio + n) & p->mascara] = elemento;
+        atomic_store_explicit(&p->comun_n, n + 1, memory_order_relaxed);
+        pthread_mutex_unlock(&p->lock_comun);
+    }
+    /* primero pendientes y despues dormidos; el trabajador que se duerme lo
+       hace al reves, asi uno de los dos ve al otro */
+    atomic_fetch_add(&p->pendientes, 1);
+    if (atomic_load(&p->dormidos) > 0) {
+        pthread_mutex_lock(&p->lock);
+        pthread_cond_signal(&p->cond);
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+int planificador_hilos(const Planificador *p) {
+    return p ? p->hilos : 0;
+}
+
+void destruir_planificador(Planificador *p) {
+    if (!p) return;
+    pthread_mutex_lock(&p->lock);
+    p->fin = 1;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 0; i < p->lanzados; i++) pthread_join(p->threads[i], NULL);
+    for (int i = 0; i < p->hilos; i++) free(p->deques[i].buf);
+    pthread_mutex_destroy(&p->lock_comun);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->cond);
+    free(p->deques);
+    free(p->threads);
+    free(p->comun);
+    free(p);
+}
@@ -0,0 +1,24 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+// ---------- POOL FIJO DE HILOS CON ROBO DE TRABAJO ----------
+// Un hilo trabajador por nucleo; cada uno tiene su deque (Chase-Lev, tamanio
+// fijo): apila y desapila por abajo sin lock y los demas le roban por arriba
+// con un CAS. Lo que se encola desde afuera del pool (reloj de banda,
+// supervisor) va a una cola comun; el trabajador que la vacia se lleva un
+// lote a su deque y los ociosos se lo roban. Un trabajador sin nada que hacer
+// duerme en una condicion hasta que se encola algo.
+//
+// Un elemento no puede estar dos veces a la vez en el pool: capacidad es el
+// maximo de elementos encolados al mismo tiempo (por ejemplo, robots).
+
+typedef void (*TareaPool)(void *elemento, int hilo);
+
+typedef struct Planificador Planificador;
+
+Planificador *crear_planificador(int hilos, int capacidad, TareaPool tarea);
+void planificador_encolar(Planificador *p, void *elemento);
+int planificador_hilos(const Planificador *p);
+void destruir_planificador(Planificador *p);   // termina los hilos cuando no queda nada encolado
+
+#endif
@@ -0,0 +1,380 @@
+// protocolo.c - tramas binarias versionadas entre escaner y robot
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "datos.h"
+#include "arena.h"
+#include "protocolo.h"
+
+/* ------------------ codificacion big-endian ------------------ */
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+    return p + 4;
+}
+
+static uint8_t *put_i32(uint8_t *p, int32_t v) {
+    return put_u32(p, (uint32_t)v);
+}
+
+static uint8_t *put_f32(uint8_t *p, float f) {
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    return put_u32(p, v);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static int32_t get_i32(const uint8_t *p) {
+    return (int32_t)get_u32(p);
+}
+
+static float get_f32(const uint8_t *p) {
+    uint32_t v = get_u32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+static uint8_t *put_cabecera(uint8_t *p, uint16_t tipo, uint32_t longitud) {
+    p = put_u32(p, PROTO_MAGIC);
+    p = put_u16(p, PROTO_VERSION);
+    p = put_u16(p, tipo);
+    return put_u32(p, longitud);
+}
+
+/* ------------------ cajas y parametros ------------------ */
+static size_t tamanio_caja(const Caja *caja) {
+    size_t n = (size_t)caja->num_mangos;
+    return 4 * 4 + n * 5 * 4 + (caja->ruta ? n * 4 : 0);
+}
+
+static uint8_t *put_caja(uint8_t *p, const Caja *caja) {
+    p = put_i32(p, caja->id);
+    p = put_f32(p, caja->area_caja);
+    p = put_i32(p, caja->num_mangos);
+    for (int m = 0; m < caja->num_mangos; ++m) {
+        const Mango *mg = &caja->mangos[m];
+        p = put_i32(p, mg->id);
+        p = put_f32(p, mg->x);
+        p = put_f32(p, mg->y);
+        p = put_f32(p, mg->area);
+        p = put_i32(p, mg->etiquetado);
+    }
+    p = put_i32(p, caja->ruta ? caja->num_mangos : 0);
+    if (caja->ruta)
+        for (int m = 0; m < caja->num_mangos; ++m) p = put_i32(p, caja->ruta[m]);
+    return p;
+}
+
+/* Recorre una caja sin decodificarla y suma en *bytes lo que van a ocupar sus
+   mangos y su ruta en la arena. Devuelve el puntero siguiente o NULL si el
+   buffer no alcanza. */
+static const uint8_t *medir_caja(const uint8_t *p, const uint8_t *fin, size_t *bytes) {
+    if (fin - p < 3 * 4) return NULL;
+    int32_t num_mangos = get_i32(p + 8);
+    p += 3 * 4;
+    if (num_mangos < 0 || (size_t)(fin - p) / (5 * 4) < (size_t)num_mangos) return NULL;
+    p += (size_t)num_mangos * 5 * 4;
+    if (fin - p < 4) return NULL;
+    int32_t largo = get_i32(p);  p += 4;
+    if (largo < 0 || (size_t)(fin - p) / 4 < (size_t)largo) return NULL;
+    /* get_caja toma lugar para un mango aunque la caja venga vacia */
+    *bytes += arena_medida(sizeof(Mango) * (size_t)(num_mangos ? num_mangos : 1)) +
+              arena_medida(sizeof(int) * (size_t)largo);
+    return p + (size_t)largo * 4;
+}
+
+/* Decodifica una caja; sus mangos (y su ruta si viene) salen de la arena, o
+   de malloc si arena es NULL. Devuelve el puntero siguiente o NULL si el
+   buffer no alcanza o la ruta es invalida. */
+static const uint8_t *get_caja(const uint8_t *p, const uint8_t *fin, Caja *caja, Arena *arena) {
+    memset(caja, 0, sizeof(*caja));
+    if (fin - p < 3 * 4) return NULL;
+    caja->id = get_i32(p);          p += 4;
+    caja->area_caja = get_f32(p);   p += 4;
+    caja->num_mangos = get_i32(p);  p += 4;
+
+    if (caja->num_mangos < 0) return NULL;
+    if ((size_t)(fin - p) / (5 * 4) < (size_t)caja->num_mangos) return NULL;
+    size_t bytes_mangos = sizeof(Mango) * (size_t)(caja->num_mangos ? caja->num_mangos : 1);
+    caja->mangos = arena ? arena_tomar(arena, bytes_mangos) : malloc(bytes_mangos);
+    if (!caja->mangos) return NULL;
+
+    for (int m = 0; m < caja->num_mangos; ++m) {
+        Mango *mg = &caja->mangos[m];
+        mg->id = get_i32(p);          p += 4;
+        mg->x = get_f32(p);           p += 4;
+        mg->y = get_f32(p);           p += 4;
+        mg->area = get_f32(p);        p += 4;
+        mg->etiquetado = get_i32(p);  p += 4;
+    }
+
+    if (fin - p < 4) return NULL;
+    int32_t largo = get_i32(p);  p += 4;
+    if (largo == 0) return p;
+    if (largo != caja->num_mangos) return NULL;
+    if ((size_t)(fin - p) / 4 < (size_t)largo) return NULL;
+    caja->ruta = arena ? arena_tomar(arena, sizeof(int) * (size_t)largo)
+                       : malloc(sizeof(int) * (size_t)largo);
+    if (!caja->ruta) return NULL;
+    for (int i = 0; i < largo; ++i) {
+        caja->ruta[i] = get_i32(p);  p += 4;
+        if (caja->ruta[i] < 0 || caja->ruta[i] >= caja->num_mangos) return NULL;
+    }
+    return p;
+}
+
+static uint8_t *put_parametros(uint8_t *p, const EstadoSistema *estado, int robots_maximos) {
+    p = put_f32(p, estado->velocidad_banda);
+    p = put_f32(p, estado->longitud_banda);
+    p = put_i32(p, estado->num_robots);
+    p = put_i32(p, estado->num_cajas);
+    return put_i32(p, robots_maximos);
+}
+
+static const uint8_t *get_parametros(const uint8_t *p, EstadoSistema *estado, int *robots_maximos) {
+    estado->velocidad_banda = get_f32(p);  p += 4;
+    estado->longitud_banda = get_f32(p);   p += 4;
+    estado->num_robots = get_i32(p);       p += 4;
+    estado->num_cajas = get_i32(p);        p += 4;
+    if (robots_maximos) *robots_maximos = get_i32(p);
+    return p + 4;
+}
+
+/* ------------------ serializar_estado ------------------ */
+/* Arma la trama TRAMA_ESTADO completa (cabecera + carga) en un solo buffer
+   para enviarla con una sola llamada. El llamador libera con free(). */
+uint8_t *serializar_estado(const EstadoSistema *estado, int robots_maximos, size_t *len) {
+    if (!estado || !len) return NULL;
+
+    size_t carga = 5 * 4;
+    for (int c = 0; c < estado->num_cajas; ++c)
+        carga += tamanio_caja(&estado->cajas[c]);
+    if (carga > PROTO_MAX_CARGA) return NULL;
+
+    uint8_t *buf = malloc(PROTO_CABECERA + carga);
+    if (!buf) {
+        perror("malloc(trama)");
+        return NULL;
+    }
+
+    uint8_t *p = put_cabecera(buf, TRAMA_ESTADO, (uint32_t)carga);
+    p = put_parametros(p, estado, robots_maximos);
+    for (int c = 0; c < estado->num_cajas; ++c)
+        p = put_caja(p, &estado->cajas[c]);
+
+    *len = PROTO_CABECERA + carga;
+    return buf;
+}
+
+/* ------------------ deserializar_estado ------------------ */
+/* Reconstruye el EstadoSistema desde la carga de una trama TRAMA_ESTADO.
+   Valida cada longitud contra lo que queda del buffer. Una primera pasada
+   mide la carga y el estado, sus cajas, mangos y rutas se arman en un solo
+   bloque (EstadoSistema al principio): liberar_estado hace un unico free. */
+EstadoSistema *deserializar_estado(const uint8_t *carga, size_t len, int *robots_maximos) {
+    const uint8_t *fin = carga + len;
+    EstadoSistema cabecera;
+
+    if (len < 5 * 4) return NULL;
+    const uint8_t *inicio_cajas = get_parametros(carga, &cabecera, robots_maximos);
+    if (cabecera.num_cajas <= 0) return NULL;
+    if ((size_t)(fin - inicio_cajas) / (4 * 4) < (size_t)cabecera.num_cajas) return NULL;
+
+    size_t bytes = arena_medida(sizeof(EstadoSistema)) +
+                   arena_medida(sizeof(Caja) * (size_t)cabecera.num_cajas);
+    const uint8_t *p = inicio_cajas;
+    for (int c = 0; c < cabecera.num_cajas; ++c) {
+        p = medir_caja(p, fin, &bytes);
+        if (!p) return NULL;
+    }
+
+    Arena arena = {0};
+    if (arena_preparar(&arena, bytes) != 0) return NULL;
+    EstadoSistema *estado = arena_tomar(&arena, sizeof(EstadoSistema));
+    *estado = cabecera;
+    estado->cajas = arena_tomar(&arena, sizeof(Caja) * (size_t)estado->num_cajas);
+
+    p = inicio_cajas;
+    for (int c = 0; c < estado->num_cajas; ++c) {
+        p = get_caja(p, fin, &estado->cajas[c], &arena);
+        if (!p) {
+            arena_liberar(&arena);
+            return NULL;
+        }
+    }
+
+    return estado;
+}
+
+/* ------------------ modo flujo ------------------ */
+uint8_t *serializar_config(const EstadoSistema *estado, int robots_maximos, size_t *len) {
+    if (!estado || !len) return NULL;
+    uint8_t *buf = malloc(PROTO_CABECERA + 5 * 4);
+    if (!buf) return NULL;
+    uint8_t *p = put_cabecera(buf, TRAMA_CONFIG, 5 * 4);
+    put_parametros(p, estado, robots_maximos);
+    *len = PROTO_CABECERA + 5 * 4;
+    return buf;
+}
+
+/* Llena los parametros de la banda; estado->cajas queda sin tocar */
+int deserializar_config(const uint8_t *carga, size_t len, EstadoSistema *estado, int *robots_maximos) {
+    if (!carga || !estado || len < 5 * 4) return -1;
+    get_parametros(carga, estado, robots_maximos);
+    return estado->num_cajas < 0 ? -1 : 0;
+}
+
+uint8_t *serializar_caja(const Caja *caja, size_t *len) {
+    if (!caja || !len) return NULL;
+    size_t carga = tamanio_caja(caja);
+    if (carga > PROTO_MAX_CARGA) return NULL;
+    uint8_t *buf = malloc(PROTO_CABECERA + carga);
+    if (!buf) return NULL;
+    put_caja(put_cabecera(buf, TRAMA_CAJA, (uint32_t)carga), caja);
+    *len = PROTO_CABECERA + carga;
+    return buf;
+}
+
+/* Decodifica una caja; el llamador libera caja->mangos y caja->ruta */
+int deserializar_caja(const uint8_t *carga, size_t len, Caja *caja) {
+    if (!carga || !caja) return -1;
+    if (!get_caja(carga, carga + len, caja, NULL)) {
+        free(caja->mangos);
+        free(caja->ruta);
+        caja->mangos = NULL;
+        caja->ruta = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/* ------------------ latido y metricas ------------------ */
+size_t serializar_latido(uint8_t *buf, int32_t num_robots) {
+    put_i32(put_cabecera(buf, TRAMA_LATIDO, 4), num_robots);
+    return PROTO_LATIDO_LEN;
+}
+
+int deserializar_latido(const uint8_t *carga, size_t len, int32_t *num_robots) {
+    if (!carga || !num_robots || len < 4) return -1;
+    *num_robots = get_i32(carga);
+    return 0;
+}
+
+size_t serializar_metricas(uint8_t *buf, const MetricasCelda *m) {
+    uint8_t *p = put_cabecera(buf, TRAMA_METRICAS, 5 * 4);
+    p = put_i32(p, m->robots_activos);
+    p = put_i32(p, m->cajas_salidas);
+    p = put_i32(p, m->mangos_salidos);
+    p = put_i32(p, m->mangos_perdidos);
+    put_f32(p, m->utilizacion);
+    return PROTO_METRICAS_LEN;
+}
+
+int deserializar_metricas(const uint8_t *carga, size_t len, MetricasCelda *m) {
+    if (!carga || !m || len < 5 * 4) return -1;
+    m->robots_activos = get_i32(carga);
+    m->cajas_salidas = get_i32(carga + 4);
+    m->mangos_salidos = get_i32(carga + 8);
+    m->mangos_perdidos = get_i32(carga + 12);
+    m->utilizacion = get_f32(carga + 16);
+    return 0;
+}
+
+/* El estado recibido es un solo bloque (ver deserializar_estado); un estado
+   de TRAMA_CONFIG no tiene cajas. En ambos casos alcanza con un free. */
+void liberar_estado(EstadoSistema *estado) {
+    free(estado);
+}
+
+/* ------------------ envio / recepcion de tramas ------------------ */
+int enviar_trama(int sock, const uint8_t *trama, size_t len) {
+    return send_all(sock, trama, len);
+}
+
+/* Escribe solo la cabecera (PROTO_CABECERA bytes), p.ej. para TRAMA_FIN */
+size_t serializar_cabecera(uint8_t *buf, uint16_t tipo, uint32_t longitud) {
+    put_cabecera(buf, tipo, longitud);
+    return PROTO_CABECERA;
+}
+
+/* Valida una cabecera ya leida (PROTO_CABECERA bytes) y devuelve su tipo y
+   el largo de la carga */
+int leer_cabecera(const uint8_t *cab, uint16_t *tipo, uint32_t *longitud) {
+    if (get_u32(cab) != PROTO_MAGIC) {
+        fprintf(stderr, "Trama invalida (magic)\n");
+        return -1;
+    }
+    if (get_u16(cab + 4) != PROTO_VERSION) {
+        fprintf(stderr, "Version de protocolo no soportada: %u\n", get_u16(cab + 4));
+        return -1;
+    }
+    *tipo = get_u16(cab + 6);
+    *longitud = get_u32(cab + 8);
+    return *longitud > PROTO_MAX_CARGA ? -1 : 0;
+}
+
+/* Lee una trama completa: cabecera y carga en dos lecturas, sin importar el
+   tamanio del estado. La carga se devuelve en *carga (liberar con free()). */
+int leer_trama(int sock, uint16_t *tipo, uint8_t **carga, uint32_t *len) {
+    uint8_t cab[PROTO_CABECERA];
+    uint16_t t;
+    uint32_t n;
+    if (recv_all(sock, cab, sizeof(cab)) < 0) return -1;
+    if (leer_cabecera(cab, &t, &n) < 0) return -1;
+
+    uint8_t *buf = malloc(n ? n : 1);
+    if (!buf) return -1;
+    if (n && recv_all(sock, buf, n) < 0) {
+        free(buf);
+        return -1;
+    }
+
+    *tipo = t;
+    *carga = buf;
+    *len = n;
+    return 0;
+}
+
+/* ------------------ send_all / recv_all ------------------ */
+int send_all(int sock, const void *buffer, size_t length) {
+    const char *ptr = (const char *)buffer;
+    size_t total_sent = 0;
+    while (total_sent < length) {
+        ssize_t sent = send(sock, ptr + total_sent, length - total_sent, 0);
+        if (sent <= 0) return -1;
+        total_sent += (size_t)sent;
+    }
+    return 0;
+}
+
+int recv_all(int sock, void *buffer, size_t length) {
+    char *ptr = buffer;
+    size_t total_received = 0;
+    while (total_received < length) {
+        ssize_t rec = recv(sock, ptr + total_received, length - total_received, 0);
+        if (rec <= 0) return -1;
+        total_received += (size_t)rec;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "datos.h"
+
+// ---------- PROTOCOLO ESCANER <-> ROBOT ----------
+// Toda trama lleva una cabecera fija seguida de `longitud` bytes de carga.
+// Todos los enteros y floats (IEEE-754, como uint32) viajan en big-endian.
+//
+//   magic    (uint32) 'MNGO'
+//   version  (uint16) PROTO_VERSION
+//   tipo     (uint16) TipoTrama
+//   longitud (uint32) bytes de carga que siguen
+
+#define PROTO_MAGIC   0x4D4E474Fu   // "MNGO"
+#define PROTO_VERSION 3         // 2: las cajas llevan su ruta planificada; 3: latido y metricas en tramas
+#define PROTO_CABECERA 12
+#define PROTO_MAX_CARGA (1u << 30) // limite defensivo al recibir
+
+typedef enum {
+    TRAMA_ESTADO = 1,     // EstadoSistema completo (ver serializar_estado)
+    TRAMA_CONFIG = 2,     // modo flujo: solo parametros de la banda
+    TRAMA_CAJA = 3,       // modo flujo: una caja escaneada
+    TRAMA_FIN = 4,        // modo flujo: no hay mas cajas; del robot: termino (sin carga)
+    TRAMA_LATIDO = 5,     // escaner -> robot: robots que tiene que tener activos
+    TRAMA_METRICAS = 6    // robot -> escaner: respuesta a cada latido (MetricasCelda)
+} TipoTrama;
+
+// Carga de TRAMA_ESTADO:
+//   velocidad_banda (f32), longitud_banda (f32), num_robots (i32),
+//   num_cajas (i32), robots_maximos (i32)
+//   por caja:  id (i32), area (f32), num_mangos (i32)
+//   por mango: id (i32), x (f32), y (f32), area (f32), etiquetado (i32)
+//   despues de los mangos: largo_ruta (i32, 0 o num_mangos) y largo_ruta
+//   indices de mango (i32) en orden de visita
+//
+// Carga de TRAMA_CONFIG: los 5 campos iniciales de TRAMA_ESTADO; num_cajas es el
+// total que se va a enviar (0 = flujo sin fin).
+// Carga de TRAMA_CAJA: una caja con el mismo formato que dentro de TRAMA_ESTADO.
+// Carga de TRAMA_LATIDO: num_robots (i32).
+// Carga de TRAMA_METRICAS: los campos de MetricasCelda en orden (i32 y f32).
+//
+// Despues del estado (o de TRAMA_FIN en modo flujo) el escaner manda un
+// TRAMA_LATIDO cada LATIDO_MS y el robot contesta cada uno con TRAMA_METRICAS;
+// al terminar contesta el ultimo con TRAMA_FIN.
+
+// Lo que el robot ve de su celda: contadores desde que arranco, salvo la
+// utilizacion, que es la del intervalo desde el latido anterior.
+typedef struct {
+    int32_t robots_activos;   // ventanas con un robot cubriendolas
+    int32_t cajas_salidas;    // cajas que ya salieron de la banda
+    int32_t mangos_salidos;   // mangos en esas cajas
+    int32_t mangos_perdidos;  // de esos, los que salieron sin etiqueta
+    float utilizacion;        // ocupado / (ocupado + ocioso) de los robots con ventana
+} MetricasCelda;
+
+#define PROTO_LATIDO_LEN (PROTO_CABECERA + 4)
+#define PROTO_METRICAS_LEN (PROTO_CABECERA + 5 * 4)
+
+uint8_t *serializar_estado(const EstadoSistema *estado, int robots_maximos, size_t *len);
+EstadoSistema *deserializar_estado(const uint8_t *carga, size_t len, int *robots_maximos);
+void liberar_estado(EstadoSistema *estado);
+
+uint8_t *serializar_config(const EstadoSistema *estado, int robots_maximos, size_t *len);
+int deserializar_config(const uint8_t *carga, size_t len, EstadoSistema *estado, int *robots_maximos);
+uint8_t *serializar_caja(const Caja *caja, size_t *len);
+int deserializar_caja(const uint8_t *carga, size_t len, Caja *caja);
+
+size_t serializar_latido(uint8_t *buf, int32_t num_robots);           // PROTO_LATIDO_LEN bytes
+int deserializar_latido(const uint8_t *carga, size_t len, int32_t *num_robots);
+size_t serializar_metricas(uint8_t *buf, const MetricasCelda *m);      // PROTO_METRICAS_LEN bytes
+int deserializar_metricas(const uint8_t *carga, size_t len, MetricasCelda *m);
+
+int enviar_trama(int sock, const uint8_t *trama, size_t len);
+size_t serializar_cabecera(uint8_t *buf, uint16_t tipo, uint32_t longitud);
+int leer_cabecera(const uint8_t *cab, uint16_t *tipo, uint32_t *longitud);
+int leer_trama(int sock, uint16_t *tipo, uint8_t **carga, uint32_t *len);
+
+int send_all(int sock, const void *buffer, size_t length);
+int recv_all(int sock, void *buffer, size_t length);
+
+#endif
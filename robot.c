@@ -1,5 +1,5 @@
 // robot.c  - Cliente "robots" para MangoNeado
-// Compilar: gcc robot.c -o robot -lpthread -lm
+// Compilar: make robot
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -16,265 +16,788 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <unistd.h>
 #include <errno.h>
 
 #include "datos.h"
+#include "afinidad.h"
+#include "bitacora.h"
+#include "indice_espacial.h"
+#include "llegadas.h"
+#include "metricas.h"
+#include "montecarlo.h"
 #include "robot.h"
-
-#define DT_SECS 0.05
-#define PROB_FALLO 0.1   /* B por segundo; puedes reemplazar por la variable que envie el servidor si quieres */
-#define CONST_VEL 10.0
-#define T_ETIQUETA 0.5
-
-/* Globals para que los hilos los encuentren fcilmente */
-static RobotInfo *g_robots_infos = NULL;
-static int g_robots_maximos = 0;
-static SistemaRobot *g_sistema = NULL;
-static int g_num_cajas = 0;
+#include "logica_robot.h"
+#include "simulacion.h"
+#include "protocolo.h"
+#include "snapshot.h"
+#include "planificador.h"
+#include "supervisor.h"
+#include "ventanas.h"
+
+/* Opciones de linea de comandos que comparten todas las bandas */
+typedef struct {
+    unsigned int semilla;
+    const char *snapshot;       /* -R: se reproduce ese archivo en vez de conectarse */
+    int hilos_pool;             /* -P: robots en un pool fijo de hilos (0 = uno por nucleo); -1 = un hilo por robot */
+    int dinamicas;              /* -D: anchos de ventana segun cobertura y carga (ventanas.h) */
+    const char *spec_llegadas;  /* -A: proceso de llegadas de cajas (llegadas.h) */
+    int bandas;                 /* -N: bandas en este proceso */
+    int prioridad_rt;           /* -T: SCHED_FIFO para los hilos con plazos (0 = no) */
+} OpcionesRobot;
+
+/* Una banda con su conexion al escaner, sus robots, su reloj y su supervisor */
+typedef struct {
+    const OpcionesRobot *op;
+    SistemaRobot sistema;
+    RelojBanda reloj;
+    EstadoSistema *estado;
+    int sockfd;                 /* -1 con snapshot */
+    int robots_maximos;
+    int flujo;                  /* 1 si el escaner manda las cajas una por una */
+    int capacidad;              /* ranuras de la banda */
+    Caja *almacen;              /* modo flujo: copia de las cajas de cada ranura */
+    pthread_t hilo;
+    int rc;
+} Banda;
+
+/* Ranuras extra del anillo en modo flujo: la caja que entra casi nunca
+   espera a que el ultimo brazo de la anterior termine (en_uso), y cubren el
+   paso en que un robot decide sobre una caja que acaba de salir (robot.h) */
+#define HOLGURA_RANURAS 4
 
 /* Prototipos */
-EstadoSistema *recibir_estado(int sock, int *robots_maximos);
-int recv_all(int sock, void *buffer, size_t length);
+EstadoSistema *recibir_estado(int sock, int *robots_maximos, int *flujo);
+int alimentar_banda_flujo(int sock, RelojBanda *reloj, Llegadas *llegadas, float velocidad);
+
+/* Llegadas de cajas (llegadas.h) */
+int preparar_llegadas(Llegadas *ll, const char *spec, EstadoSistema *estado, int robots_maximos,
+                      unsigned int semilla, int dinamicas);
+void esperar_llegada(Llegadas *ll, double minima, double *t0, double *anterior, HistogramaJitter *jitter);
 
 /* Robot/caja */
-void inicializar_robots(double T_ventana, SistemaRobot *sistemarobot, int size, int num_cajas);
-int activar_robot(RobotInfo *robotinfo);
+int inicializar_robots(double T_ventana, SistemaRobot *sistemarobot, int size, unsigned int semilla);
+int preparar_reserva(RobotInfo *robotinfo);
 void *rutina_robot(void *arg);
 
-/* Caja en banda */
-void *mover_caja(void *arg);
+/* Resultado de paso_robot */
+#define PASO_MOVER   0   /* mango reservado: esperar mov_t y volver a llamar */
+#define PASO_SEGUIR  1   /* perdio la reserva: volver a buscar enseguida */
+#define PASO_ESPERAR 2   /* nada que hacer con esta version de su cola */
+#define PASO_QUIETO  3   /* daniado o sin ventana: esperar un aviso */
+#define PASO_SALIR   4
+int paso_robot(RobotInfo *r, long *lista);
+void terminar_movimiento(RobotInfo *r);
+void esperar_robot(RobotInfo *r);
+
+/* Modo pool */
+void encolar_si_quieto(RobotInfo *r);
+int estacionar_robot(RobotInfo *r, long avisos, int mirar_cola);
+void correr_robot_pool(void *elemento, int hilo);
+void esperar_robots_quietos(SistemaRobot *sistema);
+
+/* Caja en banda / reloj de banda */
+int iniciar_reloj_banda(RelojBanda *reloj, SistemaRobot *sistema, CajaEnBanda *cajas, int capacidad,
+                       Caja *almacen, double T_ventana, int num_ventanas);
+void destruir_reloj_banda(RelojBanda *reloj);
+int ingresar_caja(RelojBanda *reloj, Caja *caja);
+void cerrar_banda(RelojBanda *reloj);
+void *hilo_reloj_banda(void *arg);
+void actualizar_ventana(RelojBanda *reloj, CajaEnBanda *c, long numero, int ventana);
+int mover_caja(CajaEnBanda *cajaenbanda, double ahora);
 float get_tiempo_caja(CajaEnBanda *cajaenbanda);
 int is_caja_activa(CajaEnBanda *cajaenbanda);
 void desactivar_caja(CajaEnBanda *cajaenbanda);
 
-/* Fallas / redundancia */
-int robot_falla_tick(double prob_per_s);
-void manejar_falla(int id);
-void recuperar_robot(int id);
+/* Latido con el escaner */
+void iniciar_latido(SistemaRobot *sistema, int sock);
+void *hilo_latido(void *arg);
+int atender_latido(SistemaRobot *sistema, int sock, const uint8_t *carga, uint32_t len);
+void terminar_latido(SistemaRobot *sistema, int sock);
 
-/* Util */
-static double distancia_2d(double x1, double y1, double x2, double y2);
+/* Fallas / redundancia (reemplazos y reparaciones en supervisor.c) */
+int robot_falla_tick(double prob_per_s, unsigned int *semilla);
+void manejar_falla(RobotInfo *r);
+
+/* Bandas (-N) */
+int conectar_banda(Banda *banda);
+int correr_banda(Banda *banda);
+void *hilo_banda(void *arg);
+void resumir_banda(Banda *banda);
+void liberar_banda(Banda *banda);
+
+/* Modo simulacion (tiempo virtual) */
+int correr_simulacion(EstadoSistema *estado, int robots_maximos, unsigned int semilla, int dinamicas,
+                      const Llegadas *llegadas);
 
 /* ---------------------------- MAIN ---------------------------- */
-int main(){
-    int sockfd;
-    struct sockaddr_in client_address;
-    int len;
-    int result;
-    char ch;
-    int robots_maximos;
-    EstadoSistema *estado;
-    SistemaRobot sistemaRobot;
+int main(int argc, char *argv[]){
+    OpcionesRobot op;
+    int flag_S = 0; // si 1 simula en tiempo virtual en vez de tiempo real
+    const char *destino_metricas = NULL; // -M: puerto TCP local o ruta de socket Unix
+    const char *bitacora_bin = NULL; // -B: bitacora binaria en este archivo (si no, texto en stdout)
+    int nivel_bitacora = BIT_INFO;   // -L debug|info|aviso|error|nada
+    ParamsMonteCarlo mc;             // -X: analisis de fallas sobre muchas semillas (con -S)
+    const char *lista_reservas = "0,1,2,3";   // -r: reservas que se comparan con -X
+
+    memset(&op, 0, sizeof(op));
+    op.semilla = (unsigned int)time(NULL);
+    op.hilos_pool = -1;
+    op.bandas = 1;
+    memset(&mc, 0, sizeof(mc));
+
+    // -S: simulacion por eventos discretos; -s <semilla>: semilla de la simulacion
+    //     (en tiempo real: de las fallas, reparaciones y llegadas poisson)
+    // -R <archivo>: reproducir un snapshot grabado con escaner -G
+    // -M <puerto|ruta>: servir metricas por robot (formato Prometheus)
+    // -L <nivel>, -B <archivo>: nivel minimo y salida binaria de la bitacora
+    // -P <hilos>: robots como maquinas de estado en un pool fijo con robo de trabajo
+    // -D: ventanas dinamicas (las vecinas cubren a un robot sin reemplazo)
+    // -A fija:<s>|poisson:<s>|traza:<archivo>|max: llegadas de cajas (def. una cada ceil(T_ventana))
+    // -N <bandas>: bandas en este proceso, cada una con su conexion y sus nucleos (afinidad.h)
+    // -T <prioridad>: SCHED_FIFO (1..99) para el reloj, el supervisor, los robots y las llegadas
+    // -X <corridas>, -r <reservas>: con -S, Monte Carlo de fallas por cantidad de reservas (montecarlo.h)
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-S") == 0) flag_S = 1;
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) op.semilla = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc) op.snapshot = argv[++i];
+        else if (strcmp(argv[i], "-M") == 0 && i + 1 < argc) destino_metricas = argv[++i];
+        else if (strcmp(argv[i], "-B") == 0 && i + 1 < argc) bitacora_bin = argv[++i];
+        else if (strcmp(argv[i], "-P") == 0 && i + 1 < argc) op.hilos_pool = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-D") == 0) op.dinamicas = 1;
+        else if (strcmp(argv[i], "-A") == 0 && i + 1 < argc) op.spec_llegadas = argv[++i];
+        else if (strcmp(argv[i], "-N") == 0 && i + 1 < argc) op.bandas = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc) op.prioridad_rt = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-X") == 0 && i + 1 < argc) mc.corridas = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) lista_reservas = argv[++i];
+        else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc) {
+            nivel_bitacora = bitacora_nivel(argv[++i]);
+            if (nivel_bitacora < 0) {
+                fprintf(stderr, "Nivel de bitacora invalido: %s (debug|info|aviso|error|nada)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    if (op.bandas < 1 || (flag_S && op.bandas > 1)) {
+        fprintf(stderr, "-N necesita al menos una banda, y -S corre una sola\n");
+        exit(EXIT_FAILURE);
+    }
+    if (mc.corridas > 0 && (!flag_S || op.dinamicas || parsear_reservas(&mc, lista_reservas) != 0)) {
+        fprintf(stderr, "-X va con -S y sin -D; -r espera reservas separadas por comas (0,1,2,3)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (bitacora_iniciar(bitacora_bin, nivel_bitacora) != 0) exit(EXIT_FAILURE);
+
+    Banda *bandas = calloc((size_t)op.bandas, sizeof(Banda));
+    if (!bandas) {
+        perror("calloc(bandas)");
+        exit(EXIT_FAILURE);
+    }
+    for (int b = 0; b < op.bandas; b++) {
+        bandas[b].op = &op;
+        bandas[b].sistema.banda = b;
+        bandas[b].sistema.sock_latido = -1;
+        bandas[b].sockfd = -1;
+    }
+
+    if (flag_S) {
+        Banda *banda = &bandas[0];
+        if (conectar_banda(banda) != 0) exit(EXIT_FAILURE);
+        if (banda->flujo) {
+            fprintf(stderr, "El modo -S necesita el estado completo (escaner sin -F)\n");
+            liberar_estado(banda->estado);
+            close(banda->sockfd);
+            exit(EXIT_FAILURE);
+        }
+        Llegadas llegadas;
+        if (preparar_llegadas(&llegadas, op.spec_llegadas, banda->estado, banda->robots_maximos, op.semilla,
+                              op.dinamicas) != 0) {
+            if (op.snapshot) cerrar_snapshot(banda->estado);
+            else liberar_estado(banda->estado);
+            if (banda->sockfd >= 0) close(banda->sockfd);
+            exit(EXIT_FAILURE);
+        }
+        bitacora_vaciar();   // la simulacion escribe directo en stdout
+        /* sin -A, la separacion de siempre de simular_banda */
+        int rc;
+        if (mc.corridas > 0) {
+            mc.hilos = op.hilos_pool;
+            mc.semilla = op.semilla;
+            mc.llegadas = op.spec_llegadas ? &llegadas : NULL;
+            rc = correr_montecarlo(banda->estado, banda->robots_maximos, &mc);
+        } else {
+            rc = correr_simulacion(banda->estado, banda->robots_maximos, op.semilla, op.dinamicas,
+                                   op.spec_llegadas ? &llegadas : NULL);
+        }
+        liberar_llegadas(&llegadas);
+        /* avisar al servidor que terminamos: el primer latido se contesta con TRAMA_FIN */
+        if (banda->sockfd >= 0) {
+            terminar_latido(&banda->sistema, banda->sockfd);
+            liberar_estado(banda->estado);
+            close(banda->sockfd);
+        } else {
+            cerrar_snapshot(banda->estado);
+        }
+        free(bandas);
+        return rc == 0 ? 0 : EXIT_FAILURE;
+    }
+
+    if (iniciar_metricas(op.bandas) != 0) exit(EXIT_FAILURE);
+    /* sin endpoint la corrida sigue: solo se pierde la vista en vivo */
+    if (destino_metricas) iniciar_servidor_metricas(destino_metricas);
+
+    if (op.bandas == 1) {
+        /* una sola banda: en el hilo principal, sin tocar la afinidad */
+        bandas[0].rc = correr_banda(&bandas[0]);
+    } else {
+        for (int b = 0; b < op.bandas; b++) {
+            if (pthread_create(&bandas[b].hilo, NULL, hilo_banda, &bandas[b]) != 0) {
+                perror("pthread_create(hilo_banda)");
+                bandas[b].hilo = 0;
+                bandas[b].rc = -1;
+            }
+        }
+        for (int b = 0; b < op.bandas; b++)
+            if (bandas[b].hilo) pthread_join(bandas[b].hilo, NULL);
+    }
+    detener_servidor_metricas();
+    bitacora_cerrar();   // el resumen sale despues de todo lo registrado
+
+    int rc = 0;
+    for (int b = 0; b < op.bandas; b++) {
+        if (bandas[b].rc != 0) {
+            rc = EXIT_FAILURE;
+            continue;
+        }
+        resumir_banda(&bandas[b]);
+        liberar_banda(&bandas[b]);
+    }
+    liberar_metricas();
+    free(bandas);
+    return rc;
+}
+
+/* ------------------ bandas ------------------ */
+/* Conecta con el escaner y recibe el estado, o abre el snapshot de -R */
+int conectar_banda(Banda *banda) {
+    const OpcionesRobot *op = banda->op;
+    if (op->snapshot) {
+        /* sin escaner: el estado se mapea del archivo y no hay socket */
+        banda->sockfd = -1;
+        banda->estado = abrir_snapshot(op->snapshot, &banda->robots_maximos);
+        if (!banda->estado) return -1;
+        int total_mangos = 0;
+        for (int i = 0; i < banda->estado->num_cajas; i++) total_mangos += banda->estado->cajas[i].num_mangos;
+        printf("Snapshot %s: %d cajas, %d mangos, %d robots (max %d)\n", op->snapshot,
+               banda->estado->num_cajas, total_mangos, banda->estado->num_robots, banda->robots_maximos);
+        return 0;
+    }
 
     /* crear socket y conectar al escaner (servidor) */
-    sockfd = socket(PF_INET, SOCK_STREAM, 0);
+    int sockfd = socket(PF_INET, SOCK_STREAM, 0);
     if (sockfd < 0) {
         perror("socket()");
-        exit(EXIT_FAILURE);
+        return -1;
     }
 
+    struct sockaddr_in client_address;
     client_address.sin_family = AF_INET;
     client_address.sin_addr.s_addr = inet_addr("127.0.0.1");
     client_address.sin_port = htons(7734);
-    len = sizeof(client_address);
+    int len = sizeof(client_address);
 
-    result = connect(sockfd, (struct sockaddr *) &client_address, len);
+    int result = connect(sockfd, (struct sockaddr *) &client_address, len);
     if (result < 0) {
         perror("connect()");
         close(sockfd);
-        exit(EXIT_FAILURE);
+        return -1;
     }
 
-    estado = recibir_estado(sockfd, &robots_maximos);
+    EstadoSistema *estado = recibir_estado(sockfd, &banda->robots_maximos, &banda->flujo);
     if (!estado) {
         fprintf(stderr, "Error recibiendo estado del servidor\n");
         close(sockfd);
-        exit(EXIT_FAILURE);
+        return -1;
     }
+    banda->sockfd = sockfd;
+    banda->estado = estado;
 
     /* Mostrar lo recibido */
     for (int i = 0; i < estado->num_cajas; i++) {
         Caja *caja = &estado->cajas[i];
-        printf("\nCaja #%d (Area %.2f cm^2, %d mangos)\n", caja->id, caja->area_caja, caja->num_mangos);
+        bit_info("Caja #%d (Area %.2f cm^2, %d mangos)", caja->id, caja->area_caja, caja->num_mangos);
         for (int j = 0; j < caja->num_mangos; j++) {
             Mango *m = &caja->mangos[j];
-            printf(" Mango %2d | area %.1f cm^2 | pos (%.2f, %.2f)\n",
+            bit_info(" Mango %2d | area %.1f cm^2 | pos (%.2f, %.2f)",
                    m->id, m->area, m->x, m->y);
         }
     }
+    return 0;
+}
+
+/* Hilo de una banda con -N: primero se fija a sus nucleos, asi todo lo que
+   la banda reserva y toca queda en su nodo y sus hilos heredan la afinidad */
+void *hilo_banda(void *arg) {
+    Banda *banda = (Banda *)arg;
+    char desc[96];
+    fijar_afinidad_banda(banda->sistema.banda, banda->op->bandas, desc, sizeof(desc));
+    printf("Banda %d: %s\n", banda->sistema.banda, desc);
+    banda->rc = correr_banda(banda);
+    return NULL;
+}
+
+/* Deshace lo que correr_banda llego a armar cuando algo falla antes de
+   arrancar los robots. Con -N la banda corre en su hilo: las demas siguen. */
+static int abortar_banda(Banda *banda, Llegadas *llegadas) {
+    SistemaRobot *sistema = &banda->sistema;
+    if (sistema->pool) {
+        destruir_planificador(sistema->pool);
+        sistema->pool = NULL;
+    }
+    free(sistema->listas);
+    sistema->listas = NULL;
+    detener_supervisor(sistema->supervisor);
+    if (banda->reloj.ventanas) {
+        /* sin cajas el reloj termina apenas ve la banda cerrada */
+        cerrar_banda(&banda->reloj);
+        pthread_join(banda->reloj.thread, NULL);
+        destruir_reloj_banda(&banda->reloj);
+    }
+    liberar_llegadas(llegadas);
+    liberar_banda(banda);
+    return -1;
+}
+
+/* Corre una banda completa en tiempo real: alimenta las cajas y espera a que
+   salgan y a que terminen sus robots. Deja el resumen para resumir_banda. */
+int correr_banda(Banda *banda) {
+    const OpcionesRobot *op = banda->op;
+    SistemaRobot *sistema = &banda->sistema;
+    if (conectar_banda(banda) != 0) return -1;
+    EstadoSistema *estado = banda->estado;
+    int sockfd = banda->sockfd;
+    int robots_maximos = banda->robots_maximos;
+    int flujo = banda->flujo;
+
+    if (flujo && op->spec_llegadas && strcmp(op->spec_llegadas, "max") == 0) {
+        fprintf(stderr, "-A max necesita el estado completo (escaner sin -F)\n");
+        liberar_estado(estado);
+        close(sockfd);
+        return -1;
+    }
+    /* cada banda con su propia corriente de azar: con -N las bandas no repiten
+       las mismas llegadas, fallas y reparaciones aunque reciban el mismo estado */
+    uint64_t z = mezclar_semilla(((uint64_t)op->semilla << 32) | (uint32_t)sistema->banda);
+    unsigned int semilla = (unsigned int)z;
+    Llegadas llegadas;
+    if (preparar_llegadas(&llegadas, op->spec_llegadas, estado, robots_maximos, (unsigned int)(z >> 32),
+                          op->dinamicas) != 0) {
+        if (op->snapshot) cerrar_snapshot(estado);
+        else liberar_estado(estado);
+        if (sockfd >= 0) close(sockfd);
+        return -1;
+    }
 
     double tiempo_maximo = estado->longitud_banda / estado->velocidad_banda;
     double T_ventana = tiempo_maximo / (double)robots_maximos;
+    char desc[96];
+    describir_llegadas(&llegadas, desc, sizeof(desc));
+    printf("Llegadas: %s\n", desc);
+
+    /* ranuras de la banda: todas las cajas, o en modo flujo solo las que caben
+       a la vez en la banda (la memoria no crece con el largo de la corrida).
+       Si una rafaga llena el anillo, la caja espera su ranura en ingresar_caja */
+    int capacidad = estado->num_cajas;
+    if (flujo) {
+        double sep_min = llegadas_separacion_min(&llegadas);
+        capacidad = (int)ceil(tiempo_maximo / (sep_min > DT_SECS ? sep_min : DT_SECS)) + 1 + HOLGURA_RANURAS;
+    }
 
     /* reservar estructuras locales */
-    CajaEnBanda *cajas_en_banda = calloc(estado->num_cajas, sizeof(CajaEnBanda));
+    CajaEnBanda *cajas_en_banda = calloc(capacidad, sizeof(CajaEnBanda));
     RobotInfo *robots_infos = calloc(robots_maximos, sizeof(RobotInfo));
-    if (!cajas_en_banda || !robots_infos) {
+    Caja *almacen = flujo ? calloc(capacidad, sizeof(Caja)) : NULL;
+    /* desde aca liberar_banda (via abortar_banda) suelta lo que haya */
+    sistema->robotsinfos = robots_infos;
+    sistema->cajasenbanda = cajas_en_banda;
+    banda->almacen = almacen;
+    if (!cajas_en_banda || !robots_infos || (flujo && !almacen)) {
         perror("calloc");
-        close(sockfd);
-        exit(EXIT_FAILURE);
+        return abortar_banda(banda, &llegadas);
     }
+    banda->capacidad = capacidad;
 
-    sistemaRobot.robotsinfos = robots_infos;
-    sistemaRobot.cajasenbanda = cajas_en_banda;
-    sistemaRobot.robotsactivos = 0;
+    /* inicializar ranuras; un unico reloj de banda mueve todas las cajas */
+    for (int i = 0; i < capacidad; i++) {
+        cajas_en_banda[i].caja = NULL;
+        cajas_en_banda[i].activa = 0;
+        cajas_en_banda[i].en_uso = 0;
+        cajas_en_banda[i].tiempo = 0.0f;
+        cajas_en_banda[i].tiempo_max = (int)ceil(tiempo_maximo);
+        cajas_en_banda[i].ventana = -1;
+    }
+    /* el jitter se mide desde el primer plazo del reloj (sin memoria, sin medir) */
+    sistema->jitter = metricas_jitter(sistema->banda);
+    sistema->prioridad_rt = op->prioridad_rt;
+    RelojBanda *reloj = &banda->reloj;
+    if (iniciar_reloj_banda(reloj, sistema, cajas_en_banda, capacidad, almacen, T_ventana, robots_maximos) != 0) {
+        reloj->ventanas = NULL;   /* ya liberado: abortar_banda no lo toca */
+        return abortar_banda(banda, &llegadas);
+    }
 
-    /* inicializar robots y cajas */
-    g_num_cajas = estado->num_cajas;
-    inicializar_robots(T_ventana, &sistemaRobot, robots_maximos, estado->num_cajas);
+    sistema->reloj = reloj;
+    sistema->robotsactivos = 0;
+
+    /* inicializar robots */
+    if (inicializar_robots(T_ventana, sistema, robots_maximos, semilla) != 0) return abortar_banda(banda, &llegadas);
+    sistema->supervisor = iniciar_supervisor(sistema, robots_maximos, semilla, op->dinamicas);
+    if (!sistema->supervisor) return abortar_banda(banda, &llegadas);
+    if (op->hilos_pool >= 0) {
+        atomic_init(&sistema->esperando_quietos, 0);
+        pthread_mutex_init(&sistema->lock_quietos, NULL);
+        pthread_cond_init(&sistema->quietos, NULL);
+        sistema->pool = crear_planificador(op->hilos_pool, robots_maximos, correr_robot_pool);
+        if (sistema->pool) {
+            sistema->listas = malloc(sizeof(long) * (size_t)capacidad * (size_t)planificador_hilos(sistema->pool));
+        }
+        if (!sistema->pool || !sistema->listas) {
+            fprintf(stderr, "No se pudo crear el pool de robots\n");
+            return abortar_banda(banda, &llegadas);
+        }
+        printf("Modo pool: %d robots en %d hilos\n", robots_maximos, planificador_hilos(sistema->pool));
+    }
 
-    /* activar los num_robots que saca el escaner (estado->num_robots) */
+    /* activar los num_robots que saca el escaner (estado->num_robots);
+       el resto queda de reserva para cubrir fallas */
     for (int i = 0; i < estado->num_robots && i < robots_maximos; i++) {
         if (activar_robot(&robots_infos[i]) == 0) {
-            sistemaRobot.robotsactivos += 1;
+            sistema->robotsactivos += 1;
         }
     }
+    for (int i = estado->num_robots; i < robots_maximos; i++) preparar_reserva(&robots_infos[i]);
 
-    /* inicializar cajas en banda y lanzar un hilo por caja */
-    for (int i = 0; i < estado->num_cajas; i++) {
-        cajas_en_banda[i].caja = &estado->cajas[i];
-        cajas_en_banda[i].activa = 1;
-        cajas_en_banda[i].tiempo = 0.0f;
-        cajas_en_banda[i].tiempo_max = (int)ceil(tiempo_maximo);
-        pthread_mutex_init(&cajas_en_banda[i].lock, NULL);
-        if (pthread_create(&cajas_en_banda[i].thread, NULL, mover_caja, &cajas_en_banda[i]) != 0) {
-            perror("pthread_create(mover_caja)");
-        }
-        /* esperar un poco entre cajas para que no choquen en rango (como t hacas) */
-        sleep((unsigned int)ceil(T_ventana));
+    /* el que alimenta la banda tambien espera plazos (llegadas) */
+    int err = fijar_tiempo_real(op->prioridad_rt);
+    if (err != 0) {
+        fprintf(stderr, "Sin SCHED_FIFO (prioridad %d): %s; se sigue con SCHED_OTHER\n",
+                op->prioridad_rt, strerror(err));
     }
 
-    /* Esperar seal del servidor (como en tu cdigo) */
-    read(sockfd, &robots_maximos, sizeof(int));
-    ch = 'X';
-    write(sockfd, &ch, 1);
-
-    /* Esperar que los hilos terminen (opcional) */
-    for (int i = 0; i < estado->num_cajas; i++) {
-        pthread_join(cajas_en_banda[i].thread, NULL);
+    /* el latido llega despues del estado (en modo flujo, despues de la
+       ultima caja): lo atiende su propio hilo */
+    if (flujo) {
+        /* cada caja entra a la banda apenas llega del escaner */
+        alimentar_banda_flujo(sockfd, reloj, &llegadas, estado->velocidad_banda);
+        iniciar_latido(sistema, sockfd);
+    } else {
+        if (sockfd >= 0) iniciar_latido(sistema, sockfd);
+        double t0 = 0.0, anterior = 0.0;
+        for (int i = 0; i < estado->num_cajas; i++) {
+            /* cada caja a su instante de llegada, sin montarse sobre la anterior */
+            double minima = i > 0 ? separacion_fisica(&estado->cajas[i - 1], estado->velocidad_banda) : 0.0;
+            esperar_llegada(&llegadas, minima, &t0, &anterior, sistema->jitter);
+            ingresar_caja(reloj, &estado->cajas[i]);
+        }
     }
-    /* indicar a robots que finalicen (si quieres) */
-    for (int i = 0; i < g_robots_maximos; i++) {
+    liberar_llegadas(&llegadas);
+    cerrar_banda(reloj);
+
+    /* Esperar que todas las cajas salgan de la banda; hasta ahi el escaner
+       sigue viendo las metricas. Despues, avisarle que terminamos */
+    pthread_join(reloj->thread, NULL);
+    if (sockfd >= 0) terminar_latido(sistema, sockfd);
+    /* sin mas reemplazos ni reparaciones; indicar a robots que finalicen
+       (tambien a reservas y daniados); los que esperan se despiertan */
+    supervisor_cerrar(sistema->supervisor);
+    for (int i = 0; i < robots_maximos; i++) {
         pthread_mutex_lock(&robots_infos[i].lock);
         robots_infos[i].activo = 0;
         robots_infos[i].es_reemplazo = 0;
+        robots_infos[i].reserva = 0;
+        robots_infos[i].daniado = 0;
         pthread_mutex_unlock(&robots_infos[i].lock);
+        avisar_robot(sistema, i);
     }
-    for (int i = 0; i < g_robots_maximos; i++) {
-        if (robots_infos[i].thread) pthread_join(robots_infos[i].thread, NULL);
+    if (sistema->pool) {
+        /* los brazos en camino terminan con la rueda del supervisor */
+        esperar_robots_quietos(sistema);
+    } else {
+        for (int i = 0; i < robots_maximos; i++) {
+            if (robots_infos[i].thread) pthread_join(robots_infos[i].thread, NULL);
+        }
     }
-
-    /* limpieza */
-    for (int i = 0; i < estado->num_cajas; i++) {
-        free(estado->cajas[i].mangos);
+    detener_supervisor(sistema->supervisor);
+    if (sistema->pool) {
+        destruir_planificador(sistema->pool);
+        sistema->pool = NULL;
+        free(sistema->listas);
+        sistema->listas = NULL;
+        pthread_cond_destroy(&sistema->quietos);
+        pthread_mutex_destroy(&sistema->lock_quietos);
     }
-    free(estado->cajas);
-    free(estado);
-    free(cajas_en_banda);
-    free(robots_infos);
-
-    close(sockfd);
+    destruir_reloj_banda(reloj);
     return 0;
 }
 
-/* ------------------ recibir_estado / recv_all ------------------ */
-EstadoSistema *recibir_estado(int sock, int *robots_maximos) {
-    float f;
-    int32_t i32;
-
-    EstadoSistema *estado = malloc(sizeof(EstadoSistema));
-    if (!estado) return NULL;
-    memset(estado, 0, sizeof(*estado));
-
-    if (recv_all(sock, &f, sizeof(f)) < 0) goto fail;
-    estado->velocidad_banda = (double) f;
-
-    if (recv_all(sock, &f, sizeof(f)) < 0) goto fail;
-    estado->longitud_banda = (double) f;
-
-    if (recv_all(sock, &i32, sizeof(i32)) < 0) goto fail;
-    estado->num_robots = (int) i32;
-
-    if (recv_all(sock, &i32, sizeof(i32)) < 0) goto fail;
-    estado->num_cajas = (int) i32;
-
-    /* robots_maximos enviados por servidor */
-    if (recv(sock, robots_maximos, sizeof(int), 0) <= 0) goto fail;
-
-    if (estado->num_cajas <= 0) goto fail;
-    estado->cajas = malloc(sizeof(Caja) * (size_t)estado->num_cajas);
-    if (!estado->cajas) goto fail;
-
-    for (int c = 0; c < estado->num_cajas; ++c) {
-        Caja *caja = &estado->cajas[c];
-        memset(caja, 0, sizeof(*caja));
-
-        if (recv_all(sock, &i32, sizeof(i32)) < 0) goto fail;
-        caja->id = (int) i32;
-
-        if (recv_all(sock, &f, sizeof(f)) < 0) goto fail;
-        caja->area_caja = f;
+/* Resumen por robot y del failover; con -N, uno por banda */
+void resumir_banda(Banda *banda) {
+    SistemaRobot *sistema = &banda->sistema;
+    if (banda->op->bandas > 1) printf("\n=== RESUMEN ROBOTS (banda %d) ===\n", sistema->banda);
+    else printf("\n=== RESUMEN ROBOTS ===\n");
+    for (int i = 0; i < sistema->robots_maximos; i++) {
+        MetricasRobot *m = sistema->robotsinfos[i].metricas;
+        double seg[NUM_ESTADOS_ROBOT];
+        metrica_segundos(m, seg, NULL);
+        printf("Robot %d: %lu mangos etiquetados | intentos duplicados: %lu | sin tiempo: %lu | "
+               "ocupado %.1fs, ocioso %.1fs, daniado %.1fs | fallas %lu, reemplazos %lu\n",
+               i, atomic_load(&m->etiquetas), atomic_load(&m->intentos_duplicados),
+               atomic_load(&m->sin_tiempo), seg[ROBOT_OCUPADO], seg[ROBOT_OCIOSO],
+               seg[ROBOT_DANIADO], atomic_load(&m->fallas), atomic_load(&m->reemplazos));
+    }
+    imprimir_failover(sistema->supervisor, stdout);
+    imprimir_jitter(sistema->jitter, stdout);
+}
 
-        if (recv_all(sock, &i32, sizeof(i32)) < 0) goto fail;
-        caja->num_mangos = (int) i32;
+void liberar_banda(Banda *banda) {
+    SistemaRobot *sistema = &banda->sistema;
+    liberar_supervisor(sistema->supervisor);
+    sistema->supervisor = NULL;
+    if (banda->almacen) {
+        for (int i = 0; i < banda->capacidad; i++) {
+            free(banda->almacen[i].mangos);
+            free(banda->almacen[i].ruta);
+        }
+        free(banda->almacen);
+    }
+    if (banda->op->snapshot) cerrar_snapshot(banda->estado);
+    else liberar_estado(banda->estado);
+    for (int i = 0; i < banda->capacidad; i++) liberar_indice(&sistema->cajasenbanda[i].indice);
+    free(sistema->cajasenbanda);
+    free(sistema->robotsinfos);
+    if (banda->sockfd >= 0) close(banda->sockfd);
+}
 
-        if (caja->num_mangos < 0) goto fail;
-        caja->mangos = malloc(sizeof(Mango) * (size_t)caja->num_mangos);
-        if (!caja->mangos) goto fail;
+/* ------------------ recibir_estado ------------------ */
+/* Lee la primera trama (ver protocolo.h) y la decodifica desde el buffer, en
+   vez de un recv por campo. Con TRAMA_ESTADO llega el estado completo; con
+   TRAMA_CONFIG solo los parametros (*flujo = 1, cajas = NULL) y las cajas
+   llegan despues con alimentar_banda_flujo. */
+EstadoSistema *recibir_estado(int sock, int *robots_maximos, int *flujo) {
+    uint16_t tipo;
+    uint8_t *carga = NULL;
+    uint32_t len = 0;
+    EstadoSistema *estado = NULL;
+
+    if (leer_trama(sock, &tipo, &carga, &len) < 0) return NULL;
+    *flujo = 0;
+    if (tipo == TRAMA_ESTADO) {
+        estado = deserializar_estado(carga, len, robots_maximos);
+    } else if (tipo == TRAMA_CONFIG) {
+        estado = calloc(1, sizeof(EstadoSistema));
+        if (estado && deserializar_config(carga, len, estado, robots_maximos) != 0) {
+            free(estado);
+            estado = NULL;
+        }
+        /* num_cajas queda en 0: las cajas no son de este estado */
+        if (estado) {
+            printf("Modo flujo: %d cajas anunciadas (0 = sin fin)\n", estado->num_cajas);
+            estado->num_cajas = 0;
+            *flujo = 1;
+        }
+    } else {
+        fprintf(stderr, "Se esperaba TRAMA_ESTADO o TRAMA_CONFIG y llego tipo %u\n", tipo);
+    }
+    free(carga);
+    return estado;
+}
 
-        for (int m = 0; m < caja->num_mangos; ++m) {
-            Mango *mg = &caja->mangos[m];
+/* ------------------ alimentar_banda_flujo ------------------ */
+/* Pone en la banda cada TRAMA_CAJA apenas llega y no antes de su instante de
+   llegada, hasta TRAMA_FIN o hasta que el escaner cierre la conexion. */
+int alimentar_banda_flujo(int sock, RelojBanda *reloj, Llegadas *llegadas, float velocidad) {
+    double t0 = 0.0, anterior = 0.0, minima = 0.0;
+    while (1) {
+        uint16_t tipo;
+        uint8_t *carga = NULL;
+        uint32_t len = 0;
+
+        if (leer_trama(sock, &tipo, &carga, &len) < 0) return -1;
+        if (tipo == TRAMA_FIN) {
+            free(carga);
+            return 0;
+        }
+        if (tipo != TRAMA_CAJA) {
+            fprintf(stderr, "Trama inesperada en modo flujo: %u\n", tipo);
+            free(carga);
+            return -1;
+        }
 
-            if (recv_all(sock, &i32, sizeof(i32)) < 0) goto fail;
-            mg->id = (int) i32;
+        Caja caja;
+        int rc = deserializar_caja(carga, len, &caja);
+        free(carga);
+        if (rc != 0) return -1;
+
+        esperar_llegada(llegadas, minima, &t0, &anterior, reloj->sistema->jitter);
+        minima = separacion_fisica(&caja, velocidad);
+        if (ingresar_caja(reloj, &caja) != 0) {
+            free(caja.mangos);
+            free(caja.ruta);
+            return -1;
+        }
+    }
+}
 
-            if (recv_all(sock, &f, sizeof(f)) < 0) goto fail;
-            mg->x = f;
+/* ------------------ llegadas de cajas ------------------ */
+/* Arma el proceso de llegadas de -A. Sin -A, una caja cada ceil(T_ventana);
+   con "max", la separacion fija mas corta que la simulacion (con estos robots,
+   fallas y semilla) da por sostenible. */
+int preparar_llegadas(Llegadas *ll, const char *spec, EstadoSistema *estado, int robots_maximos,
+                      unsigned int semilla, int dinamicas) {
+    double tiempo_maximo = estado->longitud_banda / estado->velocidad_banda;
+    if (!spec) {
+        iniciar_llegadas_fija(ll, ceil(tiempo_maximo / (double)robots_maximos));
+        return 0;
+    }
+    if (strcmp(spec, "max") != 0) {
+        if (parsear_llegadas(ll, spec, semilla) != 0) {
+            fprintf(stderr, "Llegadas invalidas: %s (fija:<s>|poisson:<s>|traza:<archivo>|max)\n", spec);
+            return -1;
+        }
+        return 0;
+    }
 
-            if (recv_all(sock, &f, sizeof(f)) < 0) goto fail;
-            mg->y = f;
+    ParamsSimulacion p;
+    params_simulacion_default(&p, estado, robots_maximos);
+    p.semilla = semilla;
+    p.ventanas_dinamicas = dinamicas;
+    double base = 0.0;
+    double sep = separacion_sostenible(estado, &p, &base);
+    if (sep < 0.0) {
+        fprintf(stderr, "No se pudo calcular la tasa maxima sostenible\n");
+        return -1;
+    }
+    iniciar_llegadas_fija(ll, sep);
+    if (sep > 0.0)
+        printf("Tasa maxima sostenible: %.3f cajas/s (una cada %.3f s; %.1f%% etiquetado con la banda vacia)\n",
+               1.0 / sep, sep, 100.0 * base);
+    else
+        printf("Tasa maxima sostenible: cajas pegadas (%.1f%% etiquetado con la banda vacia)\n", 100.0 * base);
+    return 0;
+}
 
-            if (recv_all(sock, &f, sizeof(f)) < 0) goto fail;
-            mg->area = f;
+/* Duerme hasta la llegada de la proxima caja. Los instantes de ll se cuentan
+   desde la primera caja (*t0, en reloj_ahora) con plazos absolutos: el tiempo
+   que lleva ingresar cada caja no se acumula. Una caja atrasada (modo flujo)
+   entra enseguida, pero no a menos de `minima` de la anterior (*anterior).
+   El retraso respecto del plazo va a jitter (JITTER_LLEGADA). */
+void esperar_llegada(Llegadas *ll, double minima, double *t0, double *anterior, HistogramaJitter *jitter) {
+    int primera = ll->siguiente == 0;
+    double t = proxima_llegada(ll, minima);
+    if (primera) {
+        *t0 = reloj_ahora();
+        *anterior = *t0;
+        return;
+    }
+    double plazo = *t0 + t;
+    if (plazo < *anterior + minima) plazo = *anterior + minima;
+    struct timespec ts;
+    ts.tv_sec = (time_t)plazo;
+    ts.tv_nsec = (long)((plazo - (double)ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+    *anterior = reloj_ahora();
+    jitter_anotar(jitter, JITTER_LLEGADA, plazo, *anterior);
+}
 
-            if (recv_all(sock, &i32, sizeof(i32)) < 0) goto fail;
-            mg->etiquetado = (int) i32;
-        }
+/* ------------------ latido con el escaner ------------------ */
+/* Metricas de la celda para la respuesta al latido. La utilizacion es la del
+   intervalo desde el latido anterior (solo la llama quien lee el socket). */
+static void medir_celda(SistemaRobot *sistema, MetricasCelda *m) {
+    RelojBanda *reloj = sistema->reloj;
+    int activos = 0;
+    for (int k = 0; k < reloj->num_ventanas; k++)
+        activos += atomic_load(&reloj->ventanas[k].robot) >= 0;
+    double ocupado = 0.0, total = 0.0;
+    for (int i = 0; i < sistema->robots_maximos; i++) {
+        double seg[NUM_ESTADOS_ROBOT];
+        metrica_segundos(sistema->robotsinfos[i].metricas, seg, NULL);
+        ocupado += seg[ROBOT_OCUPADO];
+        total += seg[ROBOT_OCUPADO] + seg[ROBOT_OCIOSO];
     }
+    m->robots_activos = activos;
+    m->cajas_salidas = (int32_t)atomic_load_explicit(&reloj->salidas, memory_order_relaxed);
+    m->mangos_salidos = (int32_t)atomic_load_explicit(&reloj->mangos_salidos, memory_order_relaxed);
+    m->mangos_perdidos = (int32_t)atomic_load_explicit(&reloj->mangos_perdidos, memory_order_relaxed);
+    m->utilizacion = total > sistema->util_total
+        ? (float)((ocupado - sistema->util_ocupado) / (total - sistema->util_total)) : 0.0f;
+    sistema->util_ocupado = ocupado;
+    sistema->util_total = total;
+}
 
-    return estado;
+/* Contesta un TRAMA_LATIDO: los robots que pide el escaner van al supervisor
+   y vuelven las metricas de la celda. Si ya terminamos se contesta con
+   TRAMA_FIN y devuelve 1. */
+int atender_latido(SistemaRobot *sistema, int sock, const uint8_t *carga, uint32_t len) {
+    uint8_t trama[PROTO_METRICAS_LEN];
+    if (atomic_load(&sistema->despedir)) {
+        size_t n = serializar_cabecera(trama, TRAMA_FIN, 0);
+        return enviar_trama(sock, trama, n) == 0 ? 1 : -1;
+    }
+    int32_t robots;
+    if (deserializar_latido(carga, len, &robots) != 0) return -1;
+    supervisor_escalar(sistema->supervisor, robots);
+    MetricasCelda m;
+    medir_celda(sistema, &m);
+    size_t n = serializar_metricas(trama, &m);
+    return enviar_trama(sock, trama, n);
+}
 
-fail:
-    if (estado) {
-        if (estado->cajas) {
-            for (int j = 0; j < estado->num_cajas; ++j) {
-                if (estado->cajas[j].mangos) free(estado->cajas[j].mangos);
-            }
-            free(estado->cajas);
-        }
-        free(estado);
+/* Lee tramas hasta contestar con TRAMA_FIN o hasta que el escaner cierre */
+void *hilo_latido(void *arg) {
+    SistemaRobot *sistema = (SistemaRobot *)arg;
+    int sock = sistema->sock_latido;
+    while (1) {
+        uint16_t tipo;
+        uint8_t *carga = NULL;
+        uint32_t len = 0;
+        if (leer_trama(sock, &tipo, &carga, &len) < 0) break;
+        int rc = tipo == TRAMA_LATIDO ? atender_latido(sistema, sock, carga, len) : 0;
+        free(carga);
+        if (rc != 0) break;
     }
     return NULL;
 }
 
-int recv_all(int sock, void *buffer, size_t length) {
-    char *ptr = buffer;
-    size_t total_received = 0;
-    while (total_received < length) {
-        ssize_t rec = recv(sock, ptr + total_received, length - total_received, 0);
-        if (rec <= 0) return -1;
-        total_received += (size_t)rec;
+/* Sin hilo se pierde el control del escaner; el fin se contesta igual en
+   terminar_latido */
+void iniciar_latido(SistemaRobot *sistema, int sock) {
+    sistema->sock_latido = sock;
+    if (pthread_create(&sistema->hilo_latido, NULL, hilo_latido, sistema) != 0) {
+        perror("pthread_create(hilo_latido)");
+        sistema->sock_latido = -1;
     }
-    return 0;
+}
+
+void terminar_latido(SistemaRobot *sistema, int sock) {
+    atomic_store(&sistema->despedir, 1);
+    if (sistema->sock_latido >= 0) {
+        pthread_join(sistema->hilo_latido, NULL);
+    } else {
+        sistema->sock_latido = sock;
+        hilo_latido(sistema);
+    }
+    sistema->sock_latido = -1;
 }
 
 /* ------------------ inicializar_robots ------------------ */
-void inicializar_robots(double T_ventana, SistemaRobot *sistemarobot, int size, int num_cajas) {
-    g_robots_infos = sistemarobot->robotsinfos;
-    g_robots_maximos = size;
-    g_sistema = sistemarobot;
-    g_num_cajas = num_cajas;
+/* La semilla de fallas de cada robot sale de mezclar la semilla recibida con
+   su id, asi -s repite tambien las fallas en tiempo real. */
+int inicializar_robots(double T_ventana, SistemaRobot *sistemarobot, int size, unsigned int semilla) {
+    /* contadores de la banda desde su hilo: quedan en su nodo */
+    MetricasRobot *metricas = metricas_banda(sistemarobot->banda, size);
+    if (!metricas) return -1;
+    sistemarobot->robots_maximos = size;
 
     for (int i = 0; i < size; i++) {
         sistemarobot->robotsinfos[i].id = i;
@@ -284,320 +807,819 @@ void inicializar_robots(double T_ventana, SistemaRobot *sistemarobot, int size,
         sistemarobot->robotsinfos[i].activo = 0;
         sistemarobot->robotsinfos[i].daniado = 0;
         sistemarobot->robotsinfos[i].es_reemplazo = 0;
-        sistemarobot->robotsinfos[i].mangos_etiquetados = 0;
+        sistemarobot->robotsinfos[i].reserva = 0;
+        sistemarobot->robotsinfos[i].titular = 0;
+        sistemarobot->robotsinfos[i].ventana = -1;
+        sistemarobot->robotsinfos[i].t_toma = 0.0;
+        sistemarobot->robotsinfos[i].esperando_en = -1;
+        sistemarobot->robotsinfos[i].metricas = &metricas[i];
+        sistemarobot->robotsinfos[i].sistema = sistemarobot;
+        sistemarobot->robotsinfos[i].reservado = NULL;
+        atomic_init(&sistemarobot->robotsinfos[i].planificado, 0);
+        atomic_init(&sistemarobot->robotsinfos[i].avisos, 0);
+        /* estado inicial de la maquina de pasos */
+        sistemarobot->robotsinfos[i].semilla =
+            (unsigned int)mezclar_semilla(((uint64_t)semilla << 32) | (uint32_t)i);
+        sistemarobot->robotsinfos[i].arm_x = 0.0;
+        sistemarobot->robotsinfos[i].arm_y = 0.0;
+        sistemarobot->robotsinfos[i].ultimo_mango = -1;
+        sistemarobot->robotsinfos[i].id_caja_actual = -1;
+        sistemarobot->robotsinfos[i].ventana_vista = -1;
+        sistemarobot->robotsinfos[i].agotada = -1;
+        sistemarobot->robotsinfos[i].mov_banda = NULL;
+        sistemarobot->robotsinfos[i].mov_caja = NULL;
         pthread_mutex_init(&sistemarobot->robotsinfos[i].lock, NULL);
     }
+    return 0;
 }
 
 /* ------------------ activar_robot ------------------ */
+/* El titular cubre su propia ventana. En modo hilo se le crea el hilo (si
+   estaba de reserva ya lo tiene y solo se lo despierta); en modo pool solo
+   se lo encola. */
 int activar_robot(RobotInfo *robotinfo) {
     if (!robotinfo) return -1;
+    SistemaRobot *sistema = robotinfo->sistema;
+    double T = sistema->reloj->T_ventana;
     pthread_mutex_lock(&robotinfo->lock);
-    if (robotinfo->activo || robotinfo->daniado) {
+    if (robotinfo->activo || robotinfo->daniado || robotinfo->es_reemplazo) {
         pthread_mutex_unlock(&robotinfo->lock);
         return -1;
     }
+    int con_hilo = robotinfo->reserva;
+    robotinfo->reserva = 0;
     robotinfo->activo = 1;
+    robotinfo->titular = 1;
+    robotinfo->ventana = robotinfo->id;
+    /* con ventanas dinamicas el supervisor le pone despues los bordes reales */
+    robotinfo->t_start = robotinfo->id * T;
+    robotinfo->t_end = (robotinfo->id + 1) * T;
     pthread_mutex_unlock(&robotinfo->lock);
 
-    if (pthread_create(&robotinfo->thread, NULL, rutina_robot, robotinfo) != 0) {
+    ColaVentana *cola = &sistema->reloj->ventanas[robotinfo->id];
+    pthread_mutex_lock(&cola->lock);
+    atomic_store(&cola->robot, robotinfo->id);
+    pthread_mutex_unlock(&cola->lock);
+    metrica_estado(robotinfo->metricas, ROBOT_OCIOSO);
+
+    if (sistema->pool) {
+        encolar_si_quieto(robotinfo);
+    } else if (con_hilo) {
+        avisar_robot(sistema, robotinfo->id);
+    } else if (pthread_create(&robotinfo->thread, NULL, rutina_robot, robotinfo) != 0) {
         perror("pthread_create(rutina_robot)");
         pthread_mutex_lock(&robotinfo->lock);
         robotinfo->activo = 0;
+        robotinfo->titular = 0;
+        robotinfo->ventana = -1;
         pthread_mutex_unlock(&robotinfo->lock);
+        pthread_mutex_lock(&cola->lock);
+        atomic_store(&cola->robot, -1);
+        pthread_mutex_unlock(&cola->lock);
+        metrica_estado(robotinfo->metricas, ROBOT_PARADO);
         return -1;
     }
-    printf("Robot %d ACTIVADO (rango %.2f - %.2f)\n", robotinfo->id, robotinfo->t_start, robotinfo->t_end);
+    bit_info("Robot %d ACTIVADO (rango %.2f - %.2f)", robotinfo->id, robotinfo->t_start, robotinfo->t_end);
     return 0;
 }
 
-/* ------------------ mover_caja (hilo) ------------------ */
-void *mover_caja(void *arg) {
-    CajaEnBanda *c = (CajaEnBanda *)arg;
-    printf("Caja #%d entro a la banda (tiempo_max %.2f s)\n", c->caja->id, (double)c->tiempo_max);
+/* El titular deja su ventana y queda de reserva, con su hilo (o en el pool);
+   lo usa el supervisor al bajar la cantidad de robots. Si esta daniado solo
+   deja de ser titular: al repararse vuelve a la reserva. */
+int desactivar_robot(RobotInfo *robotinfo) {
+    if (!robotinfo) return -1;
+    pthread_mutex_lock(&robotinfo->lock);
+    if (!robotinfo->titular) {
+        pthread_mutex_unlock(&robotinfo->lock);
+        return -1;
+    }
+    robotinfo->titular = 0;
+    int libre = robotinfo->activo && !robotinfo->daniado;
+    if (libre) {
+        robotinfo->activo = 0;
+        robotinfo->reserva = 1;
+        robotinfo->ventana = -1;
+        robotinfo->t_start = robotinfo->t_end = 0.0;
+    }
+    pthread_mutex_unlock(&robotinfo->lock);
+
+    ColaVentana *cola = &robotinfo->sistema->reloj->ventanas[robotinfo->id];
+    pthread_mutex_lock(&cola->lock);
+    if (atomic_load(&cola->robot) == robotinfo->id) atomic_store(&cola->robot, -1);
+    pthread_mutex_unlock(&cola->lock);
+    if (libre) metrica_estado(robotinfo->metricas, ROBOT_PARADO);
+    avisar_robot(robotinfo->sistema, robotinfo->id);
+    bit_info("Robot %d DESACTIVADO (queda de reserva)", robotinfo->id);
+    return 0;
+}
+
+/* Robot de reserva (hot-standby): queda listo, sin ventana, hasta que el
+   supervisor le pase la de un robot daniado. En modo hilo el hilo se crea
+   ahora, asi el failover no paga un pthread_create. */
+int preparar_reserva(RobotInfo *robotinfo) {
+    if (!robotinfo) return -1;
+    pthread_mutex_lock(&robotinfo->lock);
+    if (robotinfo->activo || robotinfo->reserva) {
+        pthread_mutex_unlock(&robotinfo->lock);
+        return -1;
+    }
+    robotinfo->reserva = 1;
+    robotinfo->ventana = -1;
+    pthread_mutex_unlock(&robotinfo->lock);
+
+    if (!robotinfo->sistema->pool && pthread_create(&robotinfo->thread, NULL, rutina_robot, robotinfo) != 0) {
+        perror("pthread_create(reserva)");
+        pthread_mutex_lock(&robotinfo->lock);
+        robotinfo->reserva = 0;
+        pthread_mutex_unlock(&robotinfo->lock);
+        return -1;
+    }
+    return 0;
+}
+/* ------------------ reloj de banda ------------------ */
+double reloj_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Un solo hilo para toda la banda: la cantidad de hilos ya no crece con num_cajas.
+   Cada ventana de robot tiene su cola; una caja esta en a lo sumo una. */
+int iniciar_reloj_banda(RelojBanda *reloj, SistemaRobot *sistema, CajaEnBanda *cajas, int capacidad,
+                       Caja *almacen, double T_ventana, int num_ventanas) {
+    if (!reloj || capacidad <= 0 || num_ventanas <= 0 || T_ventana <= 0.0) return -1;
+    reloj->sistema = sistema;
+    reloj->cajas = cajas;
+    reloj->capacidad = capacidad;
+    reloj->almacen = almacen;
+    reloj->ingresadas = 0;
+    reloj->primera_activa = 0;
+    reloj->cerrada = 0;
+    reloj->T_ventana = T_ventana;
+    reloj->num_ventanas = num_ventanas;
+    reloj->version_bordes = 0;
+    atomic_init(&reloj->salidas, 0);
+    atomic_init(&reloj->mangos_salidos, 0);
+    atomic_init(&reloj->mangos_perdidos, 0);
+    reloj->bordes = malloc(sizeof(double) * (size_t)(num_ventanas + 1));
+    reloj->bordes_hilo = malloc(sizeof(double) * (size_t)(num_ventanas + 1));
+    reloj->ventanas = calloc((size_t)num_ventanas, sizeof(ColaVentana));
+    if (!reloj->bordes || !reloj->bordes_hilo || !reloj->ventanas) {
+        perror("calloc(ventanas)");
+        free(reloj->bordes);
+        free(reloj->bordes_hilo);
+        free(reloj->ventanas);
+        return -1;
+    }
+    /* ventanas uniformes hasta que el supervisor las mueva (-D) */
+    for (int k = 0; k <= num_ventanas; k++) reloj->bordes[k] = k * T_ventana;
+    for (int k = 0; k < num_ventanas; k++) {
+        ColaVentana *q = &reloj->ventanas[k];
+        q->cajas = malloc(sizeof(long) * (size_t)capacidad);
+        if (!q->cajas) {
+            perror("malloc(cola ventana)");
+            for (int j = 0; j < k; j++) free(reloj->ventanas[j].cajas);
+            free(reloj->ventanas);
+            free(reloj->bordes);
+            free(reloj->bordes_hilo);
+            return -1;
+        }
+        atomic_init(&q->robot, -1);
+        pthread_mutex_init(&q->lock, NULL);
+        pthread_cond_init(&q->cond, NULL);
+    }
+
+    /* el reloj espera plazos absolutos en CLOCK_MONOTONIC, como reloj_ahora() */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&reloj->cambio, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&reloj->lock, NULL);
+
+    if (pthread_create(&reloj->thread, NULL, hilo_reloj_banda, reloj) != 0) {
+        perror("pthread_create(hilo_reloj_banda)");
+        reloj->thread = 0;
+        destruir_reloj_banda(reloj);
+        return -1;
+    }
+    return 0;
+}
+
+/* Libera colas y sincronizacion; el reloj y los robots ya deben haber terminado */
+void destruir_reloj_banda(RelojBanda *reloj) {
+    for (int k = 0; k < reloj->num_ventanas; k++) {
+        pthread_mutex_destroy(&reloj->ventanas[k].lock);
+        pthread_cond_destroy(&reloj->ventanas[k].cond);
+        free(reloj->ventanas[k].cajas);
+    }
+    free(reloj->ventanas);
+    free(reloj->bordes);
+    free(reloj->bordes_hilo);
+    reloj->ventanas = NULL;
+    reloj->bordes = reloj->bordes_hilo = NULL;
+    pthread_cond_destroy(&reloj->cambio);
+    pthread_mutex_destroy(&reloj->lock);
+}
+
+/* Bordes nuevos de las ventanas (los calcula el supervisor); el reloj
+   vuelve a repartir las cajas en las colas en su proxima pasada */
+void reloj_poner_bordes(RelojBanda *reloj, const double *bordes) {
+    pthread_mutex_lock(&reloj->lock);
+    memcpy(reloj->bordes, bordes, sizeof(double) * (size_t)(reloj->num_ventanas + 1));
+    reloj->version_bordes++;
+    /* el que alimenta la banda tambien puede estar esperando en cambio */
+    pthread_cond_broadcast(&reloj->cambio);
+    pthread_mutex_unlock(&reloj->lock);
+}
+
+/* Pone una caja en la siguiente ranura; su posicion se deduce de t_entrada.
+   Con almacen (modo flujo) la banda se queda con la caja y sus mangos.
+   Solo lo llama el hilo que alimenta la banda. */
+int ingresar_caja(RelojBanda *reloj, Caja *caja) {
+    if (!reloj || !caja) return -1;
+
+    pthread_mutex_lock(&reloj->lock);
+    long n = reloj->ingresadas;
+    int cerrada = reloj->cerrada;
+    pthread_mutex_unlock(&reloj->lock);
+    if (cerrada) return -1;
+
+    int ranura = (int)(n % reloj->capacidad);
+    CajaEnBanda *c = &reloj->cajas[ranura];
+
+    /* la ranura se libera cuando el reloj saca a su caja anterior de la banda
+       (y de su cola de ventana) y el ultimo brazo en camino a ella llega;
+       los dos avisan en cambio */
+    pthread_mutex_lock(&reloj->lock);
+    while (atomic_load_explicit(&c->activa, memory_order_acquire) ||
+           atomic_load_explicit(&c->en_uso, memory_order_acquire) > 0)
+        pthread_cond_wait(&reloj->cambio, &reloj->lock);
+    pthread_mutex_unlock(&reloj->lock);
+
+    IndiceEspacial indice;
+    if (construir_indice(&indice, caja) != 0) {
+        perror("construir_indice");
+        return -1;
+    }
+
+    if (reloj->almacen) {
+        free(reloj->almacen[ranura].mangos);
+        free(reloj->almacen[ranura].ruta);
+        reloj->almacen[ranura] = *caja;
+        c->caja = &reloj->almacen[ranura];
+    } else {
+        c->caja = caja;
+    }
+    liberar_indice(&c->indice);
+    c->indice = indice;
+    atomic_store_explicit(&c->t_entrada, reloj_ahora(), memory_order_relaxed);
+    atomic_store_explicit(&c->tiempo, 0.0f, memory_order_relaxed);
+    /* publicar: quien ve activa == 1 ve tambien caja, indice y t_entrada */
+    atomic_store_explicit(&c->activa, 1, memory_order_release);
+
+    pthread_mutex_lock(&reloj->lock);
+    reloj->ingresadas = n + 1;
+    pthread_cond_signal(&reloj->cambio);
+    pthread_mutex_unlock(&reloj->lock);
+
+    bit_info("Caja #%d entro a la banda (tiempo_max %.2f s)", c->caja->id, (double)c->tiempo_max);
+    return 0;
+}
+
+/* No entran mas cajas; el reloj termina cuando sale la ultima */
+void cerrar_banda(RelojBanda *reloj) {
+    pthread_mutex_lock(&reloj->lock);
+    reloj->cerrada = 1;
+    pthread_cond_signal(&reloj->cambio);
+    pthread_mutex_unlock(&reloj->lock);
+}
+
+/* Pasa la caja numero de su ventana actual a la nueva (-1 = ninguna) y
+   despierta al robot de la ventana a la que entra */
+void actualizar_ventana(RelojBanda *reloj, CajaEnBanda *c, long numero, int ventana) {
+    if (c->ventana == ventana) return;
+    if (c->ventana >= 0) {
+        ColaVentana *q = &reloj->ventanas[c->ventana];
+        pthread_mutex_lock(&q->lock);
+        for (int j = 0; j < q->n; j++) {
+            if (q->cajas[j] != numero) continue;
+            memmove(&q->cajas[j], &q->cajas[j + 1], sizeof(long) * (size_t)(q->n - j - 1));
+            q->n--;
+            break;
+        }
+        q->version++;
+        pthread_mutex_unlock(&q->lock);
+    }
+    c->ventana = ventana;
+    if (ventana >= 0) {
+        ColaVentana *q = &reloj->ventanas[ventana];
+        pthread_mutex_lock(&q->lock);
+        if (q->n < reloj->capacidad) q->cajas[q->n++] = numero;
+        q->version++;
+        pthread_cond_broadcast(&q->cond);
+        /* en modo pool no hay hilo esperando: se encola a quien la cubre */
+        int id = atomic_load(&q->robot);
+        if (reloj->sistema->pool && id >= 0) encolar_si_quieto(&reloj->sistema->robotsinfos[id]);
+        pthread_mutex_unlock(&q->lock);
+    }
+}
+
+/* Mueve las cajas y las reparte en las colas de ventana. No hay tick fijo:
+   el reloj duerme hasta el proximo cruce de ventana o salida de una caja, o
+   hasta que ingresar_caja/cerrar_banda/reloj_poner_bordes lo despiertan. Las
+   cajas salen en el mismo orden en que entraron, asi que solo se recorre
+   [primera_activa, ingresadas). Trabaja con su copia de los bordes. */
+void *hilo_reloj_banda(void *arg) {
+    RelojBanda *reloj = (RelojBanda *)arg;
+    int n = reloj->num_ventanas;
+    double *bordes = reloj->bordes_hilo;
+    long version = -1;
+    fijar_tiempo_real(reloj->sistema->prioridad_rt);
     while (1) {
-        usleep((useconds_t)(DT_SECS * 1e6));
-        pthread_mutex_lock(&c->lock);
-        if (!c->activa) {
-            pthread_mutex_unlock(&c->lock);
-            return NULL;
+        pthread_mutex_lock(&reloj->lock);
+        long desde = reloj->primera_activa;
+        long hasta = reloj->ingresadas;
+        int cerrada = reloj->cerrada;
+        if (version != reloj->version_bordes) {
+            version = reloj->version_bordes;
+            memcpy(bordes, reloj->bordes, sizeof(double) * (size_t)(n + 1));
         }
-        c->tiempo += DT_SECS;
-        if (c->tiempo >= (float)c->tiempo_max) {
-            c->activa = 0;
-            pthread_mutex_unlock(&c->lock);
-            printf("Caja #%d salio de la banda (tiempo >= tiempo_max)\n", c->caja->id);
-            return NULL;
+        pthread_mutex_unlock(&reloj->lock);
+
+        if (cerrada && desde >= hasta) break;
+
+        double ahora = reloj_ahora();
+        double proximo = -1.0;   /* instante del proximo cruce, -1 = ninguno */
+        long primera = desde;
+        int liberadas = 0;
+        for (long i = desde; i < hasta; i++) {
+            CajaEnBanda *c = &reloj->cajas[i % reloj->capacidad];
+            if (!mover_caja(c, ahora)) {
+                /* lo que no se etiqueto se pierde (lo mide el latido) */
+                if (atomic_load_explicit(&c->activa, memory_order_acquire)) {
+                    atomic_fetch_add_explicit(&reloj->salidas, 1, memory_order_relaxed);
+                    atomic_fetch_add_explicit(&reloj->mangos_salidos, c->caja->num_mangos, memory_order_relaxed);
+                    atomic_fetch_add_explicit(&reloj->mangos_perdidos, indice_restantes(&c->indice),
+                                              memory_order_relaxed);
+                }
+                /* primero fuera de la cola; recien entonces la ranura queda libre */
+                actualizar_ventana(reloj, c, i, -1);
+                if (atomic_load_explicit(&c->activa, memory_order_relaxed)) liberadas++;
+                desactivar_caja(c);
+                if (primera == i) primera = i + 1;
+                continue;
+            }
+            double t_entrada = atomic_load_explicit(&c->t_entrada, memory_order_relaxed);
+            int k = ventana_en(bordes, n, ahora - t_entrada);
+            double salida = t_entrada + c->tiempo_max;
+            double cruce = k >= 0 ? t_entrada + bordes[k + 1] : salida;
+            actualizar_ventana(reloj, c, i, k);
+            if (cruce > salida) cruce = salida;
+            if (proximo < 0.0 || cruce < proximo) proximo = cruce;
+        }
+
+        pthread_mutex_lock(&reloj->lock);
+        reloj->primera_activa = primera;
+        /* ingresar_caja puede estar esperando una de estas ranuras */
+        if (liberadas > 0) pthread_cond_broadcast(&reloj->cambio);
+        /* si mientras tanto entro una caja o se cerro la banda, no dormir;
+           tampoco si ya no queda nada por mover */
+        int vacia = reloj->cerrada && primera >= hasta;
+        if (!vacia && reloj->ingresadas == hasta && reloj->cerrada == cerrada &&
+            reloj->version_bordes == version) {
+            if (proximo < 0.0) {
+                pthread_cond_wait(&reloj->cambio, &reloj->lock);
+            } else {
+                proximo += 1e-4;   /* caer justo despues del borde */
+                struct timespec plazo;
+                plazo.tv_sec = (time_t)proximo;
+                plazo.tv_nsec = (long)((proximo - (double)plazo.tv_sec) * 1e9);
+                if (pthread_cond_timedwait(&reloj->cambio, &reloj->lock, &plazo) == ETIMEDOUT)
+                    jitter_anotar(reloj->sistema->jitter, JITTER_RELOJ, proximo, reloj_ahora());
+            }
         }
-        pthread_mutex_unlock(&c->lock);
+        pthread_mutex_unlock(&reloj->lock);
+    }
+    return NULL;
+}
+
+/* ------------------ mover_caja (un tick de una caja) ------------------ */
+/* Devuelve 1 si la caja sigue en la banda, 0 si ya salio (el reloj la
+   desactiva despues de sacarla de su cola de ventana). */
+int mover_caja(CajaEnBanda *c, double ahora) {
+    if (!atomic_load_explicit(&c->activa, memory_order_acquire)) return 0;
+    float t = (float)(ahora - atomic_load_explicit(&c->t_entrada, memory_order_relaxed));
+    atomic_store_explicit(&c->tiempo, t, memory_order_relaxed);
+    if (t >= (float)c->tiempo_max) {
+        bit_info("Caja #%d salio de la banda (tiempo >= tiempo_max)", c->caja->id);
+        return 0;
     }
+    return 1;
 }
 
 /* ------------------ auxiliares caja ------------------ */
+/* Lecturas sin lock: nunca bloquean al reloj ni a otros robots.
+   El tiempo se calcula a partir de t_entrada, no depende de la frecuencia del tick */
 float get_tiempo_caja(CajaEnBanda *cajaenbanda) {
     if (!cajaenbanda) return 0.0f;
-    float t;
-    pthread_mutex_lock(&cajaenbanda->lock);
-    t = cajaenbanda->tiempo;
-    pthread_mutex_unlock(&cajaenbanda->lock);
-    return t;
+    if (atomic_load_explicit(&cajaenbanda->activa, memory_order_acquire))
+        return (float)(reloj_ahora() - atomic_load_explicit(&cajaenbanda->t_entrada, memory_order_relaxed));
+    return atomic_load_explicit(&cajaenbanda->tiempo, memory_order_relaxed);
 }
 
 int is_caja_activa(CajaEnBanda *cajaenbanda) {
     if (!cajaenbanda) return 0;
-    int a;
-    pthread_mutex_lock(&cajaenbanda->lock);
-    a = cajaenbanda->activa;
-    pthread_mutex_unlock(&cajaenbanda->lock);
-    return a;
+    return atomic_load_explicit(&cajaenbanda->activa, memory_order_acquire) &&
+        (reloj_ahora() - atomic_load_explicit(&cajaenbanda->t_entrada, memory_order_relaxed))
+            < (double)cajaenbanda->tiempo_max;
 }
 
 void desactivar_caja(CajaEnBanda *cajaenbanda) {
     if (!cajaenbanda) return;
-    pthread_mutex_lock(&cajaenbanda->lock);
-    cajaenbanda->activa = 0;
-    pthread_mutex_unlock(&cajaenbanda->lock);
+    atomic_store_explicit(&cajaenbanda->activa, 0, memory_order_release);
 }
 
-/* ------------------ rutina_robot con etiquetado real ------------------ */
+/* ------------------ rutina_robot (modo hilo) ------------------ */
 void *rutina_robot(void *arg) {
     RobotInfo *r = (RobotInfo *)arg;
     if (!r) return NULL;
 
-    unsigned int seed = (unsigned int)time(NULL) ^ (r->id * 1315423911u);
-    printf("Hilo robot %d iniciado (ventana %.2f - %.2f)\n", r->id, r->t_start, r->t_end);
+    pthread_mutex_lock(&r->lock);
+    int reserva = r->reserva;
+    pthread_mutex_unlock(&r->lock);
+    if (reserva) bit_info("Hilo robot %d iniciado (reserva)", r->id);
+    else bit_info("Hilo robot %d iniciado (ventana %.2f - %.2f)", r->id, r->t_start, r->t_end);
 
-    double arm_x = 0.0;
-    double arm_y = 0.0;
-    int id_caja_actual = -1;
+    long *lista = malloc(sizeof(long) * (size_t)r->sistema->reloj->capacidad);
+    if (!lista) {
+        perror("malloc(lista ventana)");
+        return NULL;
+    }
+    fijar_tiempo_real(r->sistema->prioridad_rt);
 
     while (1) {
-        pthread_mutex_lock(&r->lock);
-        int activo = r->activo;
-        int daniado = r->daniado;
-        int es_reemp = r->es_reemplazo;
-        pthread_mutex_unlock(&r->lock);
-
-        if (!activo && !es_reemp) {
-            printf("Robot %d: saliendo (inactivo y no reemplazo)\n", r->id);
-            break;
+        int paso = paso_robot(r, lista);
+        if (paso == PASO_SALIR) break;
+        if (paso == PASO_MOVER) {
+            /* 9) Simular movimiento+etiquetado (bloqueante) hasta mov_fin */
+            struct timespec ts;
+            ts.tv_sec = (time_t)r->mov_fin;
+            ts.tv_nsec = (long)((r->mov_fin - (double)ts.tv_sec) * 1e9);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+                ;
+            jitter_anotar(r->sistema->jitter, JITTER_BRAZO, r->mov_fin, reloj_ahora());
+        } else if (paso != PASO_SEGUIR) {
+            /* dormir hasta que haya cajas nuevas en la ventana o cambie el robot */
+            esperar_robot(r);
         }
-        if (daniado) {
-            sleep(1);
-            continue;
-        }
-
-        int trabajo = 0;
+    }
 
-        for (int ci = 0; ci < g_num_cajas; ci++) {
-            CajaEnBanda *cb = &g_sistema->cajasenbanda[ci];
-            if (!cb) continue;
+    bit_info("Robot %d: saliendo (inactivo y no reemplazo)", r->id);
+    metrica_estado(r->metricas, ROBOT_PARADO);
+    free(lista);
+    return NULL;
+}
 
-            /* 1) Validar existencia y actividad de la caja */
-            if (cb->caja == NULL || !is_caja_activa(cb))
-                continue;
+/* ------------------ paso_robot con etiquetado real ------------------ */
+/* Un paso de la maquina del robot: si el brazo venia en camino etiqueta ese
+   mango, y despues busca el proximo en las cajas de su ventana. No bloquea:
+   devuelve PASO_MOVER con mov_* cargados (quien lo corre espera mov_t),
+   PASO_ESPERAR si no hay nada que hacer con esta version de la cola,
+   PASO_QUIETO si esta daniado o sin ventana, PASO_SEGUIR para volver a
+   buscar enseguida o PASO_SALIR si el robot termino. */
+int paso_robot(RobotInfo *r, long *lista) {
+    RelojBanda *reloj = r->sistema->reloj;
+    MetricasRobot *met = r->metricas;
+
+    if (r->mov_caja) terminar_movimiento(r);
+
+    pthread_mutex_lock(&r->lock);
+    int activo = r->activo;
+    int daniado = r->daniado;
+    int es_reemp = r->es_reemplazo;
+    int reserva = r->reserva;
+    int ventana = r->ventana;
+    double t_start = r->t_start;
+    double t_end = r->t_end;
+    double t_toma = r->t_toma;
+    r->t_toma = 0.0;
+    pthread_mutex_unlock(&r->lock);
+
+    if (!activo && !es_reemp && !daniado && !reserva) return PASO_SALIR;
+    if (t_toma > 0.0) supervisor_registrar_toma(r->sistema->supervisor, t_toma);
+    if (ventana != r->ventana_vista) {
+        /* tomo, devolvio o recupero una ventana: sus versiones no sirven */
+        r->ventana_vista = ventana;
+        r->agotada = -1;
+    }
+    if (daniado || ventana < 0) return PASO_QUIETO;
+
+    ColaVentana *cola = &reloj->ventanas[ventana];
+    pthread_mutex_lock(&cola->lock);
+    long version = cola->version;
+    int n_cajas = 0;
+    if (version != r->agotada) {
+        n_cajas = cola->n;
+        memcpy(lista, cola->cajas, sizeof(long) * (size_t)n_cajas);
+    }
+    pthread_mutex_unlock(&cola->lock);
 
-            /* 2) Tomar tiempo de la caja *antes* de bloquear (evita deadlock) */
-            float t_caja = get_tiempo_caja(cb);
+    for (int li = 0; li < n_cajas; li++) {
+        CajaEnBanda *cb = &reloj->cajas[lista[li] % reloj->capacidad];
 
-            /* 3) Est la caja dentro de la ventana del robot? */
-            if (t_caja < r->t_start || t_caja >= r->t_end)
-                continue;
+        /* 1) Validar actividad de la caja; activa publica caja e indice */
+        if (!is_caja_activa(cb) || cb->caja == NULL)
+            continue;
+        Caja *caja = cb->caja;
 
-            /* 4) Si entramos a una nueva caja, reiniciar brazo (0,0) */
-            if (cb->caja->id != id_caja_actual) {
-                id_caja_actual = cb->caja->id;
-                arm_x = 0.0;
-                arm_y = 0.0;
-                //printf("Robot %d: nuevo id_caja %d -> brazo reiniciado\n", r->id, id_caja_actual);
-            }
+        /* 2) Tiempo de la caja (lectura atomica, sin lock) */
+        float t_caja = get_tiempo_caja(cb);
 
-            /* 5) Buscar el mango ms cercano (bajo lock de la caja) */
-            int best_idx = -1;
-            double best_dist = 1e9;
+        /* 3) Est la caja dentro de la ventana del robot? */
+        if (t_caja < t_start || t_caja >= t_end)
+            continue;
 
-            pthread_mutex_lock(&cb->lock);
-            int n_mangos = cb->caja->num_mangos;
-            if (n_mangos <= 0) {
-                pthread_mutex_unlock(&cb->lock);
-                continue;
-            }
+        /* 4) Si entramos a una nueva caja, reiniciar brazo (0,0) */
+        if (caja->id != r->id_caja_actual) {
+            r->id_caja_actual = caja->id;
+            r->arm_x = 0.0;
+            r->arm_y = 0.0;
+            r->ultimo_mango = -1;
+            //printf("Robot %d: nuevo id_caja %d -> brazo reiniciado\n", r->id, r->id_caja_actual);
+        }
 
-            for (int mi = 0; mi < n_mangos; mi++) {
-                Mango *m = &cb->caja->mangos[mi];
-                if (!m) continue;
-                if (m->etiquetado) continue;
-                double d = distancia_2d(arm_x, arm_y, (double)m->x, (double)m->y);
-                if (d < best_dist) {
-                    best_dist = d;
-                    best_idx = mi;
-                }
-            }
+        /* 5-7) Mango ms cercano (sin lock: otros robots pueden estar
+           etiquetando la misma caja) y si hay TIEMPO SUFICIENTE dentro de
+           la ventana; misma decision que la simulacion */
+        DecisionRobot dec;
+        int hay_trabajo = decidir_en_caja(caja, &cb->indice, (double)t_caja, t_end, r->arm_x, r->arm_y, r->ultimo_mango, &dec);
+        if (!hay_trabajo) {
+            /* nada por hacer en esta caja ahora; seguimos buscando otros mangos/cajas */
+            if (dec.sin_tiempo) metrica_sumar(&met->sin_tiempo);
+            continue;
+        }
+        int best_idx = dec.idx;
 
-            if (best_idx < 0) {
-                /* nada por hacer en esta caja ahora */
-                pthread_mutex_unlock(&cb->lock);
-                continue;
-            }
+        /* 7b) Reservar el mango antes de mover el brazo: si otro robot lo
+           tomo entre la busqueda y la reserva, se vuelve a buscar */
+        if (!reservar_mango(&caja->mangos[best_idx], r->id)) {
+            metrica_sumar(&met->intentos_duplicados);
+            return PASO_SEGUIR;
+        }
+        r->reservado = &caja->mangos[best_idx];
+
+        /* 8) Probabilidad de fallo antes de iniciar la accin */
+        if (robot_falla_tick(PROB_FALLO, &r->semilla)) {
+            bit_aviso("Robot %d: fallo simulado antes de mover al mango (caja %d)",
+                   r->id, caja->id);
+            manejar_falla(r);
+            return PASO_QUIETO;
+        }
 
-            /* copiar datos del mango elegido */
-            //Mango temp_m = cb->caja->mangos[best_idx]; // copia segura
-            pthread_mutex_unlock(&cb->lock);
-
-            /* 6) calcular tiempos con datos copiados */
-            double lado = sqrt((double)cb->caja->area_caja);
-            double v_brazo = lado / CONST_VEL;
-            if (v_brazo <= 0.0) v_brazo = 1.0;
-            double t_move = best_dist / v_brazo;
-            double t_total = t_move + T_ETIQUETA;
-
-            /* 7) comprobar si hay TIEMPO SUFICIENTE dentro de la ventana */
-            double remaining = r->t_end - (double)t_caja; /* aproximado */
-            if (remaining < t_total) {
-                /* No hay tiempo para completar este mango dentro de la ventana */
-                /* Lo dejamos para otro robot (o para la siguiente pasada). */
-                /* Nota: no hacemos manejar_falla ni bloqueamos; seguimos buscando otros mangos/cajas */
-                continue;
-            }
+        /* 9) El brazo sale hacia el mango; el que corre al robot espera */
+        atomic_fetch_add_explicit(&cb->en_uso, 1, memory_order_relaxed);
+        r->mov_banda = cb;
+        r->mov_caja = caja;
+        r->mov_idx = best_idx;
+        r->mov_t = dec.t_total;
+        /* plazo absoluto desde el reloj de la caja: es el mismo instante que
+           decidir_en_caja comparo con t_end, aunque el paso se atrase */
+        r->mov_fin = atomic_load_explicit(&cb->t_entrada, memory_order_relaxed) + (double)t_caja + dec.t_total;
+        metrica_estado(met, ROBOT_OCUPADO);
+        return PASO_MOVER;
+    } /* fin for cajas */
+
+    /* sin trabajo con estas cajas: esperar a que cambie la cola */
+    r->agotada = version;
+    return PASO_ESPERAR;
+}
 
-            /* 8) Probabilidad de fallo antes de iniciar la accin */
-            double p_tick = PROB_FALLO * DT_SECS;
-            double rrand = (double)rand_r(&seed) / (double)RAND_MAX;
-            if (rrand < p_tick) {
-                printf("Robot %d: fallo simulado antes de mover al mango (caja %d)\n",
-                       r->id, cb->caja->id);
-                manejar_falla(r->id);
-                trabajo = 1;
-                break;
-            }
+/* 10) El brazo llego: etiquetar con compare-and-swap de reservado a
+   etiquetado (verificacin final) */
+void terminar_movimiento(RobotInfo *r) {
+    CajaEnBanda *cb = r->mov_banda;
+    Caja *caja = r->mov_caja;
+    int best_idx = r->mov_idx;
+    r->mov_banda = NULL;
+    r->mov_caja = NULL;
+    r->reservado = NULL;
+    metrica_estado(r->metricas, ROBOT_OCIOSO);
+
+    /* en modo flujo la ranura pudo pasar a otra caja mientras tanto */
+    if (cb->caja == caja && best_idx < caja->num_mangos) {
+        Mango *mcheck = &caja->mangos[best_idx];
+        if (etiquetar_mango(mcheck, r->id)) {
+            indice_quitar(&cb->indice, caja, best_idx);
+            metrica_sumar(&r->metricas->etiquetas);
+            bit_info("Robot %d: etiqueto mango %d en caja %d (pos %.2f, %.2f). Tiempo usado %.2fs",
+                   r->id, mcheck->id, caja->id, mcheck->x, mcheck->y, r->mov_t);
+        }
+        /* si ya lo etiqueto otro robot, el brazo igual quedo ahi */
+        r->arm_x = mcheck->x;
+        r->arm_y = mcheck->y;
+        r->ultimo_mango = best_idx;
+    }
 
-            /* 9) Simular movimiento+etiquetado (bloqueante) */
-            usleep((useconds_t)(t_total * 1e6));
-
-            /* 10) Re-lock y marcar si an no est etiquetado (verificacin final) */
-            pthread_mutex_lock(&cb->lock);
-            if (best_idx < cb->caja->num_mangos) {
-                Mango *mcheck = &cb->caja->mangos[best_idx];
-                if (!mcheck->etiquetado) {
-                    mcheck->etiquetado = 1;
-                    r->mangos_etiquetados++;
-                    arm_x = mcheck->x;
-                    arm_y = mcheck->y;
-                    printf("Robot %d: etiqueto mango %d en caja %d (pos %.2f, %.2f). Tiempo usado %.2fs\n",
-                           r->id, mcheck->id, cb->caja->id, mcheck->x, mcheck->y, t_total);
-                } else {
-                    /* ya etiquetado por otro robot */
-                    arm_x = mcheck->x;
-                    arm_y = mcheck->y;
-                }
-            }
-            /* detectar si con esto la caja qued completa (opcional) */
-            int todos = 1;
-            for (int mi = 0; mi < cb->caja->num_mangos; mi++) {
-                if (!cb->caja->mangos[mi].etiquetado) { todos = 0; break; }
-            }
-            if (todos) {
-                /* opcional: marcar caja como inactiva o log */
-                // printf("Robot %d: caja %d completada\n", r->id, cb->caja->id);
-            }
-            pthread_mutex_unlock(&cb->lock);
+    /* el ultimo brazo de una caja que ya salio libera su ranura */
+    if (atomic_fetch_sub_explicit(&cb->en_uso, 1, memory_order_acq_rel) == 1 &&
+        !atomic_load_explicit(&cb->activa, memory_order_acquire)) {
+        RelojBanda *reloj = r->sistema->reloj;
+        pthread_mutex_lock(&reloj->lock);
+        pthread_cond_broadcast(&reloj->cambio);
+        pthread_mutex_unlock(&reloj->lock);
+    }
+}
 
-            trabajo = 1;
-            break; /* salimos del for(ci) para fairness */
-        } /* fin for cajas */
+/* Modo hilo: duerme en la cola de su ventana (o en la propia si no cubre
+   ninguna) hasta que haya cajas con trabajo posible, cambie su ventana o
+   deba terminar. avisar_robot despierta la cola anotada en esperando_en. */
+void esperar_robot(RobotInfo *r) {
+    pthread_mutex_lock(&r->lock);
+    int k = r->ventana >= 0 ? r->ventana : r->id;
+    r->esperando_en = k;
+    pthread_mutex_unlock(&r->lock);
+
+    ColaVentana *cola = &r->sistema->reloj->ventanas[k];
+    pthread_mutex_lock(&cola->lock);
+    while (1) {
+        pthread_mutex_lock(&r->lock);
+        int activo = r->activo;
+        int daniado = r->daniado;
+        int es_reemp = r->es_reemplazo;
+        int reserva = r->reserva;
+        int ventana = r->ventana;
+        pthread_mutex_unlock(&r->lock);
 
-        if (!trabajo) usleep((useconds_t)(DT_SECS * 1e6));
-    } /* fin while */
+        if (!activo && !es_reemp && !daniado && !reserva) break;
+        if (ventana != r->ventana_vista) break;
+        if (!daniado && ventana >= 0 && cola->n > 0 && cola->version != r->agotada) break;
+        pthread_cond_wait(&cola->cond, &cola->lock);
+    }
+    pthread_mutex_unlock(&cola->lock);
 
-    return NULL;
+    pthread_mutex_lock(&r->lock);
+    r->esperando_en = -1;
+    pthread_mutex_unlock(&r->lock);
 }
 
+/* Despierta al robot id para que relea su estado (activo/daniado/ventana) */
+void avisar_robot(SistemaRobot *sistema, int id) {
+    if (!sistema || !sistema->reloj || id < 0 || id >= sistema->robots_maximos) return;
+    RobotInfo *r = &sistema->robotsinfos[id];
+    if (sistema->pool) {
+        /* primero el aviso y despues el intento de encolar; estacionar_robot
+           lo hace al reves, asi uno de los dos lo ve */
+        atomic_fetch_add(&r->avisos, 1);
+        encolar_si_quieto(r);
+        return;
+    }
+    pthread_mutex_lock(&r->lock);
+    int k = r->esperando_en >= 0 ? r->esperando_en : id;
+    pthread_mutex_unlock(&r->lock);
+    ColaVentana *cola = &sistema->reloj->ventanas[k];
+    pthread_mutex_lock(&cola->lock);
+    cola->version++;
+    pthread_cond_broadcast(&cola->cond);
+    pthread_mutex_unlock(&cola->lock);
+}
 
+/* ------------------ modo pool ------------------ */
+/* El robot es solo su maquina de pasos: un trabajador del planificador corre
+   pasos hasta que el brazo sale (el supervisor lo vuelve a encolar cuando
+   llega) o hasta que no hay nada que hacer (queda quieto, sin hilo, hasta un
+   aviso o un cambio en su cola). planificado garantiza que un robot este a
+   lo sumo una vez en el pool. */
+void encolar_si_quieto(RobotInfo *r) {
+    int quieto = 0;
+    if (!atomic_compare_exchange_strong(&r->planificado, &quieto, 1)) return;
+    atomic_fetch_add(&r->sistema->planificados, 1);
+    planificador_encolar(r->sistema->pool, r);
+}
 
+void despertar_robot(SistemaRobot *sistema, int id) {
+    if (!sistema->pool || id < 0 || id >= sistema->robots_maximos) return;
+    planificador_encolar(sistema->pool, &sistema->robotsinfos[id]);
+}
 
-/* ------------------ falla / redundancia ------------------ */
+/* Deja al robot quieto. Si entre el paso y ahora llego un aviso (o, si
+   mirar_cola, cambio su cola) lo vuelve a tomar: devuelve 1 y el mismo
+   trabajador sigue con el robot. */
+int estacionar_robot(RobotInfo *r, long avisos, int mirar_cola) {
+    /* copiar antes de soltarlo: despues otro trabajador puede correrlo */
+    int ventana = r->ventana_vista;
+    long agotada = r->agotada;
+    atomic_store(&r->planificado, 0);
+    if (atomic_fetch_sub(&r->sistema->planificados, 1) == 1 && atomic_load(&r->sistema->esperando_quietos)) {
+        /* era el ultimo: despertar a esperar_robots_quietos */
+        pthread_mutex_lock(&r->sistema->lock_quietos);
+        pthread_cond_broadcast(&r->sistema->quietos);
+        pthread_mutex_unlock(&r->sistema->lock_quietos);
+    }
 
-/* Probabilidad de fallo se calcula como prob_por_segundo * DT_SECS por tick
-   (aplicado dentro de rutina_robot). Aqui solo funcion auxiliares. */
-int robot_falla_tick(double prob_per_sec) {
-    double p = prob_per_sec * DT_SECS;
-    if (p <= 0.0) return 0;
-    if (p > 1.0) p = 1.0;
-    double r = (double)rand() / RAND_MAX;
-    return r < p;
+    int cambio = atomic_load(&r->avisos) != avisos;
+    if (!cambio && mirar_cola && ventana >= 0) {
+        /* con el lock de la cola: o vemos la version nueva o quien la cambio
+           ve planificado en 0 y lo encola el */
+        ColaVentana *cola = &r->sistema->reloj->ventanas[ventana];
+        pthread_mutex_lock(&cola->lock);
+        cambio = cola->n > 0 && cola->version != agotada;
+        pthread_mutex_unlock(&cola->lock);
+    }
+    if (!cambio) return 0;
+    int quieto = 0;
+    if (!atomic_compare_exchange_strong(&r->planificado, &quieto, 1)) return 0;
+    atomic_fetch_add(&r->sistema->planificados, 1);
+    return 1;
 }
 
-/* Manejar falla: marcar daniado, desactivar, activar primer reemplazo libre */
-void manejar_falla(int id) {
-    if (!g_robots_infos || id < 0 || id >= g_robots_maximos) return;
-
-    pthread_mutex_lock(&g_robots_infos[id].lock);
-    g_robots_infos[id].daniado = 1;
-    g_robots_infos[id].activo = 0;
-    pthread_mutex_unlock(&g_robots_infos[id].lock);
-
-    int found = -1;
-    for (int i = 0; i < g_robots_maximos; i++) {
-        if (i == id) continue;
-        pthread_mutex_lock(&g_robots_infos[i].lock);
-        int candidate_free = (!g_robots_infos[i].activo && !g_robots_infos[i].daniado && !g_robots_infos[i].es_reemplazo);
-        if (candidate_free) {
-            g_robots_infos[i].es_reemplazo = 1;
-            /* activar este robot */
-            g_robots_infos[i].activo = 1;
-            pthread_mutex_unlock(&g_robots_infos[i].lock);
-            /* crear hilo */
-            if (pthread_create(&g_robots_infos[i].thread, NULL, rutina_robot, &g_robots_infos[i]) != 0) {
-                perror("pthread_create(reemplazo)");
-            }
-            found = i;
-            break;
+void correr_robot_pool(void *elemento, int hilo) {
+    RobotInfo *r = (RobotInfo *)elemento;
+    SistemaRobot *sistema = r->sistema;
+    long *lista = sistema->listas + (size_t)hilo * (size_t)sistema->reloj->capacidad;
+    while (1) {
+        long avisos = atomic_load(&r->avisos);
+        int paso = paso_robot(r, lista);
+        if (paso == PASO_MOVER) {
+            supervisor_programar(sistema->supervisor, r->id, r->mov_fin);
+            return;
         }
-        pthread_mutex_unlock(&g_robots_infos[i].lock);
+        if (paso == PASO_SEGUIR) {
+            /* a la deque propia: otro trabajador lo puede robar */
+            planificador_encolar(sistema->pool, r);
+            return;
+        }
+        if (paso == PASO_SALIR) metrica_estado(r->metricas, ROBOT_PARADO);
+        if (!estacionar_robot(r, avisos, paso == PASO_ESPERAR)) return;
     }
+}
 
-    if (found >= 0) {
-        printf("Robot %d se da -> Robot %d activado como reemplazo\n", id, found);
-    } else {
-        printf("Robot %d se da -> NO HAY reemplazo disponible\n", id);
-    }
+/* Fin de la corrida en modo pool: espera a que ningun robot este encolado,
+   corriendo o con el brazo en camino. Primero se anota: o ve planificados en
+   0 o el que lo deja en 0 ve esperando_quietos y avisa en quietos. */
+void esperar_robots_quietos(SistemaRobot *sistema) {
+    atomic_store(&sistema->esperando_quietos, 1);
+    pthread_mutex_lock(&sistema->lock_quietos);
+    while (atomic_load(&sistema->planificados) > 0)
+        pthread_cond_wait(&sistema->quietos, &sistema->lock_quietos);
+    pthread_mutex_unlock(&sistema->lock_quietos);
+}
 
-    /* Simular reparacin despus de un tiempo aleatorio 1..5 s */
-    int repair_time = 1 + (rand() % 5);
-    sleep((unsigned)repair_time);
+/* ------------------ falla / redundancia ------------------ */
 
-    /* recuperar */
-    recuperar_robot(id);
+/* Probabilidad de fallo se calcula como prob_por_segundo * DT_SECS por accion
+   (aplicado dentro de paso_robot), con la semilla propia del robot. */
+int robot_falla_tick(double prob_per_sec, unsigned int *semilla) {
+    double p = prob_per_sec * DT_SECS;
+    if (p <= 0.0) return 0;
+    if (p > 1.0) p = 1.0;
+    double r = (double)rand_r(semilla) / RAND_MAX;
+    return r < p;
 }
 
-/* Recuperar robot original y apagar reemplazo (el primero que encontremos) */
-void recuperar_robot(int id) {
-    if (!g_robots_infos || id < 0 || id >= g_robots_maximos) return;
-
-    pthread_mutex_lock(&g_robots_infos[id].lock);
-    g_robots_infos[id].daniado = 0;
-    g_robots_infos[id].activo = 1;
-    pthread_mutex_unlock(&g_robots_infos[id].lock);
+/* Manejar falla: marcar daniado, soltar la reserva y avisar al supervisor, que
+   pasa la ventana a un robot de reserva y programa la reparacion (supervisor.c).
+   Quien corre al robot queda libre enseguida: nadie duerme la reparacion. */
+void manejar_falla(RobotInfo *r) {
+    int id = r->id;
+
+    pthread_mutex_lock(&r->lock);
+    r->daniado = 1;
+    /* el brazo no va a llegar: soltar su reserva para que otro robot la tome */
+    Mango *reservado = r->reservado;
+    r->reservado = NULL;
+    pthread_mutex_unlock(&r->lock);
+    metrica_sumar(&r->metricas->fallas);
+    metrica_estado(r->metricas, ROBOT_DANIADO);
+    if (reservado) liberar_mango(reservado, id);
+
+    supervisor_reportar_falla(r->sistema->supervisor, id);
+}
 
-    for (int i = 0; i < g_robots_maximos; i++) {
-        if (i == id) continue;
-        pthread_mutex_lock(&g_robots_infos[i].lock);
-        if (g_robots_infos[i].es_reemplazo) {
-            g_robots_infos[i].es_reemplazo = 0;
-            g_robots_infos[i].activo = 0;
-            pthread_mutex_unlock(&g_robots_infos[i].lock);
-            printf("Robot %d recuperado -> Robot %d (reemplazo) DESACTIVADO\n", id, i);
-            return;
-        }
-        pthread_mutex_unlock(&g_robots_infos[i].lock);
+/* ------------------ modo simulacion ------------------ */
+/* Corre la misma logica de robots sobre el estado recibido, en tiempo virtual */
+int correr_simulacion(EstadoSistema *estado, int robots_maximos, unsigned int semilla, int dinamicas,
+                      const Llegadas *llegadas) {
+    ParamsSimulacion p;
+    ResultadoSimulacion res;
+
+    params_simulacion_default(&p, estado, robots_maximos);
+    p.semilla = semilla;
+    p.verbose = 1;
+    p.ventanas_dinamicas = dinamicas;
+    p.llegadas = llegadas;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (simular_banda(estado, &p, &res) != 0) {
+        fprintf(stderr, "Error en la simulacion\n");
+        return -1;
     }
-    printf("Robot %d recuperado -> No habia reemplazo activo.\n", id);
-}
+    clock_gettime(CLOCK_MONOTONIC, &t1);
 
-/* ------------------ util ------------------ */
-static double distancia_2d(double x1, double y1, double x2, double y2) {
-    double dx = x1 - x2;
-    double dy = y1 - y2;
-    return sqrt(dx*dx + dy*dy);
+    imprimir_resultado_simulacion(estado, &res);
+    printf("Tiempo real de simulacion: %.3f ms (semilla %u)\n",
+           (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6, semilla);
+    return 0;
 }
 
@@ -1,31 +1,136 @@
 #ifndef ROBOT_H
 #define ROBOT_H
 
+typedef struct SistemaRobot SistemaRobot;
+
+/* Ranura de la banda. Sin lock: ingresar_caja llena caja/indice/t_entrada y
+   publica la caja con activa (release); el reloj y los robots leen activa
+   (acquire) antes de mirar lo demas. Una ranura solo se vuelve a llenar
+   cuando su caja ya salio y ningun brazo va en camino a uno de sus mangos
+   (en_uso == 0); ingresar_caja lo espera en reloj->cambio. El paso en que un
+   robot decide sobre la caja (entre ver activa y subir en_uso) no se cuenta:
+   no duerme, y la ranura recien vuelve despues de HOLGURA_RANURAS llegadas. */
 typedef struct {
     Caja *caja;
-    float tiempo;  // segundos desde que entra a la banda
+    _Atomic float tiempo;  // segundos desde que entra a la banda
 	int tiempo_max;
-    int activa;    // 1 = esta en la banda
+    atomic_int activa;    // 1 = esta en la banda
+    atomic_int en_uso;    // brazos en camino a un mango de esta caja
+    _Atomic double t_entrada; // instante (CLOCK_MONOTONIC, s) en que entro a la banda
+    IndiceEspacial indice; // mangos sin etiquetar de la caja actual (grilla)
+    int ventana;      // ventana de robot donde esta la caja (-1 = ninguna); solo la cambia el reloj
+} CajaEnBanda;
+
+/* Cajas que estan dentro de la ventana de un robot. El reloj de banda la
+   actualiza cuando una caja entra o sale de la ventana y despierta al robot;
+   tambien se avisa por aqui cuando cambia el estado del robot. */
+typedef struct {
+    long *cajas;            // numeros de caja en la ventana, la mas vieja primero
+    int n;
+    long version;           // cambia con cada entrada/salida o aviso al robot
+    atomic_int robot;       // robot que la cubre (-1 = nadie); en modo pool es al que se despierta
     pthread_mutex_t lock;
+    pthread_cond_t cond;
+} ColaVentana;
+
+/* Reloj unico de la banda: un solo hilo es duenio de todas las cajas.
+   Las ranuras se usan como anillo: la caja n ocupa cajas[n % capacidad]. */
+typedef struct {
+    CajaEnBanda *cajas;     // ranuras de la banda
+    int capacidad;
+    Caja *almacen;          // modo flujo: cajas propias por ranura (NULL si no)
+    long ingresadas;        // cajas que ya entraron a la banda
+    long primera_activa;    // numero de la primera caja que sigue en la banda
+    int cerrada;            // no van a entrar mas cajas
+    double T_ventana;       // duracion nominal de la ventana de cada robot (s)
+    int num_ventanas;       // una por robot (robots_maximos)
+    double *bordes;         // num_ventanas+1: la ventana k es [bordes[k], bordes[k+1]) (ventanas.h)
+    long version_bordes;    // cambia cada vez que el supervisor mueve los bordes
+    double *bordes_hilo;    // copia de bordes con la que trabaja el hilo del reloj
+    atomic_long salidas;    // cajas que salieron de la banda (solo las suma el reloj)
+    atomic_long mangos_salidos;
+    atomic_long mangos_perdidos; // salieron sin etiqueta
+    ColaVentana *ventanas;
+    SistemaRobot *sistema;  // banda duenia (modo pool: a quien encolar al entrar una caja)
+    pthread_mutex_t lock;   // protege ingresadas/primera_activa/cerrada y los bordes
+    pthread_cond_t cambio;  // despierta al reloj (caja nueva o banda cerrada) y a
+                            // ingresar_caja (ranura libre); con broadcast si
+                            // puede haber los dos esperando
     pthread_t thread;
-} CajaEnBanda;
+} RelojBanda;
 
+/* Un robot es una maquina de pasos (paso_robot en robot.c): la corre su
+   propio hilo o, en modo pool, cualquier trabajador del planificador.
+   Los campos de estado y de ventana se leen y cambian con lock; los de la
+   maquina de pasos solo los toca quien esta corriendo al robot. */
 typedef struct {
     int id;                 // Indice fisico 0..ROBOTS_MAX-1
-    double t_start;         // inicio de ventana (s)
-    double t_end;           // fin de ventana (s)
-	int activo;
+    double t_start;         // inicio de la ventana que cubre (s)
+    double t_end;           // fin de la ventana que cubre (s)
+	int activo;             // titular cubriendo su propia ventana
 	int daniado;
-	int es_reemplazo;
+	int es_reemplazo;       // reserva cubriendo la ventana de un robot daniado
+	int reserva;            // hot-standby: listo para tomar una ventana
+	int titular;            // 1 = al repararse vuelve a su ventana (id); 0 = a la reserva
+	int ventana;            // ventana que cubre (-1 = ninguna)
+	double t_toma;          // instante de la falla que le dio la ventana (0 = ya medido)
+	int esperando_en;       // modo hilo: cola de ventana donde duerme (-1 = ninguna)
     pthread_t thread;       // hilo asociado (si se crea)
     pthread_mutex_t lock;   // mutex para campos del robot
-    int mangos_etiquetados; // estadistica
+    SistemaRobot *sistema;  // banda a la que pertenece
+    MetricasRobot *metricas; // contadores y tiempo por estado (metricas.h)
+    Mango *reservado;       // mango reservado con el brazo en camino (NULL si ninguno)
+
+    /* modo pool */
+    atomic_int planificado; // 1 = encolado, corriendo o con el brazo en camino
+    atomic_long avisos;     // cambia en cada avisar_robot
+
+    /* maquina de pasos */
+    unsigned int semilla;   // fallas simuladas (rand_r)
+    double arm_x, arm_y;
+    int ultimo_mango;       // mango donde quedo el brazo, -1 = centro
+    int id_caja_actual;
+    int ventana_vista;      // ventana del ultimo paso (para detectar un cambio)
+    long agotada;           // version de la cola en la que no quedo nada por hacer
+    CajaEnBanda *mov_banda; // movimiento en curso (mov_caja NULL = ninguno)
+    Caja *mov_caja;
+    int mov_idx;
+    double mov_t;           // duracion del movimiento + etiquetado (s)
+    double mov_fin;         // instante (CLOCK_MONOTONIC, s) en que el brazo termina
 } RobotInfo;
 
-typedef struct {
+/* Una banda con sus robots: todo lo que antes era global del proceso. Con
+   robot -N cada banda tiene la suya, con sus hilos, su supervisor y su pool;
+   dos bandas no comparten ningun lock. */
+struct SistemaRobot {
 	int robotsactivos;
 	RobotInfo *robotsinfos;
 	CajaEnBanda *cajasenbanda;
-}SistemaRobot;
+	RelojBanda *reloj;
+	int banda;                       // numero de banda en el proceso (0..N-1)
+	int robots_maximos;
+	struct Supervisor *supervisor;
+	struct Planificador *pool;       // modo pool (-P); NULL = un hilo por robot
+	long *listas;                    // modo pool: lista de cajas de cada trabajador
+	atomic_long planificados;        // modo pool: robots encolados, corriendo o moviendose
+	atomic_int esperando_quietos;    // modo pool: esperar_robots_quietos espera en quietos
+	pthread_mutex_t lock_quietos;
+	pthread_cond_t quietos;          // planificados llego a 0
+	pthread_t hilo_latido;
+	int sock_latido;                 // socket que atiende hilo_latido (-1 = sin hilo)
+	atomic_int despedir;             // el proximo latido se contesta con TRAMA_FIN
+	double util_ocupado;             // segundos ocupado y ocupado+ocioso de todos los
+	double util_total;               // robots al latido anterior
+	HistogramaJitter *jitter;        // retraso de cada plazo, por fuente (metricas.h); NULL = sin medir
+	int prioridad_rt;                // SCHED_FIFO de los hilos con plazos (-T); 0 = SCHED_OTHER
+};
+
+/* robot.c: usadas por el supervisor */
+double reloj_ahora(void);
+int activar_robot(RobotInfo *robotinfo);     // el titular toma su ventana
+int desactivar_robot(RobotInfo *robotinfo);  // el titular la deja y queda de reserva
+void reloj_poner_bordes(RelojBanda *reloj, const double *bordes);
+void avisar_robot(SistemaRobot *sistema, int id);      // releer estado (y en modo pool, encolarlo si esta quieto)
+void despertar_robot(SistemaRobot *sistema, int id);   // modo pool: el brazo llego, seguir con el robot
 
 #endif
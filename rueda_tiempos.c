@@ -0,0 +1,81 @@
+// rueda_tiempos.c - rueda de temporizadores con hash (plazos en O(1))
+
+#include <string.h>
+#include <math.h>
+
+#include "rueda_tiempos.h"
+
+#define RUEDA_MASCARA (RUEDA_RANURAS - 1)
+
+void rueda_iniciar(RuedaTiempos *rueda, double origen, double resolucion) {
+    memset(rueda->ranuras, 0, sizeof(rueda->ranuras));
+    rueda->origen = origen;
+    rueda->resolucion = resolucion;
+    rueda->actual = 0;
+    rueda->n = 0;
+}
+
+/* Programa t para el instante plazo (mismo reloj que origen). Un plazo ya
+   vencido cae en el tick siguiente. Si t ya estaba en la rueda se mueve. */
+void rueda_agregar(RuedaTiempos *rueda, Temporizador *t, double plazo) {
+    if (t->vence >= 0) rueda_quitar(rueda, t);
+    long vence = (long)ceil((plazo - rueda->origen) / rueda->resolucion);
+    if (vence <= rueda->actual) vence = rueda->actual + 1;
+    t->vence = vence;
+
+    Temporizador **cabeza = &rueda->ranuras[vence & RUEDA_MASCARA];
+    t->ant = NULL;
+    t->sig = *cabeza;
+    if (*cabeza) (*cabeza)->ant = t;
+    *cabeza = t;
+    rueda->n++;
+}
+
+/* Cancela t; no hace nada si no esta en la rueda (vence == -1) */
+void rueda_quitar(RuedaTiempos *rueda, Temporizador *t) {
+    if (t->vence < 0) return;
+    if (t->ant) t->ant->sig = t->sig;
+    else rueda->ranuras[t->vence & RUEDA_MASCARA] = t->sig;
+    if (t->sig) t->sig->ant = t->ant;
+    t->sig = t->ant = NULL;
+    t->vence = -1;
+    rueda->n--;
+}
+
+/* Saca de la rueda todo lo que vence hasta ahora y lo devuelve encadenado por
+   sig (NULL si no vencio nada). Si paso mas de una vuelta desde la ultima
+   llamada basta con recorrer cada ranura una vez. */
+Temporizador *rueda_avanzar(RuedaTiempos *rueda, double ahora) {
+    long hasta = (long)floor((ahora - rueda->origen) / rueda->resolucion);
+    if (hasta <= rueda->actual) return NULL;
+
+    Temporizador *vencidos = NULL;
+    long pasos = hasta - rueda->actual;
+    if (pasos > RUEDA_RANURAS) pasos = RUEDA_RANURAS;
+    for (long k = 1; k <= pasos && rueda->n > 0; k++) {
+        Temporizador *t = rueda->ranuras[(rueda->actual + k) & RUEDA_MASCARA];
+        while (t) {
+            Temporizador *sig = t->sig;
+            if (t->vence <= hasta) {
+                rueda_quitar(rueda, t);
+                t->sig = vencidos;
+                vencidos = t;
+            }
+            t = sig;
+        }
+    }
+    rueda->actual = hasta;
+    return vencidos;
+}
+
+/* Instante del proximo tick con una ranura ocupada, o -1 si la rueda esta
+   vacia. Puede ser antes del plazo real (un temporizador de otra vuelta en esa
+   ranura): quien espera se despierta, avanza y vuelve a preguntar. */
+double rueda_proximo(const RuedaTiempos *rueda) {
+    if (rueda->n == 0) return -1.0;
+    for (long k = 1; k <= RUEDA_RANURAS; k++) {
+        if (rueda->ranuras[(rueda->actual + k) & RUEDA_MASCARA])
+            return rueda->origen + (double)(rueda->actual + k) * rueda->resolucion;
+    }
+    return -1.0;
+}
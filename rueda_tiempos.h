@@ -0,0 +1,37 @@
+#ifndef RUEDA_TIEMPOS_H
+#define RUEDA_TIEMPOS_H
+
+// ---------- RUEDA DE TEMPORIZADORES ----------
+// Rueda con hash: el tiempo se divide en ticks de resolucion fija y cada
+// temporizador cuelga de la ranura vence % RUEDA_RANURAS, en una lista
+// doblemente enlazada. Agregar y quitar son O(1); avanzar solo recorre las
+// ranuras de los ticks que pasaron. Los plazos mas lejanos que una vuelta
+// comparten ranura con los cercanos y se saltan hasta que les toca.
+// Sin locks: la usa un solo hilo o quien tenga el lock que la protege.
+// Los nodos son del que llama (se embeben o van en un arreglo propio).
+
+#define RUEDA_RANURAS 512   // potencia de 2
+
+typedef struct Temporizador {
+    struct Temporizador *sig;
+    struct Temporizador *ant;
+    long vence;          // tick absoluto; -1 = no esta en la rueda
+    int tipo;            // libres para quien programa
+    int id;
+} Temporizador;
+
+typedef struct {
+    Temporizador *ranuras[RUEDA_RANURAS];
+    double origen;       // instante del tick 0 (s)
+    double resolucion;   // segundos por tick
+    long actual;         // ultimo tick procesado
+    int n;               // temporizadores en la rueda
+} RuedaTiempos;
+
+void rueda_iniciar(RuedaTiempos *rueda, double origen, double resolucion);
+void rueda_agregar(RuedaTiempos *rueda, Temporizador *t, double plazo);
+void rueda_quitar(RuedaTiempos *rueda, Temporizador *t);
+Temporizador *rueda_avanzar(RuedaTiempos *rueda, double ahora);
+double rueda_proximo(const RuedaTiempos *rueda);
+
+#endif
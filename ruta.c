@@ -0,0 +1,117 @@
+// ruta.c - orden de visita de los mangos de una caja (vecino mas cercano + 2-opt)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "datos.h"
+#include "mangos_soa.h"
+#include "ruta.h"
+
+/* Posicion del nodo k del camino; el nodo 0 es el centro de la caja */
+static void punto(const Caja *caja, const int *camino, int k, double *x, double *y) {
+    if (k == 0) {
+        *x = 0.0;
+        *y = 0.0;
+        return;
+    }
+    const Mango *m = &caja->mangos[camino[k]];
+    *x = (double)m->x;
+    *y = (double)m->y;
+}
+
+static double tramo(const Caja *caja, const int *camino, int a, int b) {
+    double ax, ay, bx, by;
+    punto(caja, camino, a, &ax, &ay);
+    punto(caja, camino, b, &bx, &by);
+    return sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by));
+}
+
+/* ------------------ 2-opt ------------------ */
+/* camino[1..n] son indices de mango; camino[0] queda fijo en el centro.
+   Invertir camino[i..j] cambia los tramos (i-1,i) y (j,j+1) por (i-1,j) y
+   (i,j+1); en el ultimo nodo el camino queda abierto y no hay (j,j+1). */
+static void mejorar_2opt(const Caja *caja, int *camino, int n) {
+    int mejoro = 1;
+    for (int pasada = 0; pasada < RUTA_MAX_PASADAS && mejoro; pasada++) {
+        mejoro = 0;
+        for (int i = 1; i < n; i++) {
+            for (int j = i + 1; j <= n; j++) {
+                double delta = tramo(caja, camino, i - 1, j) - tramo(caja, camino, i - 1, i);
+                if (j < n)
+                    delta += tramo(caja, camino, i, j + 1) - tramo(caja, camino, j, j + 1);
+                if (delta < -1e-6) {
+                    for (int a = i, b = j; a < b; a++, b--) {
+                        int t = camino[a];
+                        camino[a] = camino[b];
+                        camino[b] = t;
+                    }
+                    mejoro = 1;
+                }
+            }
+        }
+    }
+}
+
+/* ------------------ planificar_ruta ------------------ */
+/* Deja en caja->ruta los num_mangos indices en orden de visita. Si caja->ruta
+   ya apunta a lugar para num_mangos indices (arena del estado) se escribe ahi;
+   si es NULL se reserva con malloc y la libera el llamador.
+   Devuelve 0 si pudo, -1 si no hubo memoria (caja->ruta queda NULL). */
+int planificar_ruta(Caja *caja) {
+    if (!caja) return -1;
+    int n = caja->num_mangos;
+    if (n <= 0) {
+        caja->ruta = NULL;
+        return 0;
+    }
+
+    int *camino = malloc(sizeof(int) * (size_t)(n + 1));
+    MangosSoA soa;
+    if (!camino || soa_desde_caja(&soa, caja) != 0) {
+        perror("planificar_ruta");
+        free(camino);
+        caja->ruta = NULL;
+        return -1;
+    }
+
+    /* vecino mas cercano desde el centro; los ya etiquetados van al final */
+    camino[0] = -1;
+    int k = 0;
+    float ax = 0.0f, ay = 0.0f;
+    while (k < n) {
+        int idx = soa_mas_cercano(&soa, ax, ay, NULL);
+        if (idx < 0) break;
+        camino[++k] = idx;
+        soa_marcar(&soa, idx);
+        ax = soa.x[idx];
+        ay = soa.y[idx];
+    }
+    for (int i = 0; i < n && k < n; i++)
+        if (caja->mangos[i].etiquetado) camino[++k] = i;
+    liberar_soa(&soa);
+
+    mejorar_2opt(caja, camino, n);
+
+    if (!caja->ruta) caja->ruta = malloc(sizeof(int) * (size_t)n);
+    if (!caja->ruta) {
+        perror("malloc(ruta)");
+        free(camino);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) caja->ruta[i] = camino[i + 1];
+    free(camino);
+    return 0;
+}
+
+/* Distancia que recorre el brazo desde el centro siguiendo la ruta (cm) */
+double largo_ruta(const Caja *caja, const int *ruta) {
+    double total = 0.0, x = 0.0, y = 0.0;
+    for (int i = 0; i < caja->num_mangos; i++) {
+        const Mango *m = &caja->mangos[ruta ? ruta[i] : i];
+        total += sqrt((m->x - x) * (m->x - x) + (m->y - y) * (m->y - y));
+        x = m->x;
+        y = m->y;
+    }
+    return total;
+}
@@ -0,0 +1,17 @@
+#ifndef RUTA_H
+#define RUTA_H
+
+#include "datos.h"
+
+// ---------- PLANIFICADOR DE RUTA DEL BRAZO ----------
+// Orden de visita por caja: el brazo arranca en el centro (0,0), se arma la
+// ruta con vecino mas cercano y se mejora con 2-opt (camino abierto, sin
+// volver al centro). El escaner la calcula al escanear y la envia con la caja.
+// caja->ruta entra NULL (se reserva con malloc) o con lugar ya reservado.
+
+#define RUTA_MAX_PASADAS 20   // pasadas completas de 2-opt como maximo
+
+int planificar_ruta(Caja *caja);
+double largo_ruta(const Caja *caja, const int *ruta);
+
+#endif
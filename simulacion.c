@@ -0,0 +1,650 @@
+// simulacion.c - motor de tiempo virtual para la celda de robots MangoNeado
+// Ejecuta la misma logica de rutina_robot/manejar_falla como simulacion por
+// eventos discretos: nadie duerme, el reloj salta de evento en evento.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "datos.h"
+#include "indice_espacial.h"
+#include "logica_robot.h"
+#include "llegadas.h"
+#include "simulacion.h"
+#include "ventanas.h"
+
+#define EPS_T 1e-9   /* tolerancia para comparar instantes virtuales */
+
+/* Estado de un robot dentro de la simulacion (espejo de RobotInfo sin hilos) */
+typedef struct {
+    int id;
+    double t_start;
+    double t_end;
+    int activo;
+    int daniado;
+    int es_reemplazo;
+    int ocupado;         // tiene un movimiento/etiquetado o una falla en curso
+    int caja_obj;        // caja y mango hacia donde va el brazo
+    int mango_obj;
+    int reserva;         // 1 si mango_obj de caja_obj esta reservado por este robot
+    double t_reserva;    // instante en que reservo mango_obj
+    double arm_x;
+    double arm_y;
+    int ultimo;          // mango donde quedo el brazo (-1 = centro de la caja)
+    int id_caja_actual;
+    int mangos_etiquetados;
+    int cubre;           // reserva (p->reservas): titular cuya ventana cubre (-1 = libre)
+    double t_descubierta; // titular: desde cuando su ventana esta sin robot (-1 = cubierta)
+} RobotSim;
+
+/* Cola de prioridad (heap binario) ordenada por (t, seq) */
+typedef struct {
+    EventoSim *ev;
+    int n;
+    int cap;
+    long seq;
+} ColaEventos;
+
+typedef struct {
+    EstadoSistema *estado;
+    const ParamsSimulacion *p;
+    ResultadoSimulacion *res;
+    RobotSim *robots;
+    double *t_entrada;    // instante de entrada de cada caja
+    IndiceEspacial *indices; // indice de cada caja mientras esta en la banda
+    double tiempo_max;    // s que una caja permanece en la banda
+    double T_ventana;
+    int ingresadas;       // cajas que ya entraron a la banda
+    int primera_activa;   // primera caja que sigue en la banda
+    unsigned int seed;
+    ColaEventos cola;
+    GestorVentanas *gestor;  // ventanas dinamicas (NULL = fijas)
+    double *prox_cruce;   // con gestor: instante del cruce programado de cada caja
+    int *cubierta;        // con gestor: ventanas con robot
+    double *muestra;      // con gestor: mangos sin etiquetar por ventana
+} Simulacion;
+
+/* ------------------ cola de eventos ------------------ */
+static int evento_menor(const EventoSim *a, const EventoSim *b) {
+    if (a->t != b->t) return a->t < b->t;
+    return a->seq < b->seq;
+}
+
+static int cola_push(ColaEventos *c, double t, int tipo, int robot, int caja) {
+    if (c->n == c->cap) {
+        int ncap = c->cap ? c->cap * 2 : 64;
+        EventoSim *nev = realloc(c->ev, sizeof(EventoSim) * (size_t)ncap);
+        if (!nev) return -1;
+        c->ev = nev;
+        c->cap = ncap;
+    }
+    EventoSim e = { t, c->seq++, tipo, robot, caja };
+    int i = c->n++;
+    while (i > 0) {
+        int padre = (i - 1) / 2;
+        if (!evento_menor(&e, &c->ev[padre])) break;
+        c->ev[i] = c->ev[padre];
+        i = padre;
+    }
+    c->ev[i] = e;
+    return 0;
+}
+
+static int cola_pop(ColaEventos *c, EventoSim *out) {
+    if (c->n == 0) return 0;
+    *out = c->ev[0];
+    EventoSim ultimo = c->ev[--c->n];
+    int i = 0;
+    while (1) {
+        int h = 2 * i + 1;
+        if (h >= c->n) break;
+        if (h + 1 < c->n && evento_menor(&c->ev[h + 1], &c->ev[h])) h++;
+        if (!evento_menor(&c->ev[h], &ultimo)) break;
+        c->ev[i] = c->ev[h];
+        i = h;
+    }
+    if (c->n > 0) c->ev[i] = ultimo;
+    return 1;
+}
+
+/* ------------------ fallas / redundancia (virtual) ------------------ */
+static void evaluar_robot(Simulacion *s, RobotSim *r, double ahora);
+static void revisar_cobertura(Simulacion *s, double ahora);
+
+/* ------------------ reservas hot-standby (p->reservas) ------------------ */
+/* La ventana del titular volvio a tener robot: cierra su hueco */
+static void cerrar_hueco(Simulacion *s, RobotSim *t, double ahora) {
+    if (t->t_descubierta < 0.0) return;
+    double hueco = ahora - t->t_descubierta;
+    s->res->huecos++;
+    s->res->hueco_total += hueco;
+    if (hueco > s->res->hueco_max) s->res->hueco_max = hueco;
+    t->t_descubierta = -1.0;
+}
+
+static int reserva_libre(Simulacion *s) {
+    int rmax = s->p->robots_maximos;
+    for (int j = rmax; j < rmax + s->p->reservas; j++)
+        if (!s->robots[j].daniado && s->robots[j].cubre < 0) return j;
+    return -1;
+}
+
+/* La reserva j toma la ventana del titular; el brazo arranca en el centro */
+static void cubrir_con_reserva(Simulacion *s, int titular, int j, double ahora) {
+    RobotSim *c = &s->robots[j];
+    c->cubre = titular;
+    c->es_reemplazo = 1;
+    c->activo = 1;
+    c->t_start = s->robots[titular].t_start;
+    c->t_end = s->robots[titular].t_end;
+    c->id_caja_actual = -1;
+    cerrar_hueco(s, &s->robots[titular], ahora);
+}
+
+/* Falla de un titular o de la reserva que lo cubria: la ventana pasa a otra
+   reserva libre o queda descubierta. Devuelve la reserva que la tomo o -1. */
+static int falla_con_reservas(Simulacion *s, RobotSim *r, double ahora) {
+    int titular = r->id;
+    if (r->id >= s->p->robots_maximos) {
+        titular = r->cubre;
+        r->cubre = -1;
+        r->es_reemplazo = 0;
+    }
+    if (titular < 0) return -1;
+    int j = reserva_libre(s);
+    if (j >= 0) cubrir_con_reserva(s, titular, j, ahora);
+    else s->robots[titular].t_descubierta = ahora;
+    return j;
+}
+
+/* Una reserva quedo libre: cubre la ventana descubierta hace mas tiempo */
+static void cubrir_pendiente(Simulacion *s, int j, double ahora) {
+    int elegido = -1;
+    for (int i = 0; i < s->p->robots_maximos; i++) {
+        RobotSim *t = &s->robots[i];
+        if (t->t_descubierta < 0.0) continue;
+        if (elegido < 0 || t->t_descubierta < s->robots[elegido].t_descubierta) elegido = i;
+    }
+    if (elegido < 0) return;
+    cubrir_con_reserva(s, elegido, j, ahora);
+    evaluar_robot(s, &s->robots[j], ahora);
+}
+
+/* El titular vuelve a su ventana y suelta a su reserva; una reserva reparada
+   queda libre. La reserva libre cubre otra ventana si hay alguna descubierta. */
+static void reparar_con_reservas(Simulacion *s, RobotSim *r, double ahora) {
+    int rmax = s->p->robots_maximos;
+    int libre = r->id;
+    r->daniado = 0;
+    if (r->id < rmax) {
+        r->activo = 1;
+        cerrar_hueco(s, r, ahora);
+        libre = -1;
+        for (int j = rmax; j < rmax + s->p->reservas; j++) {
+            RobotSim *c = &s->robots[j];
+            if (c->cubre != r->id) continue;
+            /* si esta a mitad de un mango lo termina y luego queda libre */
+            c->cubre = -1;
+            c->es_reemplazo = 0;
+            c->activo = 0;
+            libre = j;
+            break;
+        }
+        evaluar_robot(s, r, ahora);
+    }
+    if (libre >= 0) cubrir_pendiente(s, libre, ahora);
+}
+
+/* Con reservas, la ventana k tambien puede tenerla una reserva */
+static void evaluar_cubre(Simulacion *s, int k, double ahora) {
+    int rmax = s->p->robots_maximos;
+    for (int j = rmax; j < rmax + s->p->reservas; j++)
+        if (s->robots[j].cubre == k) evaluar_robot(s, &s->robots[j], ahora);
+}
+
+/* Igual que manejar_falla: marcar daniado y activar el primer reemplazo libre
+   (con p->reservas, como el supervisor: una reserva toma su ventana) */
+static void falla_sim(Simulacion *s, RobotSim *r, double ahora) {
+    int rmax = s->p->robots_maximos;
+    if (r->reserva) {
+        /* el brazo no llego: el mango vuelve a quedar libre para otro robot */
+        liberar_mango(&s->estado->cajas[r->caja_obj].mangos[r->mango_obj], r->id);
+        r->reserva = 0;
+    }
+    r->ocupado = 0;
+    r->daniado = 1;
+    r->activo = 0;
+    s->res->fallas++;
+
+    int found = -1;
+    if (s->p->reservas > 0) {
+        found = falla_con_reservas(s, r, ahora);
+    } else {
+        for (int i = 0; i < rmax; i++) {
+            RobotSim *c = &s->robots[i];
+            if (c == r) continue;
+            if (!c->activo && !c->daniado && !c->es_reemplazo) {
+                c->es_reemplazo = 1;
+                c->activo = 1;
+                found = i;
+                break;
+            }
+        }
+        if (found < 0) r->t_descubierta = ahora;   /* hueco hasta la reparacion */
+    }
+    if (found < 0) s->res->fallas_sin_reemplazo++;
+    if (s->p->verbose) {
+        if (found >= 0)
+            printf("[t=%8.2f] Robot %d se danio -> Robot %d activado como reemplazo\n", ahora, r->id, found);
+        else
+            printf("[t=%8.2f] Robot %d se danio -> NO HAY reemplazo disponible\n", ahora, r->id);
+    }
+
+    /* reparacion despues de un tiempo aleatorio 1..5 s */
+    int repair_time = 1 + (rand_r(&s->seed) % 5);
+    cola_push(&s->cola, ahora + repair_time, EV_ROBOT_REPARADO, r->id, -1);
+
+    if (s->gestor) revisar_cobertura(s, ahora);
+    if (found >= 0) evaluar_robot(s, &s->robots[found], ahora);
+}
+
+/* Igual que recuperar_robot: reactivar y apagar el primer reemplazo encontrado */
+static void reparar_sim(Simulacion *s, RobotSim *r, double ahora) {
+    if (s->p->reservas > 0) {
+        reparar_con_reservas(s, r, ahora);
+        return;
+    }
+    int rmax = s->p->robots_maximos;
+    r->daniado = 0;
+    r->activo = 1;
+    cerrar_hueco(s, r, ahora);
+
+    for (int i = 0; i < rmax; i++) {
+        RobotSim *c = &s->robots[i];
+        if (c == r) continue;
+        if (c->es_reemplazo) {
+            /* si esta a mitad de un mango lo termina y luego se detiene */
+            c->es_reemplazo = 0;
+            c->activo = 0;
+            if (s->p->verbose)
+                printf("[t=%8.2f] Robot %d recuperado -> Robot %d (reemplazo) DESACTIVADO\n", ahora, r->id, i);
+            break;
+        }
+    }
+    if (s->gestor) revisar_cobertura(s, ahora);
+    evaluar_robot(s, r, ahora);
+}
+
+/* ------------------ decision del robot ------------------ */
+/* Una pasada de rutina_robot sobre las cajas en la banda. Devuelve 1 si el
+   robot inicio una accion (movimiento o falla). */
+static int pasada_robot(Simulacion *s, RobotSim *r, double ahora) {
+    for (int ci = s->primera_activa; ci < s->ingresadas; ci++) {
+        Caja *caja = &s->estado->cajas[ci];
+        double t_caja = ahora - s->t_entrada[ci];
+
+        if (t_caja + EPS_T >= s->tiempo_max) continue;
+        if (t_caja + EPS_T < r->t_start || t_caja + EPS_T >= r->t_end) continue;
+
+        if (caja->id != r->id_caja_actual) {
+            r->id_caja_actual = caja->id;
+            r->arm_x = 0.0;
+            r->arm_y = 0.0;
+            r->ultimo = -1;
+        }
+
+        DecisionRobot dec;
+        if (!decidir_en_caja(caja, &s->indices[ci], t_caja, r->t_end, r->arm_x, r->arm_y, r->ultimo, &dec))
+            continue;
+        if (!reservar_mango(&caja->mangos[dec.idx], r->id)) {
+            s->res->intentos_duplicados++;
+            continue;
+        }
+        r->caja_obj = ci;
+        r->mango_obj = dec.idx;
+        r->reserva = 1;
+        r->t_reserva = ahora;
+
+        /* probabilidad de fallo antes de iniciar la accion */
+        double p_tick = s->p->prob_fallo * DT_SECS;
+        double rrand = (double)rand_r(&s->seed) / (double)RAND_MAX;
+        r->ocupado = 1;
+        if (rrand < p_tick) {
+            cola_push(&s->cola, ahora, EV_ROBOT_FALLA, r->id, ci);
+            return 1;
+        }
+
+        cola_push(&s->cola, ahora + (dec.t_total - T_ETIQUETA), EV_BRAZO_LLEGA, r->id, ci);
+        return 1;
+    }
+    return 0;
+}
+
+/* Un robot ocioso en tiempo real vuelve a mirar la banda cada DT_SECS; solo el
+   reinicio del brazo al cambiar de caja puede cambiar su decision sin que
+   ocurra un evento, y eso se estabiliza en dos pasadas. */
+static void evaluar_robot(Simulacion *s, RobotSim *r, double ahora) {
+    if (r->ocupado || r->daniado) return;
+    if (!r->activo && !r->es_reemplazo) return;
+    if (!pasada_robot(s, r, ahora)) pasada_robot(s, r, ahora);
+}
+
+/* ------------------ ventanas dinamicas ------------------ */
+/* Programa el proximo cruce de borde de la caja ci segun los bordes
+   actuales. Un cruce programado con bordes viejos queda descartado porque
+   ya no coincide con prox_cruce. */
+static void programar_cruce(Simulacion *s, int ci, double ahora) {
+    const double *bordes = s->gestor->bordes;
+    int k = ventana_en(bordes, s->gestor->n, ahora - s->t_entrada[ci] + EPS_T);
+    double t_sig = k >= 0 ? s->t_entrada[ci] + bordes[k + 1] : INFINITY;
+    if (t_sig >= s->t_entrada[ci] + s->tiempo_max) t_sig = INFINITY;
+    if (t_sig == s->prox_cruce[ci]) return;
+    s->prox_cruce[ci] = t_sig;
+    if (t_sig < INFINITY) cola_push(&s->cola, t_sig, EV_CAJA_EN_VENTANA, k + 1, ci);
+}
+
+/* Los robots toman los bordes nuevos, las cajas en la banda reprograman su
+   cruce y cada robot libre vuelve a mirar con su ventana nueva */
+static void aplicar_bordes(Simulacion *s, double ahora) {
+    int rmax = s->p->robots_maximos;
+    s->res->repartos++;
+    for (int i = 0; i < rmax; i++) {
+        s->robots[i].t_start = s->gestor->bordes[i];
+        s->robots[i].t_end = s->gestor->bordes[i + 1];
+    }
+    for (int ci = s->primera_activa; ci < s->ingresadas; ci++) programar_cruce(s, ci, ahora);
+    for (int i = 0; i < rmax; i++) evaluar_robot(s, &s->robots[i], ahora);
+}
+
+/* Despues de una falla o una reparacion: la ventana sin robot se reparte
+   entre sus vecinas y la que vuelve a tener robot recupera su parte */
+static void revisar_cobertura(Simulacion *s, double ahora) {
+    for (int i = 0; i < s->p->robots_maximos; i++) {
+        RobotSim *r = &s->robots[i];
+        s->cubierta[i] = (r->activo || r->es_reemplazo) && !r->daniado;
+    }
+    if (ventanas_cobertura(s->gestor, s->cubierta)) aplicar_bordes(s, ahora);
+}
+
+/* Cruce de borde con ventanas dinamicas: la ventana se deduce de los bordes
+   actuales, no del indice con el que se programo el evento */
+static void cruce_dinamico(Simulacion *s, const EventoSim *e) {
+    int ci = e->caja;
+    if (e->t != s->prox_cruce[ci]) return;
+    if (ci == s->ingresadas) {
+        construir_indice(&s->indices[ci], &s->estado->cajas[ci]);
+        s->ingresadas = ci + 1;
+        if (ci + 1 < s->estado->num_cajas) {
+            s->prox_cruce[ci + 1] = s->t_entrada[ci + 1];
+            cola_push(&s->cola, s->t_entrada[ci + 1], EV_CAJA_EN_VENTANA, 0, ci + 1);
+        }
+        cola_push(&s->cola, s->t_entrada[ci] + s->tiempo_max, EV_CAJA_SALE, -1, ci);
+    }
+    int k = ventana_en(s->gestor->bordes, s->gestor->n, e->t - s->t_entrada[ci] + EPS_T);
+    if (k >= 0) evaluar_robot(s, &s->robots[k], e->t);
+    programar_cruce(s, ci, e->t);
+}
+
+/* Cada VENTANAS_PERIODO_S: muestra de mangos sin etiquetar por ventana y un
+   paso del reparto por carga, mientras haya cajas por venir o en la banda */
+static void reparto_periodico(Simulacion *s, double ahora) {
+    GestorVentanas *g = s->gestor;
+    for (int k = 0; k < g->n; k++) s->muestra[k] = 0.0;
+    for (int ci = s->primera_activa; ci < s->ingresadas; ci++) {
+        int k = ventana_en(g->bordes, g->n, ahora - s->t_entrada[ci] + EPS_T);
+        if (k >= 0) s->muestra[k] += indice_restantes(&s->indices[ci]);
+    }
+    for (int k = 0; k < g->n; k++) ventanas_medir(g, k, s->muestra[k]);
+    if (ventanas_por_carga(g)) aplicar_bordes(s, ahora);
+    if (s->ingresadas < s->estado->num_cajas || s->primera_activa < s->ingresadas)
+        cola_push(&s->cola, ahora + VENTANAS_PERIODO_S, EV_REPARTO, -1, -1);
+}
+
+/* ------------------ procesamiento de eventos ------------------ */
+static void procesar_evento(Simulacion *s, const EventoSim *e) {
+    RobotSim *r = (e->robot >= 0) ? &s->robots[e->robot] : NULL;
+    int rmax = s->p->robots_maximos;
+
+    switch (e->tipo) {
+    case EV_CAJA_EN_VENTANA: {
+        if (s->gestor) {
+            cruce_dinamico(s, e);
+            break;
+        }
+        int ci = e->caja;
+        int k = e->robot;   /* indice de ventana == indice fisico del robot */
+        if (k == 0) {
+            construir_indice(&s->indices[ci], &s->estado->cajas[ci]);
+            s->ingresadas = ci + 1;
+            if (ci + 1 < s->estado->num_cajas)
+                cola_push(&s->cola, s->t_entrada[ci + 1], EV_CAJA_EN_VENTANA, 0, ci + 1);
+        }
+        evaluar_robot(s, r, e->t);
+        if (s->p->reservas > 0) evaluar_cubre(s, k, e->t);
+        double t_sig = (k + 1 < rmax) ? s->t_entrada[ci] + s->robots[k + 1].t_start : INFINITY;
+        if (t_sig < s->t_entrada[ci] + s->tiempo_max)
+            cola_push(&s->cola, t_sig, EV_CAJA_EN_VENTANA, k + 1, ci);
+        else
+            cola_push(&s->cola, s->t_entrada[ci] + s->tiempo_max, EV_CAJA_SALE, -1, ci);
+        break;
+    }
+    case EV_BRAZO_LLEGA:
+        cola_push(&s->cola, e->t + T_ETIQUETA, EV_ETIQUETA_LISTA, e->robot, e->caja);
+        break;
+    case EV_ETIQUETA_LISTA: {
+        Caja *caja = &s->estado->cajas[e->caja];
+        Mango *m = &caja->mangos[r->mango_obj];
+        r->reserva = 0;
+        if (etiquetar_mango(m, r->id)) {
+            indice_quitar(&s->indices[e->caja], caja, r->mango_obj);
+            r->mangos_etiquetados++;
+            s->res->mangos_etiquetados++;
+            if (s->res->num_latencias < s->p->max_latencias)
+                s->p->latencias[s->res->num_latencias++] = e->t - r->t_reserva;
+            if (s->p->verbose)
+                printf("[t=%8.2f] Robot %d: etiqueto mango %d en caja %d (pos %.2f, %.2f)\n",
+                       e->t, r->id, m->id, caja->id, m->x, m->y);
+        } else {
+            /* ya etiquetado por otro robot */
+            s->res->duplicados++;
+        }
+        r->arm_x = m->x;
+        r->arm_y = m->y;
+        r->ultimo = r->mango_obj;
+        r->ocupado = 0;
+        evaluar_robot(s, r, e->t);
+        break;
+    }
+    case EV_ROBOT_FALLA:
+        falla_sim(s, r, e->t);
+        break;
+    case EV_ROBOT_REPARADO:
+        reparar_sim(s, r, e->t);
+        break;
+    case EV_CAJA_SALE:
+        while (s->primera_activa < s->ingresadas &&
+               s->t_entrada[s->primera_activa] + s->tiempo_max <= e->t + EPS_T)
+            liberar_indice(&s->indices[s->primera_activa++]);
+        s->res->tiempo_simulado = e->t;
+        break;
+    case EV_REPARTO:
+        reparto_periodico(s, e->t);
+        break;
+    }
+}
+
+/* ------------------ API ------------------ */
+static void liberar_simulacion(Simulacion *s) {
+    if (s->gestor) liberar_gestor_ventanas(s->gestor);
+    free(s->cola.ev);
+    free(s->robots);
+    free(s->t_entrada);
+    free(s->indices);
+    free(s->prox_cruce);
+    free(s->cubierta);
+    free(s->muestra);
+}
+
+void params_simulacion_default(ParamsSimulacion *p, const EstadoSistema *estado, int robots_maximos) {
+    memset(p, 0, sizeof(*p));
+    p->num_robots = estado->num_robots;
+    p->robots_maximos = robots_maximos;
+    p->separacion_cajas = 0.0;
+    p->prob_fallo = PROB_FALLO;
+    p->semilla = 1;
+    p->verbose = 0;
+    p->ventanas_dinamicas = 0;
+}
+
+/* Corre la banda completa en tiempo virtual. Reinicia y deja en estado->cajas
+   las marcas de etiquetado, igual que el modo en tiempo real. */
+int simular_banda(EstadoSistema *estado, const ParamsSimulacion *p, ResultadoSimulacion *res) {
+    if (!estado || !p || !res || estado->num_cajas <= 0 || p->robots_maximos <= 0) return -1;
+    if (p->reservas < 0 || (p->reservas > 0 && p->ventanas_dinamicas)) return -1;
+    memset(res, 0, sizeof(*res));
+
+    Simulacion s;
+    memset(&s, 0, sizeof(s));
+    s.estado = estado;
+    s.p = p;
+    s.res = res;
+    s.seed = p->semilla;
+
+    double tiempo_maximo = estado->longitud_banda / estado->velocidad_banda;
+    s.T_ventana = tiempo_maximo / (double)p->robots_maximos;
+    s.tiempo_max = ceil(tiempo_maximo);
+    double sep = p->separacion_cajas > 0.0 ? p->separacion_cajas : ceil(s.T_ventana);
+    Llegadas llegadas;
+    if (p->llegadas) {
+        /* copia propia: cada corrida repite la secuencia desde el principio */
+        llegadas = *p->llegadas;
+        reiniciar_llegadas(&llegadas);
+    }
+
+    GestorVentanas gestor;
+    s.robots = calloc((size_t)(p->robots_maximos + p->reservas), sizeof(RobotSim));
+    s.t_entrada = malloc(sizeof(double) * (size_t)estado->num_cajas);
+    s.indices = calloc((size_t)estado->num_cajas, sizeof(IndiceEspacial));
+    if (!s.robots || !s.t_entrada || !s.indices) {
+        liberar_simulacion(&s);
+        return -1;
+    }
+    if (p->ventanas_dinamicas) {
+        s.prox_cruce = malloc(sizeof(double) * (size_t)estado->num_cajas);
+        s.cubierta = malloc(sizeof(int) * (size_t)p->robots_maximos);
+        s.muestra = malloc(sizeof(double) * (size_t)p->robots_maximos);
+        if (!s.prox_cruce || !s.cubierta || !s.muestra ||
+            iniciar_gestor_ventanas(&gestor, p->robots_maximos, s.T_ventana * p->robots_maximos) != 0) {
+            liberar_simulacion(&s);
+            return -1;
+        }
+        s.gestor = &gestor;
+    }
+
+    for (int i = 0; i < estado->num_cajas; i++) {
+        Caja *c = &estado->cajas[i];
+        if (p->llegadas)
+            s.t_entrada[i] = proxima_llegada(&llegadas, i > 0 ? separacion_fisica(c - 1, estado->velocidad_banda) : 0.0);
+        else
+            s.t_entrada[i] = i * sep;
+        for (int j = 0; j < c->num_mangos; j++) c->mangos[j].etiquetado = 0;
+        res->mangos_totales += c->num_mangos;
+    }
+    for (int i = 0; i < p->robots_maximos + p->reservas; i++) {
+        RobotSim *r = &s.robots[i];
+        r->id = i;
+        /* las reservas no tienen ventana hasta que toman una */
+        if (i < p->robots_maximos) {
+            r->t_start = i * s.T_ventana;
+            r->t_end = (i + 1) * s.T_ventana;
+        }
+        r->activo = (i < p->num_robots);
+        r->id_caja_actual = -1;
+        r->ultimo = -1;
+        r->cubre = -1;
+        r->t_descubierta = -1.0;
+    }
+    if (s.gestor) {
+        /* las ventanas sin robot desde el principio se reparten ya */
+        for (int i = 0; i < estado->num_cajas; i++) s.prox_cruce[i] = INFINITY;
+        s.prox_cruce[0] = s.t_entrada[0];
+        for (int i = 0; i < p->robots_maximos; i++) {
+            s.robots[i].t_start = gestor.bordes[i];
+            s.robots[i].t_end = gestor.bordes[i + 1];
+        }
+        revisar_cobertura(&s, 0.0);
+        cola_push(&s.cola, s.t_entrada[0] + VENTANAS_PERIODO_S, EV_REPARTO, -1, -1);
+    }
+
+    if (cola_push(&s.cola, s.t_entrada[0], EV_CAJA_EN_VENTANA, 0, 0) != 0) {
+        liberar_simulacion(&s);
+        return -1;
+    }
+
+    EventoSim e;
+    while (cola_pop(&s.cola, &e)) {
+        res->eventos++;
+        procesar_evento(&s, &e);
+    }
+
+    for (int i = 0; i < estado->num_cajas; i++) liberar_indice(&s.indices[i]);
+    liberar_simulacion(&s);
+    return 0;
+}
+
+/* ------------------ tasa maxima sostenible ------------------ */
+/* Fraccion de mangos etiquetados con una caja cada `sep` s (-1 si falla) */
+static double etiquetado_con(EstadoSistema *estado, const ParamsSimulacion *p, double sep) {
+    ParamsSimulacion q = *p;
+    Llegadas fija;
+    ResultadoSimulacion res;
+    iniciar_llegadas_fija(&fija, sep);
+    q.llegadas = &fija;
+    q.verbose = 0;
+    q.latencias = NULL;
+    q.max_latencias = 0;
+    if (simular_banda(estado, &q, &res) != 0) return -1.0;
+    return res.mangos_totales > 0 ? (double)res.mangos_etiquetados / res.mangos_totales : 1.0;
+}
+
+/* Separacion fija mas corta (s) que etiqueta como la banda con una caja a la
+   vez; 0 = las cajas pegadas (solo la separacion fisica), -1 = error. En
+   *etiquetado_base queda la fraccion de referencia. Al terminar deja
+   estado->cajas sin marcas, para la corrida de verdad (tambien en tiempo real). */
+double separacion_sostenible(EstadoSistema *estado, const ParamsSimulacion *p, double *etiquetado_base) {
+    double hi = estado->longitud_banda / estado->velocidad_banda;
+    double base = etiquetado_con(estado, p, hi);
+    if (base < 0.0) return -1.0;
+    if (etiquetado_base) *etiquetado_base = base;
+    double objetivo = base - SOSTENIBLE_TOLERANCIA;
+
+    double lo = 0.0;
+    double e = etiquetado_con(estado, p, lo);
+    if (e >= objetivo) hi = lo;
+    /* invariante: lo pierde de mas, hi no */
+    while (e >= 0.0 && hi - lo > SOSTENIBLE_PRECISION) {
+        double mid = 0.5 * (lo + hi);
+        e = etiquetado_con(estado, p, mid);
+        if (e >= objetivo) hi = mid;
+        else lo = mid;
+    }
+    for (int i = 0; i < estado->num_cajas; i++)
+        for (int j = 0; j < estado->cajas[i].num_mangos; j++) estado->cajas[i].mangos[j].etiquetado = 0;
+    return e < 0.0 ? -1.0 : hi;
+}
+
+void imprimir_resultado_simulacion(const EstadoSistema *estado, const ResultadoSimulacion *res) {
+    printf("\n=== RESULTADO SIMULACION (tiempo virtual) ===\n");
+    for (int i = 0; i < estado->num_cajas; i++) {
+        const Caja *c = &estado->cajas[i];
+        int etiq = 0;
+        for (int j = 0; j < c->num_mangos; j++) etiq += mango_etiquetado(&c->mangos[j]);
+        printf("Caja #%d: %d/%d mangos etiquetados\n", c->id, etiq, c->num_mangos);
+    }
+    printf("Tiempo simulado: %.2f s | eventos: %ld\n", res->tiempo_simulado, res->eventos);
+    printf("Mangos etiquetados: %d/%d | duplicados: %d (intentos: %d) | fallas: %d (sin reemplazo: %d)\n",
+           res->mangos_etiquetados, res->mangos_totales, res->duplicados,
+           res->intentos_duplicados, res->fallas, res->fallas_sin_reemplazo);
+    if (res->repartos > 0) printf("Ventanas dinamicas: %d repartos de la banda\n", res->repartos);
+}
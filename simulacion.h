@@ -0,0 +1,75 @@
+#ifndef SIMULACION_H
+#define SIMULACION_H
+
+#include "datos.h"
+#include "llegadas.h"
+
+// ---------- SIMULACION POR EVENTOS DISCRETOS (TIEMPO VIRTUAL) ----------
+
+// Tipos de evento de la cola de prioridad
+typedef enum {
+    EV_CAJA_EN_VENTANA = 0, // una caja entra a la ventana de un robot
+    EV_BRAZO_LLEGA,         // el brazo llego al mango elegido
+    EV_ETIQUETA_LISTA,      // termino de pegar la etiqueta
+    EV_ROBOT_FALLA,         // el robot falla antes de iniciar un movimiento
+    EV_ROBOT_REPARADO,      // termina la reparacion del robot
+    EV_CAJA_SALE,           // la caja sale de la banda
+    EV_REPARTO              // ventanas dinamicas: medir carga y repartir la banda
+} TipoEvento;
+
+// Tasa maxima sostenible (separacion_sostenible): la banda mas densa que
+// todavia etiqueta lo mismo que con una sola caja a la vez en la banda, salvo
+// SOSTENIBLE_TOLERANCIA de los mangos. Busqueda binaria sobre la separacion
+// fija, con los mismos robots, fallas y semilla de la corrida.
+#define SOSTENIBLE_TOLERANCIA 0.01   // fraccion de mangos que se puede perder por la densidad
+#define SOSTENIBLE_PRECISION 0.01    // s: ancho del intervalo en que termina la busqueda
+
+typedef struct {
+    double t;       // instante virtual (s)
+    long seq;       // desempate FIFO para eventos simultaneos
+    int tipo;       // TipoEvento
+    int robot;      // indice del robot (-1 si no aplica)
+    int caja;       // indice de la caja (-1 si no aplica)
+} EventoSim;
+
+// Parametros de una corrida
+typedef struct {
+    int num_robots;          // robots activos al inicio
+    int robots_maximos;      // robots fisicos (activos + reemplazos)
+    double separacion_cajas; // s entre entradas de cajas (<= 0: ceil(T_ventana))
+    const Llegadas *llegadas; // opcional: proceso de llegadas (NULL = separacion_cajas)
+    double prob_fallo;       // fallos por segundo (se aplica * DT_SECS por accion)
+    unsigned int semilla;    // semilla del generador (rand_r)
+    int verbose;             // 1 = imprime cada etiqueta/falla
+    int ventanas_dinamicas;  // 1 = anchos de ventana segun cobertura y carga (ventanas.h)
+    double *latencias;       // opcional: s desde que el robot reserva el mango hasta etiquetarlo
+    int max_latencias;       // lugar en latencias (0 = no se guardan)
+    int reservas;            // robots hot-standby sin ventana (ids robots_maximos..): toman la
+                             // ventana del que falla y la devuelven al repararse, como el
+                             // supervisor. 0 = los robots sin activar se activan en su propia
+                             // ventana. No se combina con ventanas_dinamicas.
+} ParamsSimulacion;
+
+// Resultado agregado de una corrida
+typedef struct {
+    long eventos;             // eventos procesados
+    double tiempo_simulado;   // s virtuales hasta que salio la ultima caja
+    int mangos_totales;
+    int mangos_etiquetados;
+    int duplicados;           // llegadas a un mango ya etiquetado por otro robot
+    int intentos_duplicados;  // reservas perdidas: otro robot ya iba hacia ese mango
+    int fallas;
+    int fallas_sin_reemplazo;
+    int num_latencias;        // latencias guardadas en p->latencias
+    int repartos;             // veces que cambiaron los bordes de las ventanas
+    int huecos;               // fallas que dejaron su ventana sin robot
+    double hueco_total;       // s de ventana sin robot por fallas (suma de los huecos)
+    double hueco_max;         // hueco mas largo (s)
+} ResultadoSimulacion;
+
+void params_simulacion_default(ParamsSimulacion *p, const EstadoSistema *estado, int robots_maximos);
+int simular_banda(EstadoSistema *estado, const ParamsSimulacion *p, ResultadoSimulacion *res);
+double separacion_sostenible(EstadoSistema *estado, const ParamsSimulacion *p, double *etiquetado_base);
+void imprimir_resultado_simulacion(const EstadoSistema *estado, const ResultadoSimulacion *res);
+
+#endif
@@ -0,0 +1,173 @@
+// snapshot.c - grabar el estado escaneado a un archivo y reproducirlo con mmap
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "datos.h"
+#include "snapshot.h"
+
+static uint64_t alinear(uint64_t n) {
+    return (n + SNAPSHOT_ALINEACION - 1) & ~(uint64_t)(SNAPSHOT_ALINEACION - 1);
+}
+
+static int escribir_relleno(FILE *f, uint64_t *pos, uint64_t hasta) {
+    static const unsigned char ceros[SNAPSHOT_ALINEACION];
+    size_t n = (size_t)(hasta - *pos);
+    if (n && fwrite(ceros, 1, n, f) != n) return -1;
+    *pos = hasta;
+    return 0;
+}
+
+/* ------------------ grabar_snapshot ------------------ */
+/* Escribe cabecera, cajas (con desplazamientos en vez de punteros) y los
+   arreglos de cada caja en orden. Devuelve 0 si pudo, -1 si no. */
+int grabar_snapshot(const char *archivo, const EstadoSistema *estado, int robots_maximos) {
+    if (!archivo || !estado || !estado->cajas || estado->num_cajas <= 0) return -1;
+    int n = estado->num_cajas;
+
+    Caja *tabla = malloc(sizeof(Caja) * (size_t)n);
+    if (!tabla) {
+        perror("malloc(snapshot)");
+        return -1;
+    }
+    uint64_t pos = alinear(sizeof(SnapshotCabecera));
+    uint64_t off_cajas = pos;
+    pos = alinear(pos + sizeof(Caja) * (uint64_t)n);
+    for (int i = 0; i < n; i++) {
+        const Caja *c = &estado->cajas[i];
+        tabla[i] = *c;
+        tabla[i].mangos = (Mango *)(uintptr_t)pos;
+        pos = alinear(pos + sizeof(Mango) * (uint64_t)c->num_mangos);
+        tabla[i].ruta = NULL;
+        if (c->ruta) {
+            tabla[i].ruta = (int *)(uintptr_t)pos;
+            pos = alinear(pos + sizeof(int) * (uint64_t)c->num_mangos);
+        }
+    }
+
+    SnapshotCabecera cab;
+    memset(&cab, 0, sizeof(cab));
+    cab.magic = SNAPSHOT_MAGIC;
+    cab.version = SNAPSHOT_VERSION;
+    cab.tam_caja = sizeof(Caja);
+    cab.tam_mango = sizeof(Mango);
+    cab.tamanio = pos;
+    cab.robots_maximos = robots_maximos;
+    cab.estado = *estado;
+    cab.estado.cajas = (Caja *)(uintptr_t)off_cajas;
+
+    FILE *f = fopen(archivo, "wb");
+    if (!f) {
+        perror("fopen(snapshot)");
+        free(tabla);
+        return -1;
+    }
+    int rc = 0;
+    pos = 0;
+    if (fwrite(&cab, sizeof(cab), 1, f) != 1) rc = -1;
+    pos += sizeof(cab);
+    if (rc == 0) rc = escribir_relleno(f, &pos, off_cajas);
+    if (rc == 0 && fwrite(tabla, sizeof(Caja), (size_t)n, f) != (size_t)n) rc = -1;
+    pos += sizeof(Caja) * (uint64_t)n;
+    for (int i = 0; i < n && rc == 0; i++) {
+        const Caja *c = &estado->cajas[i];
+        size_t m = (size_t)c->num_mangos;
+        rc = escribir_relleno(f, &pos, (uint64_t)(uintptr_t)tabla[i].mangos);
+        if (rc == 0 && m && fwrite(c->mangos, sizeof(Mango), m, f) != m) rc = -1;
+        pos += sizeof(Mango) * (uint64_t)m;
+        if (rc == 0 && c->ruta) {
+            rc = escribir_relleno(f, &pos, (uint64_t)(uintptr_t)tabla[i].ruta);
+            if (rc == 0 && m && fwrite(c->ruta, sizeof(int), m, f) != m) rc = -1;
+            pos += sizeof(int) * (uint64_t)m;
+        }
+    }
+    if (rc == 0) rc = escribir_relleno(f, &pos, cab.tamanio);
+    if (fclose(f) != 0) rc = -1;
+    if (rc != 0) perror("grabar_snapshot");
+    free(tabla);
+    return rc;
+}
+
+/* Un desplazamiento del archivo es valido si el arreglo entra completo y
+   esta alineado */
+static int rango_valido(uint64_t off, uint64_t bytes, uint64_t tamanio) {
+    return off % SNAPSHOT_ALINEACION == 0 && off <= tamanio && bytes <= tamanio - off;
+}
+
+/* ------------------ abrir_snapshot ------------------ */
+/* Mapea el archivo y devuelve el estado que vive dentro del mapeo. Solo se
+   recorren la tabla de cajas y las rutas (para validar indices); los mangos
+   no se tocan hasta que los usa un robot. Liberar con cerrar_snapshot. */
+EstadoSistema *abrir_snapshot(const char *archivo, int *robots_maximos) {
+    int fd = open(archivo, O_RDONLY);
+    if (fd < 0) {
+        perror("open(snapshot)");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(SnapshotCabecera)) {
+        fprintf(stderr, "Snapshot %s: archivo demasiado chico\n", archivo);
+        close(fd);
+        return NULL;
+    }
+    uint64_t tamanio = (uint64_t)st.st_size;
+    unsigned char *base = mmap(NULL, (size_t)tamanio, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap(snapshot)");
+        return NULL;
+    }
+
+    SnapshotCabecera *cab = (SnapshotCabecera *)base;
+    EstadoSistema *estado = &cab->estado;
+    const char *error = NULL;
+    if (cab->magic != SNAPSHOT_MAGIC) error = "no es un snapshot (o es de otro orden de bytes)";
+    else if (cab->version != SNAPSHOT_VERSION) error = "version no soportada";
+    else if (cab->tam_caja != sizeof(Caja) || cab->tam_mango != sizeof(Mango)) error = "grabado en otra arquitectura";
+    else if (cab->tamanio != tamanio) error = "tamanio no coincide (archivo truncado)";
+    else if (estado->num_cajas <= 0 ||
+             !rango_valido((uint64_t)(uintptr_t)estado->cajas, sizeof(Caja) * (uint64_t)estado->num_cajas, tamanio))
+        error = "tabla de cajas invalida";
+
+    /* corregir punteros: desplazamiento -> direccion dentro del mapeo */
+    if (!error) {
+        estado->cajas = (Caja *)(base + (uintptr_t)estado->cajas);
+        for (int i = 0; i < estado->num_cajas && !error; i++) {
+            Caja *c = &estado->cajas[i];
+            uint64_t m = (uint64_t)(c->num_mangos < 0 ? 0 : c->num_mangos);
+            uint64_t off_m = (uint64_t)(uintptr_t)c->mangos;
+            uint64_t off_r = (uint64_t)(uintptr_t)c->ruta;
+            if (c->num_mangos < 0 || !rango_valido(off_m, sizeof(Mango) * m, tamanio) ||
+                (off_r && !rango_valido(off_r, sizeof(int) * m, tamanio))) {
+                error = "caja fuera del archivo";
+                break;
+            }
+            c->mangos = (Mango *)(base + off_m);
+            c->ruta = off_r ? (int *)(base + off_r) : NULL;
+            for (uint64_t k = 0; c->ruta && k < m; k++)
+                if (c->ruta[k] < 0 || (uint64_t)c->ruta[k] >= m) error = "ruta invalida";
+        }
+    }
+    if (error) {
+        fprintf(stderr, "Snapshot %s: %s\n", archivo, error);
+        munmap(base, (size_t)tamanio);
+        return NULL;
+    }
+
+    if (robots_maximos) *robots_maximos = cab->robots_maximos;
+    return estado;
+}
+
+/* El estado esta dentro de la cabecera: de ahi salen el inicio y el largo del mapeo */
+void cerrar_snapshot(EstadoSistema *estado) {
+    if (!estado) return;
+    SnapshotCabecera *cab = (SnapshotCabecera *)((unsigned char *)estado - offsetof(SnapshotCabecera, estado));
+    munmap(cab, (size_t)cab->tamanio);
+}
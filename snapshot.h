@@ -0,0 +1,40 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "datos.h"
+
+// ---------- SNAPSHOT DEL ESTADO ESCANEADO ----------
+// Archivo con el EstadoSistema tal como queda en memoria (orden de bytes y
+// tamanios de la maquina que lo grabo): cabecera, arreglo de Caja y despues
+// los mangos y la ruta de cada caja, alineados a SNAPSHOT_ALINEACION. Los
+// punteros de cada Caja se guardan como desplazamientos desde el inicio del
+// archivo (0 = sin ruta).
+// Para reproducir se mapea el archivo con MAP_PRIVATE y solo se corrigen esos
+// punteros: los mangos se usan en el lugar, sin decodificarlos ni copiarlos,
+// y lo que etiqueten los robots no vuelve al archivo.
+//
+//   escaner -G <archivo>   graba el estado escaneado y termina
+//   robot   -R <archivo>   corre sobre el snapshot, sin conectarse al escaner
+
+#define SNAPSHOT_MAGIC      0x53474E4Du  // "MNGS" leido en little-endian
+#define SNAPSHOT_VERSION    1
+#define SNAPSHOT_ALINEACION 16
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tam_caja;       // sizeof(Caja) y sizeof(Mango) de quien grabo:
+    uint32_t tam_mango;      // rechaza archivos de otra arquitectura
+    uint64_t tamanio;        // bytes del archivo completo
+    int32_t robots_maximos;
+    int32_t reservado;
+    EstadoSistema estado;    // estado.cajas = desplazamiento del arreglo de Caja
+} SnapshotCabecera;
+
+int grabar_snapshot(const char *archivo, const EstadoSistema *estado, int robots_maximos);
+EstadoSistema *abrir_snapshot(const char *archivo, int *robots_maximos);
+void cerrar_snapshot(EstadoSistema *estado);
+
+#endif
@@ -0,0 +1,580 @@
+// supervisor.c - fallas, reemplazos de reserva y reparaciones con rueda de tiempos
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "datos.h"
+#include "afinidad.h"
+#include "bitacora.h"
+#include "indice_espacial.h"
+#include "metricas.h"
+#include "robot.h"
+#include "rueda_tiempos.h"
+#include "supervisor.h"
+#include "ventanas.h"
+
+#define TEMP_REPARACION 0
+#define TEMP_MOVIMIENTO 1
+#define TEMP_REPARTO 2        /* ventanas dinamicas: medir carga y repartir */
+#define FAILOVER_CUBETAS 32   /* histograma log2 de la latencia en us */
+
+/* Uno por banda: no comparte nada con el supervisor de otra banda */
+struct Supervisor {
+    SistemaRobot *sistema;
+    int num_robots;
+    unsigned int semilla;   /* solo la usa el hilo del supervisor */
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t hilo;
+    RuedaTiempos rueda;
+    Temporizador *temporizadores;   /* uno por robot: reparacion o movimiento */
+    int *fallas;            /* robots que avisaron una falla, sin atender */
+    int num_fallas;
+    double *t_falla;        /* instante del aviso de cada robot */
+    double *descubierta;    /* ventana sin reemplazo: instante de la falla (0 = cubierta) */
+    double despierta_en;    /* plazo al que duerme el hilo; -1 sin plazo, 0 despierto */
+    int cerrando;
+    int fin;
+    int objetivo;           /* ventanas abiertas que pidio el escaner, sin atender (-1 = nada) */
+    int pedido;             /* ultimo pedido del escaner */
+
+    /* ventanas dinamicas (-D): solo las toca el hilo del supervisor */
+    int dinamicas;
+    GestorVentanas gestor;
+    int *cubierta;
+    Temporizador t_reparto;
+    atomic_ulong repartos;
+
+    atomic_ulong tomas;
+    atomic_ulong latencia_ns;
+    atomic_ulong latencia_max_ns;
+    atomic_ulong cubetas[FAILOVER_CUBETAS];
+    atomic_ulong sin_reemplazo;
+    atomic_ulong cubiertas_tarde;
+    atomic_ulong escalados;
+    atomic_int abiertas;
+};
+
+static void *hilo_supervisor(void *arg);
+
+/* ------------------ cambios de ventana ------------------ */
+static void poner_ventana(Supervisor *sup, RobotInfo *r, int ventana) {
+    double T = sup->sistema->reloj->T_ventana;
+    r->ventana = ventana;
+    if (ventana >= 0 && sup->dinamicas) {
+        r->t_start = sup->gestor.bordes[ventana];
+        r->t_end = sup->gestor.bordes[ventana + 1];
+    } else {
+        r->t_start = ventana >= 0 ? ventana * T : 0.0;
+        r->t_end = ventana >= 0 ? (ventana + 1) * T : 0.0;
+    }
+}
+
+static void cubrir_con(Supervisor *sup, int ventana, int id) {
+    ColaVentana *q = &sup->sistema->reloj->ventanas[ventana];
+    pthread_mutex_lock(&q->lock);
+    atomic_store(&q->robot, id);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/* Pasa la ventana a un robot de reserva. t_falla > 0 se mide como failover
+   al primer paso del reemplazo. Devuelve el robot o -1 si no habia reserva. */
+static int cubrir_ventana(Supervisor *sup, int ventana, double t_falla) {
+    for (int i = 0; i < sup->num_robots; i++) {
+        RobotInfo *s = &sup->sistema->robotsinfos[i];
+        pthread_mutex_lock(&s->lock);
+        if (!s->reserva || s->daniado) {
+            pthread_mutex_unlock(&s->lock);
+            continue;
+        }
+        s->reserva = 0;
+        s->es_reemplazo = 1;
+        poner_ventana(sup, s, ventana);
+        s->t_toma = t_falla;
+        pthread_mutex_unlock(&s->lock);
+
+        cubrir_con(sup, ventana, i);
+        sup->descubierta[ventana] = 0.0;
+        metrica_sumar(&s->metricas->reemplazos);   /* solo el supervisor lo escribe */
+        metrica_estado(s->metricas, ROBOT_OCIOSO);
+        avisar_robot(sup->sistema, i);
+        return i;
+    }
+    return -1;
+}
+
+static int retomar_ventana(Supervisor *sup, int id);
+
+/* El reemplazo deja la ventana y vuelve a la reserva (si no se danio). Si
+   mientras tanto se abrio su propia ventana, pasa a cubrirla. */
+static void liberar_reemplazo(Supervisor *sup, int id) {
+    RobotInfo *s = &sup->sistema->robotsinfos[id];
+    pthread_mutex_lock(&s->lock);
+    int daniado = s->daniado;
+    int vuelve = s->titular && !daniado;
+    s->es_reemplazo = 0;
+    s->activo = vuelve;
+    s->reserva = !daniado && !vuelve;
+    poner_ventana(sup, s, vuelve ? id : -1);
+    s->t_toma = 0.0;
+    pthread_mutex_unlock(&s->lock);
+    if (vuelve) {
+        metrica_estado(s->metricas, ROBOT_OCIOSO);
+        retomar_ventana(sup, id);
+        bit_info("Robot %d deja el reemplazo y toma su ventana", id);
+    } else if (!daniado) {
+        metrica_estado(s->metricas, ROBOT_PARADO);
+    }
+    avisar_robot(sup->sistema, id);
+}
+
+/* El titular id (ya con su ventana puesta) vuelve a figurar en la cola; el
+   reemplazo que la cubria vuelve a la reserva. Devuelve ese reemplazo o -1. */
+static int retomar_ventana(Supervisor *sup, int id) {
+    ColaVentana *q = &sup->sistema->reloj->ventanas[id];
+    pthread_mutex_lock(&q->lock);
+    int s = atomic_exchange(&q->robot, id);
+    pthread_mutex_unlock(&q->lock);
+    sup->descubierta[id] = 0.0;
+    if (s < 0 || s == id) return -1;
+    liberar_reemplazo(sup, s);
+    return s;
+}
+
+/* Ventanas que quedaron sin reemplazo: las toma el primer reserva libre */
+static void cubrir_pendientes(Supervisor *sup) {
+    for (int k = 0; k < sup->num_robots; k++) {
+        if (sup->descubierta[k] <= 0.0) continue;
+        int s = cubrir_ventana(sup, k, 0.0);
+        if (s < 0) return;
+        atomic_fetch_add(&sup->cubiertas_tarde, 1);
+        bit_aviso("Supervisor: Robot %d (reserva) toma la ventana %d, que estaba sin cubrir", s, k);
+    }
+}
+
+/* ------------------ ventanas dinamicas ------------------ */
+/* Mangos sin etiquetar en las cajas de la ventana k. Mientras la caja esta
+   en la cola su ranura no se reusa, asi que el indice es el de esa caja. */
+static int sin_etiquetar_en(Supervisor *sup, int k) {
+    RelojBanda *reloj = sup->sistema->reloj;
+    ColaVentana *q = &reloj->ventanas[k];
+    int total = 0;
+    pthread_mutex_lock(&q->lock);
+    for (int j = 0; j < q->n; j++) {
+        CajaEnBanda *c = &reloj->cajas[q->cajas[j] % reloj->capacidad];
+        if (atomic_load_explicit(&c->activa, memory_order_acquire))
+            total += indice_restantes(&c->indice);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return total;
+}
+
+/* La cobertura sale de quien cubre cada cola; con medir tambien se toma la
+   muestra de carga y se da un paso del reparto por carga. Si los bordes
+   cambiaron van al reloj y a cada robot que cubre una ventana. */
+static void revisar_ventanas(Supervisor *sup, int medir) {
+    RelojBanda *reloj = sup->sistema->reloj;
+    for (int k = 0; k < sup->num_robots; k++)
+        sup->cubierta[k] = atomic_load(&reloj->ventanas[k].robot) >= 0;
+    int cambio = ventanas_cobertura(&sup->gestor, sup->cubierta);
+    if (medir) {
+        for (int k = 0; k < sup->num_robots; k++)
+            if (sup->cubierta[k]) ventanas_medir(&sup->gestor, k, sin_etiquetar_en(sup, k));
+        cambio |= ventanas_por_carga(&sup->gestor);
+    }
+    if (!cambio) return;
+
+    atomic_fetch_add(&sup->repartos, 1);
+    reloj_poner_bordes(reloj, sup->gestor.bordes);
+    for (int k = 0; k < sup->num_robots; k++) {
+        int id = atomic_load(&reloj->ventanas[k].robot);
+        if (id < 0) continue;
+        RobotInfo *r = &sup->sistema->robotsinfos[id];
+        pthread_mutex_lock(&r->lock);
+        if (r->ventana == k) poner_ventana(sup, r, k);
+        pthread_mutex_unlock(&r->lock);
+        avisar_robot(sup->sistema, id);
+    }
+}
+
+/* ------------------ falla y reparacion ------------------ */
+static int ventana_abierta(Supervisor *sup, int k) {
+    RobotInfo *t = &sup->sistema->robotsinfos[k];
+    pthread_mutex_lock(&t->lock);
+    int abierta = t->titular;
+    pthread_mutex_unlock(&t->lock);
+    return abierta;
+}
+
+static void atender_falla(Supervisor *sup, int id, double t_falla) {
+    RobotInfo *r = &sup->sistema->robotsinfos[id];
+    pthread_mutex_lock(&r->lock);
+    int ventana = r->ventana;
+    r->activo = 0;
+    r->es_reemplazo = 0;
+    r->reserva = 0;
+    poner_ventana(sup, r, -1);
+    r->t_toma = 0.0;
+    pthread_mutex_unlock(&r->lock);
+
+    if (ventana >= 0) {
+        ColaVentana *q = &sup->sistema->reloj->ventanas[ventana];
+        pthread_mutex_lock(&q->lock);
+        if (atomic_load(&q->robot) == id) atomic_store(&q->robot, -1);
+        pthread_mutex_unlock(&q->lock);
+    }
+
+    /* la reparacion tarda entre REPARACION_MIN_S y REPARACION_MAX_S */
+    double espera = REPARACION_MIN_S + rand_r(&sup->semilla) % (REPARACION_MAX_S - REPARACION_MIN_S + 1);
+    sup->temporizadores[id].tipo = TEMP_REPARACION;
+    rueda_agregar(&sup->rueda, &sup->temporizadores[id], t_falla + espera);
+
+    if (ventana < 0) {
+        bit_aviso("Robot %d se danio (no cubria ninguna ventana)", id);
+        return;
+    }
+    if (!ventana_abierta(sup, ventana)) {
+        /* el escalado la cerro mientras la falla esperaba al supervisor */
+        bit_aviso("Robot %d se danio (su ventana %d ya estaba cerrada)", id, ventana);
+        return;
+    }
+    int s = cubrir_ventana(sup, ventana, t_falla);
+    if (s >= 0) {
+        bit_aviso("Robot %d se danio -> Robot %d (reserva) toma la ventana %d", id, s, ventana);
+    } else {
+        sup->descubierta[ventana] = t_falla;
+        atomic_fetch_add(&sup->sin_reemplazo, 1);
+        if (sup->dinamicas) {
+            revisar_ventanas(sup, 0);
+            bit_aviso("Robot %d se danio -> sin reemplazo: las vecinas cubren la ventana %d", id, ventana);
+        } else {
+            bit_error("Robot %d se danio -> NO HAY reemplazo para la ventana %d", id, ventana);
+        }
+    }
+}
+
+static void reparar(Supervisor *sup, int id) {
+    RobotInfo *r = &sup->sistema->robotsinfos[id];
+    pthread_mutex_lock(&r->lock);
+    r->daniado = 0;
+    int titular = r->titular;
+    if (titular) {
+        r->activo = 1;
+        poner_ventana(sup, r, id);
+    } else {
+        r->reserva = 1;
+    }
+    pthread_mutex_unlock(&r->lock);
+    metrica_estado(r->metricas, titular ? ROBOT_OCIOSO : ROBOT_PARADO);
+
+    if (titular) {
+        /* recupera su ventana; el reemplazo que la cubria vuelve a la reserva */
+        int s = retomar_ventana(sup, id);
+        if (s >= 0) {
+            bit_info("Robot %d recuperado -> Robot %d (reemplazo) vuelve a la reserva", id, s);
+        } else {
+            bit_info("Robot %d recuperado -> No habia reemplazo activo.", id);
+        }
+    } else {
+        bit_info("Robot %d recuperado -> vuelve a la reserva", id);
+    }
+    avisar_robot(sup->sistema, id);
+    cubrir_pendientes(sup);
+    if (sup->dinamicas) revisar_ventanas(sup, 0);
+}
+
+/* ------------------ escalado ------------------ */
+/* Las ventanas abiertas son las de los titulares: 0..abiertas-1 */
+static int ventanas_abiertas(Supervisor *sup) {
+    int n = 0;
+    for (int k = 0; k < sup->num_robots; k++) n += ventana_abierta(sup, k);
+    return n;
+}
+
+/* Un titular libre la toma con activar_robot; si esta cubriendo otra ventana
+   o en reparacion, la ventana queda a su nombre y la cubre un reserva */
+static void abrir_ventana(Supervisor *sup, int k) {
+    RobotInfo *r = &sup->sistema->robotsinfos[k];
+    pthread_mutex_lock(&r->lock);
+    int ocupado = r->es_reemplazo || r->daniado;
+    if (ocupado) r->titular = 1;
+    pthread_mutex_unlock(&r->lock);
+    if (!ocupado) {
+        activar_robot(r);
+        return;
+    }
+    int s = cubrir_ventana(sup, k, 0.0);
+    if (s >= 0) bit_info("Supervisor: Robot %d (reserva) cubre la ventana %d hasta que vuelva su titular", s, k);
+    else sup->descubierta[k] = reloj_ahora();
+}
+
+static void cerrar_ventana(Supervisor *sup, int k) {
+    desactivar_robot(&sup->sistema->robotsinfos[k]);
+    /* si el titular estaba daniado la cubria un reemplazo */
+    ColaVentana *q = &sup->sistema->reloj->ventanas[k];
+    pthread_mutex_lock(&q->lock);
+    int s = atomic_exchange(&q->robot, -1);
+    pthread_mutex_unlock(&q->lock);
+    sup->descubierta[k] = 0.0;
+    if (s >= 0 && s != k) liberar_reemplazo(sup, s);
+}
+
+static void escalar(Supervisor *sup, int objetivo) {
+    if (objetivo < 1) objetivo = 1;
+    if (objetivo > sup->num_robots) objetivo = sup->num_robots;
+    int abiertas = ventanas_abiertas(sup);
+    if (objetivo == abiertas) return;
+    bit_info("Supervisor: %d -> %d ventanas abiertas", abiertas, objetivo);
+    while (abiertas < objetivo) abrir_ventana(sup, abiertas++);
+    while (abiertas > objetivo) cerrar_ventana(sup, --abiertas);
+    cubrir_pendientes(sup);
+    if (sup->dinamicas) revisar_ventanas(sup, 0);
+    atomic_fetch_add(&sup->escalados, 1);
+    atomic_store(&sup->abiertas, objetivo);
+}
+
+/* ------------------ API ------------------ */
+Supervisor *iniciar_supervisor(SistemaRobot *sistema, int robots_maximos, unsigned int semilla, int dinamicas) {
+    if (!sistema || !sistema->reloj || robots_maximos <= 0) return NULL;
+    Supervisor *sup = calloc(1, sizeof(Supervisor));
+    if (!sup) {
+        perror("calloc(supervisor)");
+        return NULL;
+    }
+    pthread_mutex_init(&sup->lock, NULL);
+    sup->sistema = sistema;
+    sup->num_robots = robots_maximos;
+    sup->semilla = semilla;
+    sup->dinamicas = 0;
+    sup->temporizadores = calloc((size_t)robots_maximos, sizeof(Temporizador));
+    sup->fallas = malloc(sizeof(int) * (size_t)robots_maximos);
+    sup->t_falla = calloc((size_t)robots_maximos, sizeof(double));
+    sup->descubierta = calloc((size_t)robots_maximos, sizeof(double));
+    if (!sup->temporizadores || !sup->fallas || !sup->t_falla || !sup->descubierta) {
+        perror("malloc(supervisor)");
+        liberar_supervisor(sup);
+        return NULL;
+    }
+    for (int i = 0; i < robots_maximos; i++) {
+        sup->temporizadores[i].vence = -1;
+        sup->temporizadores[i].id = i;
+    }
+    rueda_iniciar(&sup->rueda, reloj_ahora(), SUPERVISOR_TICK_S);
+    if (dinamicas) {
+        /* los bordes arrancan iguales a los del reloj; el primer reparto ya
+           pasa a las vecinas las ventanas que no tienen robot */
+        RelojBanda *reloj = sistema->reloj;
+        sup->cubierta = malloc(sizeof(int) * (size_t)robots_maximos);
+        if (!sup->cubierta ||
+            iniciar_gestor_ventanas(&sup->gestor, robots_maximos, reloj->bordes[reloj->num_ventanas]) != 0) {
+            perror("malloc(ventanas dinamicas)");
+            liberar_supervisor(sup);
+            return NULL;
+        }
+        sup->dinamicas = 1;
+        sup->t_reparto.vence = -1;
+        sup->t_reparto.tipo = TEMP_REPARTO;
+        sup->t_reparto.id = -1;
+        rueda_agregar(&sup->rueda, &sup->t_reparto, reloj_ahora() + VENTANAS_PERIODO_S);
+    }
+    sup->num_fallas = 0;
+    sup->cerrando = 0;
+    sup->fin = 0;
+    sup->objetivo = sup->pedido = -1;
+
+    /* plazos absolutos en CLOCK_MONOTONIC, como reloj_ahora() */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sup->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&sup->hilo, NULL, hilo_supervisor, sup) != 0) {
+        perror("pthread_create(hilo_supervisor)");
+        pthread_cond_destroy(&sup->cond);
+        sup->hilo = 0;
+        liberar_supervisor(sup);
+        return NULL;
+    }
+    return sup;
+}
+
+/* Lo llama el robot que fallo (ya marcado daniado, sin reserva de mango) */
+void supervisor_reportar_falla(Supervisor *sup, int id) {
+    if (id < 0 || id >= sup->num_robots) return;
+    pthread_mutex_lock(&sup->lock);
+    if (!sup->cerrando && sup->num_fallas < sup->num_robots) {
+        sup->t_falla[id] = reloj_ahora();
+        sup->fallas[sup->num_fallas++] = id;
+        pthread_cond_signal(&sup->cond);
+    }
+    pthread_mutex_unlock(&sup->lock);
+}
+
+/* Lo llama quien atiende el latido del escaner; solo despierta al hilo si el
+   pedido cambio */
+void supervisor_escalar(Supervisor *sup, int robots) {
+    pthread_mutex_lock(&sup->lock);
+    if (!sup->cerrando && robots != sup->pedido) {
+        sup->pedido = sup->objetivo = robots;
+        pthread_cond_signal(&sup->cond);
+    }
+    pthread_mutex_unlock(&sup->lock);
+}
+
+/* Modo pool: el robot queda planificado y el supervisor lo vuelve a encolar
+   cuando el brazo llega (despertar_robot) */
+void supervisor_programar(Supervisor *sup, int id, double plazo) {
+    if (id < 0 || id >= sup->num_robots) return;
+    pthread_mutex_lock(&sup->lock);
+    sup->temporizadores[id].tipo = TEMP_MOVIMIENTO;
+    rueda_agregar(&sup->rueda, &sup->temporizadores[id], plazo);
+    /* despertar al hilo solo si duerme hasta despues de este plazo */
+    if (sup->despierta_en < 0.0 || (sup->despierta_en > 0.0 && plazo < sup->despierta_en))
+        pthread_cond_signal(&sup->cond);
+    pthread_mutex_unlock(&sup->lock);
+}
+
+/* Lo llama el reemplazo en su primer paso dentro de la ventana tomada */
+void supervisor_registrar_toma(Supervisor *sup, double t_falla) {
+    double seg = reloj_ahora() - t_falla;
+    unsigned long ns = seg > 0.0 ? (unsigned long)(seg * 1e9) : 0;
+    atomic_fetch_add(&sup->tomas, 1);
+    atomic_fetch_add(&sup->latencia_ns, ns);
+    unsigned long max = atomic_load(&sup->latencia_max_ns);
+    while (ns > max && !atomic_compare_exchange_weak(&sup->latencia_max_ns, &max, ns))
+        ;
+    int k = 0;
+    for (unsigned long us = ns / 1000; us > 0 && k < FAILOVER_CUBETAS - 1; us >>= 1) k++;
+    atomic_fetch_add(&sup->cubetas[k], 1);
+}
+
+/* Desde aca las fallas ya no se reemplazan ni se reparan (fin de la corrida);
+   los temporizadores de movimiento siguen para que los robots terminen */
+void supervisor_cerrar(Supervisor *sup) {
+    pthread_mutex_lock(&sup->lock);
+    sup->cerrando = 1;
+    sup->num_fallas = 0;
+    sup->objetivo = -1;
+    for (int i = 0; i < sup->num_robots; i++) {
+        if (sup->temporizadores[i].tipo == TEMP_REPARACION) rueda_quitar(&sup->rueda, &sup->temporizadores[i]);
+    }
+    if (sup->dinamicas) rueda_quitar(&sup->rueda, &sup->t_reparto);
+    pthread_mutex_unlock(&sup->lock);
+}
+
+/* Termina el hilo; los contadores quedan para imprimir_failover */
+void detener_supervisor(Supervisor *sup) {
+    if (!sup || !sup->hilo) return;
+    pthread_mutex_lock(&sup->lock);
+    sup->fin = 1;
+    pthread_cond_signal(&sup->cond);
+    pthread_mutex_unlock(&sup->lock);
+    pthread_join(sup->hilo, NULL);
+    pthread_cond_destroy(&sup->cond);
+    sup->hilo = 0;
+}
+
+void liberar_supervisor(Supervisor *sup) {
+    if (!sup) return;
+    detener_supervisor(sup);
+    free(sup->temporizadores);
+    free(sup->fallas);
+    free(sup->t_falla);
+    free(sup->descubierta);
+    free(sup->cubierta);
+    if (sup->dinamicas) liberar_gestor_ventanas(&sup->gestor);
+    pthread_mutex_destroy(&sup->lock);
+    free(sup);
+}
+
+/* cota superior (us) del percentil p en el histograma log2 */
+static double percentil_us(const Supervisor *sup, unsigned long total, double p) {
+    unsigned long objetivo = (unsigned long)ceil(p * (double)total), acum = 0;
+    for (int k = 0; k < FAILOVER_CUBETAS; k++) {
+        acum += atomic_load(&sup->cubetas[k]);
+        if (acum >= objetivo) return (double)((1ul << k) - 1 + (k > 0));
+    }
+    return 0.0;
+}
+
+void imprimir_failover(const Supervisor *sup, FILE *f) {
+    unsigned long n = atomic_load(&sup->tomas);
+    fprintf(f, "Failover: %lu tomas de ventana", n);
+    if (n > 0) {
+        fprintf(f, " | latencia media %.1f us, p50 <= %.0f us, p99 <= %.0f us, max %.1f us",
+                (double)atomic_load(&sup->latencia_ns) / (double)n / 1e3,
+                percentil_us(sup, n, 0.50), percentil_us(sup, n, 0.99),
+                (double)atomic_load(&sup->latencia_max_ns) / 1e3);
+    }
+    fprintf(f, " | sin reemplazo: %lu (cubiertas despues: %lu)\n",
+            atomic_load(&sup->sin_reemplazo), atomic_load(&sup->cubiertas_tarde));
+    if (atomic_load(&sup->escalados) > 0)
+        fprintf(f, "Escalado: %lu cambios de robots activos (al final %d)\n",
+                atomic_load(&sup->escalados), atomic_load(&sup->abiertas));
+    if (atomic_load(&sup->repartos) > 0)
+        fprintf(f, "Ventanas dinamicas: %lu repartos de la banda\n", atomic_load(&sup->repartos));
+}
+
+/* ------------------ hilo supervisor ------------------ */
+/* Atiende fallas y vencimientos con el lock tomado, asi supervisor_cerrar
+   espera a que termine lo que este atendiendo. Los robots nunca piden este
+   lock con el de su RobotInfo o el de una cola tomado, asi que el orden es
+   siempre supervisor -> robot/cola/pool. Duerme hasta la proxima ranura
+   ocupada de la rueda o hasta un aviso. */
+static void *hilo_supervisor(void *arg) {
+    Supervisor *sup = (Supervisor *)arg;
+    fijar_tiempo_real(sup->sistema->prioridad_rt);
+    pthread_mutex_lock(&sup->lock);
+    while (!sup->fin) {
+        sup->despierta_en = 0.0;
+        int n = sup->num_fallas;
+        sup->num_fallas = 0;
+        for (int i = 0; i < n; i++) atender_falla(sup, sup->fallas[i], sup->t_falla[sup->fallas[i]]);
+        if (sup->objetivo >= 0) {
+            escalar(sup, sup->objetivo);
+            sup->objetivo = -1;
+        }
+
+        double ahora = reloj_ahora();
+        Temporizador *vencidos = rueda_avanzar(&sup->rueda, ahora);
+        if (n > 0 || vencidos) {
+            while (vencidos) {
+                Temporizador *t = vencidos;
+                vencidos = t->sig;
+                if (t->tipo == TEMP_MOVIMIENTO) {
+                    /* mov_fin lo escribio el robot antes de supervisor_programar */
+                    jitter_anotar(sup->sistema->jitter, JITTER_BRAZO,
+                                  sup->sistema->robotsinfos[t->id].mov_fin, ahora);
+                    despertar_robot(sup->sistema, t->id);
+                } else if (t->tipo == TEMP_REPARTO) {
+                    revisar_ventanas(sup, 1);
+                    rueda_agregar(&sup->rueda, &sup->t_reparto, reloj_ahora() + VENTANAS_PERIODO_S);
+                } else {
+                    reparar(sup, t->id);
+                }
+            }
+            continue;
+        }
+
+        double proximo = rueda_proximo(&sup->rueda);
+        sup->despierta_en = proximo;
+        if (proximo < 0.0) {
+            pthread_cond_wait(&sup->cond, &sup->lock);
+        } else {
+            struct timespec plazo;
+            plazo.tv_sec = (time_t)proximo;
+            plazo.tv_nsec = (long)((proximo - (double)plazo.tv_sec) * 1e9);
+            if (pthread_cond_timedwait(&sup->cond, &sup->lock, &plazo) == ETIMEDOUT)
+                jitter_anotar(sup->sistema->jitter, JITTER_SUPERVISOR, proximo, reloj_ahora());
+        }
+    }
+    pthread_mutex_unlock(&sup->lock);
+    return NULL;
+}
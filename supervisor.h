@@ -0,0 +1,43 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdio.h>
+
+// ---------- SUPERVISOR DE FALLAS Y REPARACIONES ----------
+// Un hilo propio es duenio del tiempo: una rueda de temporizadores
+// (rueda_tiempos.h) con los plazos de reparacion y, en modo pool, el fin del
+// movimiento de cada brazo. El robot que falla solo se marca daniado y avisa;
+// el supervisor le pasa su ventana a un robot de reserva que ya esta listo
+// (hilo creado o maquina de estados en el pool), asi tomar la ventana es
+// cambiar su estado y despertarlo. Al vencer la reparacion el robot vuelve a
+// su ventana y el reserva queda libre; si en una falla no habia reserva, la
+// ventana se cubre apenas se libera uno.
+// Con ventanas dinamicas (robot -D) el supervisor tambien es duenio del
+// gestor de ventanas (ventanas.h): si no hay reserva las vecinas se estiran
+// sobre la ventana del daniado, y cada VENTANAS_PERIODO_S mide la carga de
+// cada ventana y le pasa los bordes nuevos al reloj de banda y a los robots.
+// Con el latido del escaner (supervisor_escalar) abre o cierra ventanas
+// desde la ultima: abrir es activar al titular (o, si esta ocupado como
+// reemplazo o daniado, cubrir la ventana con un reserva hasta que vuelva);
+// cerrar lo deja de reserva y suelta al reemplazo que la cubria.
+// La latencia de failover se mide desde que el robot avisa la falla hasta
+// que el reemplazo corre su primer paso en la ventana.
+// Hay un supervisor por banda (robot -N), con su hilo, su rueda y su lock.
+
+typedef struct Supervisor Supervisor;
+
+#define SUPERVISOR_TICK_S 0.001   // resolucion de la rueda (s)
+#define REPARACION_MIN_S 1        // la reparacion tarda entre MIN y MAX s
+#define REPARACION_MAX_S 5
+
+Supervisor *iniciar_supervisor(SistemaRobot *sistema, int robots_maximos, unsigned int semilla, int dinamicas);
+void supervisor_reportar_falla(Supervisor *sup, int id);
+void supervisor_programar(Supervisor *sup, int id, double plazo);   // modo pool: despertar al robot en plazo
+void supervisor_registrar_toma(Supervisor *sup, double t_falla);
+void supervisor_escalar(Supervisor *sup, int robots);   // ventanas abiertas (titulares) que pide el escaner
+void supervisor_cerrar(Supervisor *sup);   // no mas reemplazos ni reparaciones; los movimientos siguen
+void detener_supervisor(Supervisor *sup);   // termina el hilo; los contadores siguen
+void liberar_supervisor(Supervisor *sup);
+void imprimir_failover(const Supervisor *sup, FILE *f);
+
+#endif
@@ -0,0 +1,172 @@
+// ventanas.c - reparto dinamico de la banda entre las ventanas de robot
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ventanas.h"
+
+#define VENTANAS_HISTERESIS 0.05   /* fraccion del ancho nominal que tiene que moverse un borde */
+
+/* Bordes a partir de los anchos, bordes[n] exacto en largo. Si ningun borde
+   se mueve mas que la histeresis quedan los anteriores (los ajustes siguen
+   acumulandose), asi robots y reloj no se reprograman por cambios minimos. */
+static int calcular_bordes(GestorVentanas *g) {
+    double minimo = VENTANAS_HISTERESIS * g->largo / (double)g->n;
+    double acum = 0.0, b = 0.0;
+    int cambio = 0;
+    for (int k = 0; k + 1 < g->n && !cambio; k++) {
+        acum += g->ancho[k];
+        b = acum < g->largo ? acum : g->largo;
+        if (fabs(b - g->bordes[k + 1]) > minimo) cambio = 1;
+    }
+    if (!cambio) return 0;
+    acum = 0.0;
+    for (int k = 0; k + 1 < g->n; k++) {
+        acum += g->ancho[k];
+        g->bordes[k + 1] = acum < g->largo ? acum : g->largo;
+    }
+    g->bordes[g->n] = g->largo;
+    return 1;
+}
+
+/* Escala los anchos para que sumen largo */
+static void normalizar(GestorVentanas *g) {
+    double suma = 0.0;
+    for (int k = 0; k < g->n; k++) suma += g->ancho[k];
+    if (suma <= 0.0) return;
+    for (int k = 0; k < g->n; k++) g->ancho[k] *= g->largo / suma;
+}
+
+/* Anchos: cada cubierta mide el ancho nominal mas lo que recibe de las
+   ventanas sin robot vecinas, mas su ajuste por carga. Sin ninguna cubierta
+   los bordes quedan como estaban. */
+static int repartir(GestorVentanas *g) {
+    int n = g->n, cubiertas = 0;
+    double nominal = g->largo / (double)n;
+    for (int k = 0; k < n; k++) {
+        g->ancho[k] = g->cubierta[k] ? nominal : 0.0;
+        cubiertas += g->cubierta[k];
+    }
+    if (cubiertas == 0) return 0;
+    for (int k = 0; k < n; k++) {
+        if (g->cubierta[k]) continue;
+        int izq = k - 1, der = k + 1;
+        while (izq >= 0 && !g->cubierta[izq]) izq--;
+        while (der < n && !g->cubierta[der]) der++;
+        if (izq >= 0 && der < n) {
+            g->ancho[izq] += nominal / 2.0;
+            g->ancho[der] += nominal / 2.0;
+        } else if (izq >= 0) {
+            g->ancho[izq] += nominal;
+        } else {
+            g->ancho[der] += nominal;
+        }
+    }
+    double minimo = VENTANA_MIN_REL * g->largo / (double)cubiertas;
+    for (int k = 0; k < n; k++) {
+        if (!g->cubierta[k]) continue;
+        g->ancho[k] += g->ajuste[k];
+        if (g->ancho[k] < minimo) g->ancho[k] = minimo;
+    }
+    normalizar(g);
+    return calcular_bordes(g);
+}
+
+int iniciar_gestor_ventanas(GestorVentanas *g, int n, double largo) {
+    if (!g || n <= 0 || largo <= 0.0) return -1;
+    memset(g, 0, sizeof(*g));
+    g->n = n;
+    g->largo = largo;
+    g->bordes = malloc(sizeof(double) * (size_t)(n + 1));
+    g->ancho = malloc(sizeof(double) * (size_t)n);
+    g->ajuste = calloc((size_t)n, sizeof(double));
+    g->carga = calloc((size_t)n, sizeof(double));
+    g->cubierta = malloc(sizeof(int) * (size_t)n);
+    if (!g->bordes || !g->ancho || !g->ajuste || !g->carga || !g->cubierta) {
+        perror("malloc(gestor ventanas)");
+        liberar_gestor_ventanas(g);
+        return -1;
+    }
+    /* arranca parejo, como si todas tuvieran robot */
+    for (int k = 0; k < n; k++) {
+        g->ancho[k] = largo / (double)n;
+        g->bordes[k] = k * (largo / (double)n);
+        g->cubierta[k] = 1;
+    }
+    g->bordes[n] = largo;
+    return 0;
+}
+
+void liberar_gestor_ventanas(GestorVentanas *g) {
+    if (!g) return;
+    free(g->bordes);
+    free(g->ancho);
+    free(g->ajuste);
+    free(g->carga);
+    free(g->cubierta);
+    memset(g, 0, sizeof(*g));
+}
+
+/* Un cambio de cobertura descarta los ajustes: el hueco va ya a las vecinas
+   y la ventana que vuelve recupera su ancho nominal */
+int ventanas_cobertura(GestorVentanas *g, const int *cubierta) {
+    int cambio = 0;
+    for (int k = 0; k < g->n; k++) {
+        if ((cubierta[k] != 0) != g->cubierta[k]) cambio = 1;
+        g->cubierta[k] = cubierta[k] != 0;
+    }
+    if (!cambio) return 0;
+    for (int k = 0; k < g->n; k++) g->ajuste[k] = 0.0;
+    return repartir(g);
+}
+
+void ventanas_medir(GestorVentanas *g, int k, double sin_etiquetar) {
+    if (k < 0 || k >= g->n) return;
+    g->carga[k] += VENTANAS_ALFA * (sin_etiquetar - g->carga[k]);
+}
+
+/* Factor de ancho de una ventana cubierta segun su carga frente a la media */
+static double factor_carga(const GestorVentanas *g, int k, double media) {
+    double f = pow((media + 1.0) / (g->carga[k] + 1.0), VENTANAS_GANANCIA);
+    if (f < VENTANA_MIN_REL) f = VENTANA_MIN_REL;
+    if (f > VENTANA_MAX_REL) f = VENTANA_MAX_REL;
+    return f;
+}
+
+/* Un paso de los ajustes hacia el objetivo: la banda pareja entre las
+   cubiertas, corregida por factor_carga. Asi el hueco de una ventana sin
+   robot se va extendiendo de las vecinas a toda la banda. */
+int ventanas_por_carga(GestorVentanas *g) {
+    int cubiertas = 0;
+    double media = 0.0, total = 0.0;
+    for (int k = 0; k < g->n; k++) {
+        if (!g->cubierta[k]) continue;
+        cubiertas++;
+        media += g->carga[k];
+    }
+    if (cubiertas == 0) return 0;
+    media /= (double)cubiertas;
+    for (int k = 0; k < g->n; k++)
+        if (g->cubierta[k]) total += factor_carga(g, k, media);
+
+    for (int k = 0; k < g->n; k++) {
+        if (!g->cubierta[k]) continue;
+        double objetivo = g->largo * factor_carga(g, k, media) / total;
+        g->ajuste[k] += VENTANAS_PASO * (objetivo - g->ancho[k]);
+    }
+    return repartir(g);
+}
+
+/* Ultima ventana con bordes[k] <= t (las de ancho 0 se saltan solas) */
+int ventana_en(const double *bordes, int n, double t) {
+    if (t < bordes[0] || t >= bordes[n]) return -1;
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (bordes[mid] <= t) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
@@ -0,0 +1,48 @@
+#ifndef VENTANAS_H
+#define VENTANAS_H
+
+// ---------- GESTOR DE VENTANAS DINAMICAS ----------
+// Reparte el recorrido de la banda [0, largo) entre las ventanas de robot.
+// La ventana k es [bordes[k], bordes[k+1]); una ventana sin robot mide 0 y
+// una caja nunca esta en ella. Dos trabajos:
+//  - cobertura: cuando una ventana queda sin robot su ancho pasa enseguida a
+//    las vecinas cubiertas mas cercanas (mitad a cada lado, todo a una si
+//    esta en un extremo); cuando vuelve a tener robot recupera su ancho.
+//  - carga: cada periodo se mide cuantos mangos sin etiquetar hay en las
+//    cajas de cada ventana (promedio exponencial) y el ancho de cada cubierta
+//    se mueve un paso hacia la banda pareja entre las cubiertas, corregida
+//    por (carga media / carga de la ventana) ^ VENTANAS_GANANCIA: el hueco
+//    que absorbieron las vecinas se reparte entre todos y una ventana con
+//    mas mangos pendientes que las demas se angosta, asi sus cajas pasan
+//    antes al robot siguiente.
+// Con robots iguales la banda pareja es lo que mas etiqueta (bench_celda
+// -d 1): con anchos desparejos se pierde mas tiempo en los bordes (brazo
+// que vuelve al centro, mango que ya no entra); por eso la ganancia es baja.
+// No tiene hilos ni locks: lo usa el supervisor en tiempo real y
+// simular_banda en tiempo virtual.
+
+#define VENTANAS_PERIODO_S 1.0   // cada cuanto se mide la carga y se reparte (s)
+#define VENTANAS_ALFA 0.05       // peso de la muestra nueva en el promedio de carga (unos 20 periodos)
+#define VENTANAS_PASO 0.5        // fraccion del camino al reparto objetivo por periodo
+#define VENTANAS_GANANCIA 0.1    // exponente de la correccion por carga
+#define VENTANA_MIN_REL 0.5      // cotas del factor de carga; el minimo tambien es
+#define VENTANA_MAX_REL 2.0      // el ancho minimo de una cubierta (relativo al parejo)
+
+typedef struct {
+    int n;            // ventanas (robots_maximos)
+    double largo;     // s que recorre una caja hasta el final de la ultima ventana
+    double *bordes;   // n+1 bordes crecientes, bordes[0] = 0 y bordes[n] = largo
+    double *ancho;    // ancho actual de cada ventana (0 = sin robot)
+    double *ajuste;   // correccion por carga sobre el ancho que da la cobertura
+    double *carga;    // mangos sin etiquetar en la ventana (promedio exponencial)
+    int *cubierta;    // cobertura con la que se calcularon los bordes
+} GestorVentanas;
+
+int iniciar_gestor_ventanas(GestorVentanas *g, int n, double largo);
+void liberar_gestor_ventanas(GestorVentanas *g);
+int ventanas_cobertura(GestorVentanas *g, const int *cubierta);   // 1 si cambiaron los bordes
+void ventanas_medir(GestorVentanas *g, int k, double sin_etiquetar);
+int ventanas_por_carga(GestorVentanas *g);                        // 1 si cambiaron los bordes
+int ventana_en(const double *bordes, int n, double t);            // -1 si t esta fuera de [0, bordes[n])
+
+#endif